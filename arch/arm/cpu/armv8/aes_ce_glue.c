@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * aes_ce_glue.c - AES-CBC and AES-CTR using ARMv8 Crypto Extensions
+ *
+ * The AES instructions are optional, so the CPU is checked for them at
+ * runtime, falling back to the table-based C code without them.
+ */
+
+#include <asm/system.h>
+#include <uboot_aes.h>
+
+extern void aes_ce_cbc_encrypt(u8 *key_exp, u32 rounds, u8 *iv, u8 *src,
+			       u8 *dst, u32 blocks);
+extern void aes_ce_cbc_decrypt(u8 *key_exp, u32 rounds, u8 *iv, u8 *src,
+			       u8 *dst, u32 blocks);
+extern void aes_ce_ctr(u8 *key_exp, u32 rounds, u8 *ctr, u8 *src, u8 *dst,
+		       u32 blocks);
+
+static bool aes_ce_available(void)
+{
+	return read_id_aa64isar0() & ID_AA64ISAR0_EL1_AES;
+}
+
+void aes_cbc_encrypt_blocks(u32 key_len, u8 *key_exp, u8 *iv, u8 *src,
+			    u8 *dst, u32 num_aes_blocks)
+{
+	if (aes_ce_available())
+		aes_ce_cbc_encrypt(key_exp, aes_get_rounds(key_len), iv, src,
+				   dst, num_aes_blocks);
+	else
+		aes_cbc_encrypt_blocks_generic(key_len, key_exp, iv, src, dst,
+					       num_aes_blocks);
+}
+
+void aes_cbc_decrypt_blocks(u32 key_len, u8 *key_exp, u8 *iv, u8 *src,
+			    u8 *dst, u32 num_aes_blocks)
+{
+	if (aes_ce_available())
+		aes_ce_cbc_decrypt(key_exp, aes_get_rounds(key_len), iv, src,
+				   dst, num_aes_blocks);
+	else
+		aes_cbc_decrypt_blocks_generic(key_len, key_exp, iv, src, dst,
+					       num_aes_blocks);
+}
+
+void aes_ctr_blocks(u32 key_len, u8 *key_exp, u8 *ctr, u8 *src, u8 *dst,
+		    u32 num_aes_blocks)
+{
+	if (aes_ce_available())
+		aes_ce_ctr(key_exp, aes_get_rounds(key_len), ctr, src, dst,
+			   num_aes_blocks);
+	else
+		aes_ctr_blocks_generic(key_len, key_exp, ctr, src, dst,
+				       num_aes_blocks);
+}
@@ -5,6 +5,7 @@
  * Copyright (C) 2022 Linaro Ltd <loic.poulain@linaro.org>
  */
 
+#include <asm/system.h>
 #include <u-boot/sha1.h>
 
 extern void sha1_armv8_ce_process(uint32_t state[5], uint8_t const *src,
@@ -16,5 +17,8 @@ void sha1_process(sha1_context *ctx, const unsigned char *data,
 	if (!blocks)
 		return;
 
-	sha1_armv8_ce_process(ctx->state, data, blocks);
+	if (read_id_aa64isar0() & ID_AA64ISAR0_EL1_SHA1)
+		sha1_armv8_ce_process(ctx->state, data, blocks);
+	else
+		sha1_process_generic(ctx, data, blocks);
 }
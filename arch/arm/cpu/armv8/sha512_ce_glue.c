@@ -0,0 +1,27 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * sha512_ce_glue.c - SHA-384/SHA-512 secure hash using ARMv8.2 Crypto
+ * Extensions
+ *
+ * The SHA-512 instructions are optional even on cores that have the
+ * SHA-1/SHA-256 ones, so they are looked for at runtime.
+ */
+
+#include <asm/system.h>
+#include <u-boot/sha512.h>
+
+extern void sha512_armv8_ce_process(uint64_t state[8], uint8_t const *src,
+				    uint32_t blocks);
+
+void sha512_process(sha512_context *ctx, const uint8_t *data,
+		    unsigned int blocks)
+{
+	if (!blocks)
+		return;
+
+	if ((read_id_aa64isar0() & ID_AA64ISAR0_EL1_SHA2) >=
+	    ID_AA64ISAR0_EL1_SHA2_SHA512)
+		sha512_armv8_ce_process(ctx->state, data, blocks);
+	else
+		sha512_process_generic(ctx, data, blocks);
+}
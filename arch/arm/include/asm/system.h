@@ -86,7 +86,15 @@
 #define HCR_EL2_HCD_DIS		(1 << 29) /* Hypervisor Call disabled         */
 #define HCR_EL2_AMO_EL2		(1 <<  5) /* Route SErrors to EL2             */
 
+/*
+ * ID_AA64ISAR0_EL1 bits definitions
+ */
 #define ID_AA64ISAR0_EL1_RNDR	(0xFUL << 60) /* RNDR random registers */
+#define ID_AA64ISAR0_EL1_SHA2	(0xFUL << 12) /* SHA-256/SHA-512 instructions */
+#define ID_AA64ISAR0_EL1_SHA1	(0xFUL << 8)  /* SHA-1 instructions */
+#define ID_AA64ISAR0_EL1_AES	(0xFUL << 4)  /* AES instructions */
+#define ID_AA64ISAR0_EL1_SHA2_SHA512	(0x2UL << 12) /* SHA-2 with SHA-512 */
+
 /*
  * ID_AA64ISAR1_EL1 bits definitions
  */
@@ -171,6 +179,14 @@ static inline unsigned int current_el(void)
 	return 3 & (el >> 2);
 }
 
+static inline unsigned long read_id_aa64isar0(void)
+{
+	unsigned long val;
+
+	asm volatile("mrs %0, id_aa64isar0_el1" : "=r" (val));
+	return val;
+}
+
 static inline unsigned long get_sctlr(void)
 {
 	unsigned int el;
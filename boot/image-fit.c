@@ -37,6 +37,7 @@ DECLARE_GLOBAL_DATA_PTR;
 #include <image.h>
 #include <bootstage.h>
 #include <upl.h>
+#include <u-boot/schedule.h>
 #include <u-boot/crc.h>
 
 /*****************************************************************************/
@@ -190,6 +191,9 @@ static void fit_image_print_data(const void *fit, int noffset, const char *p,
 	int value_len;
 	const char *algo;
 	const char *padding;
+	const uint8_t *table;
+	ulong chunk_size;
+	int table_len;
 	bool required;
 	int ret, i;
 
@@ -226,6 +230,17 @@ static void fit_image_print_data(const void *fit, int noffset, const char *p,
 
 	debug("%s  %s len:     %d\n", p, type, value_len);
 
+	ret = fit_image_hash_get_chunks(fit, noffset, &chunk_size, &table,
+					&table_len);
+	if (ret != -ENOENT) {
+		printf("%s  %s chunks:  ", p, type);
+		if (ret || !value_len)
+			printf("invalid\n");
+		else
+			printf("%d of %lu bytes\n", table_len / value_len,
+			       chunk_size);
+	}
+
 	/* Signatures have a time stamp */
 	if (IMAGE_ENABLE_TIMESTAMP && keyname) {
 		time_t timestamp;
@@ -1137,6 +1152,28 @@ int fit_image_hash_get_value(const void *fit, int noffset, uint8_t **value,
 	return 0;
 }
 
+int fit_image_hash_get_chunks(const void *fit, int noffset, ulong *chunk_sizep,
+			      const uint8_t **tablep, int *table_lenp)
+{
+	const fdt32_t *cell;
+	int len;
+
+	cell = fdt_getprop(fit, noffset, FIT_CHUNK_SIZE_PROP, &len);
+	if (!cell)
+		return -ENOENT;
+	if (len != sizeof(*cell) || !fdt32_to_cpu(*cell))
+		return -EINVAL;
+	*chunk_sizep = fdt32_to_cpu(*cell);
+
+	*tablep = fdt_getprop(fit, noffset, FIT_CHUNK_VALUE_PROP, table_lenp);
+	if (!*tablep) {
+		fit_get_debug(fit, noffset, FIT_CHUNK_VALUE_PROP, *table_lenp);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
 /**
  * fit_image_hash_get_ignore - get hash ignore flag
  * @fit: pointer to the FIT format image header
@@ -1290,6 +1327,52 @@ int calculate_hash(const void *data, int data_len, const char *name,
 	return 0;
 }
 
+/**
+ * fit_image_check_chunks() - Check each chunk of an image against its hash
+ *
+ * @data: Image data
+ * @size: Size of image data in bytes
+ * @algo: Hash algorithm name
+ * @chunk_size: Size of each chunk in bytes
+ * @table: Expected hash of each chunk, one after the other
+ * @table_len: Size of @table in bytes
+ * @err_msgp: Returns an error message on failure
+ * Return: 0 if all chunks match, -1 if not
+ */
+static int fit_image_check_chunks(const void *data, size_t size,
+				  const char *algo, ulong chunk_size,
+				  const uint8_t *table, int table_len,
+				  char **err_msgp)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(uint8_t, value, FIT_MAX_HASH_LEN);
+	int value_len = 0;
+	size_t pos;
+	int count;
+
+	for (pos = 0, count = 0; pos < size; pos += chunk_size, count++) {
+		ulong len = size - pos < chunk_size ? size - pos : chunk_size;
+
+		if (calculate_hash(data + pos, len, algo, value, &value_len)) {
+			*err_msgp = "Unsupported hash algorithm";
+			return -1;
+		}
+		if ((count + 1) * value_len > table_len) {
+			*err_msgp = "Image too long for chunks";
+			return -1;
+		}
+		if (memcmp(value, table + count * value_len, value_len)) {
+			*err_msgp = "Bad chunk hash value";
+			return -1;
+		}
+	}
+	if (count * value_len != table_len) {
+		*err_msgp = "Image too short for chunks";
+		return -1;
+	}
+
+	return 0;
+}
+
 static int fit_image_check_hash(const void *fit, int noffset, const void *data,
 				size_t size, char **err_msgp)
 {
@@ -1298,7 +1381,11 @@ static int fit_image_check_hash(const void *fit, int noffset, const void *data,
 	const char *algo;
 	uint8_t *fit_value;
 	int fit_value_len;
+	const uint8_t *table;
+	ulong chunk_size;
+	int table_len;
 	int ignore;
+	int ret;
 
 	*err_msgp = NULL;
 
@@ -1322,7 +1409,15 @@ static int fit_image_check_hash(const void *fit, int noffset, const void *data,
 		return -1;
 	}
 
-	if (calculate_hash(data, size, algo, value, &value_len)) {
+	/* a chunked hash value covers the table of chunk hashes */
+	ret = fit_image_hash_get_chunks(fit, noffset, &chunk_size, &table,
+					&table_len);
+	if (ret && ret != -ENOENT) {
+		*err_msgp = "Bad chunk table";
+		return -1;
+	}
+	if (ret ? calculate_hash(data, size, algo, value, &value_len) :
+	    calculate_hash(table, table_len, algo, value, &value_len)) {
 		*err_msgp = "Unsupported hash algorithm";
 		return -1;
 	}
@@ -1335,6 +1430,10 @@ static int fit_image_check_hash(const void *fit, int noffset, const void *data,
 		return -1;
 	}
 
+	if (!ret)
+		return fit_image_check_chunks(data, size, algo, chunk_size,
+					      table, table_len, err_msgp);
+
 	return 0;
 }
 
@@ -1446,6 +1545,303 @@ err:
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(FIT_HASH_STREAM)
+/* Check if an image must be verified with a signature over its whole data */
+static bool fit_image_needs_sig(const void *fit, int image_noffset,
+				const void *key_blob)
+{
+	int key_node;
+	int noffset;
+
+	if (!FIT_IMAGE_ENABLE_VERIFY)
+		return false;
+
+	fdt_for_each_subnode(noffset, fit, image_noffset) {
+		if (!strncmp(fit_get_name(fit, noffset, NULL), FIT_SIG_NODENAME,
+			     strlen(FIT_SIG_NODENAME)))
+			return true;
+	}
+
+	/* a required key means that the full check must fail without one */
+	key_node = fdt_subnode_offset(key_blob, 0, FIT_SIG_NODENAME);
+	if (key_node < 0)
+		return false;
+	fdt_for_each_subnode(noffset, key_blob, key_node) {
+		const char *required;
+
+		required = fdt_getprop(key_blob, noffset, FIT_KEY_REQUIRED,
+				       NULL);
+		if (required && !strcmp(required, "image"))
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Set up a chunked hash in a stream, checking its chunk table against the
+ * hash value so that each chunk can be trusted as soon as it matches
+ */
+static int fit_hash_stream_init_chunks(struct fit_hash_stream *hs, int i)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(uint8_t, value, FIT_MAX_HASH_LEN);
+	struct hash_algo *algo = hs->hash[i].algo;
+	int noffset = hs->hash[i].noffset;
+	uint8_t *fit_value;
+	int fit_value_len;
+	int table_len;
+	int value_len;
+	int ret;
+
+	ret = fit_image_hash_get_chunks(hs->fit, noffset,
+					&hs->hash[i].chunk_size,
+					&hs->hash[i].table, &table_len);
+	if (ret == -ENOENT)
+		return 0;
+	if (ret || table_len % algo->digest_size ||
+	    fit_image_hash_get_value(hs->fit, noffset, &fit_value,
+				     &fit_value_len) ||
+	    calculate_hash(hs->hash[i].table, table_len, algo->name, value,
+			   &value_len) ||
+	    value_len != fit_value_len || memcmp(value, fit_value, value_len))
+		return -EPROTONOSUPPORT;
+	hs->hash[i].chunk_count = table_len / algo->digest_size;
+
+	return 0;
+}
+
+/* Check the chunk just completed in a chunked hash and start the next one */
+static int fit_hash_stream_end_chunk(struct fit_hash_stream *hs, int i)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(uint8_t, value, FIT_MAX_HASH_LEN);
+	struct hash_algo *algo = hs->hash[i].algo;
+	int chunk = hs->hash[i].chunk;
+	int ret;
+
+	ret = algo->hash_finish(algo, hs->hash[i].ctx, value, FIT_MAX_HASH_LEN);
+	hs->hash[i].ctx = NULL;
+	if (ret)
+		return -EIO;
+	if (memcmp(value, hs->hash[i].table + chunk * algo->digest_size,
+		   algo->digest_size)) {
+		printf("%s error!\nBad hash value for chunk %d of '%s' hash node in '%s' image node\n",
+		       algo->name, chunk,
+		       fit_get_name(hs->fit, hs->hash[i].noffset, NULL),
+		       fit_get_name(hs->fit, hs->image_noffset, NULL));
+		return -EBADMSG;
+	}
+	hs->hash[i].chunk_pos = 0;
+	if (++hs->hash[i].chunk < hs->hash[i].chunk_count &&
+	    algo->hash_init(algo, &hs->hash[i].ctx))
+		return -EIO;
+
+	return 0;
+}
+
+/* Add data to a chunked hash, checking each chunk as it is completed */
+static int fit_hash_stream_update_chunks(struct fit_hash_stream *hs, int i,
+					 const void *data, ulong len)
+{
+	struct hash_algo *algo = hs->hash[i].algo;
+	int ret;
+
+	while (len) {
+		ulong count = hs->hash[i].chunk_size - hs->hash[i].chunk_pos;
+
+		if (hs->hash[i].chunk == hs->hash[i].chunk_count) {
+			printf("%s error!\nImage too long for chunks of '%s' hash node in '%s' image node\n",
+			       algo->name,
+			       fit_get_name(hs->fit, hs->hash[i].noffset, NULL),
+			       fit_get_name(hs->fit, hs->image_noffset, NULL));
+			return -EBADMSG;
+		}
+		if (count > len)
+			count = len;
+		if (algo->hash_update(algo, hs->hash[i].ctx, data, count, 0))
+			return -EIO;
+		hs->hash[i].chunk_pos += count;
+		data += count;
+		len -= count;
+		if (hs->hash[i].chunk_pos == hs->hash[i].chunk_size) {
+			ret = fit_hash_stream_end_chunk(hs, i);
+			if (ret)
+				return ret;
+		}
+	}
+
+	return 0;
+}
+
+int fit_image_hash_stream_init(struct fit_hash_stream *hs, const void *fit,
+			       int image_noffset, const void *key_blob)
+{
+	const char *name = fit_get_name(fit, image_noffset, NULL);
+	int noffset;
+	int ret;
+
+	memset(hs, '\0', sizeof(*hs));
+	hs->fit = fit;
+	hs->image_noffset = image_noffset;
+
+	/* leave anything unusual to fit_image_verify_with_data() */
+	if (IS_ENABLED(CONFIG_DM_HASH) ||
+	    (IS_ENABLED(CONFIG_FIT_SIGNATURE) && strchr(name, '@')) ||
+	    fit_image_needs_sig(fit, image_noffset, key_blob))
+		return -EPROTONOSUPPORT;
+
+	fdt_for_each_subnode(noffset, fit, image_noffset) {
+		struct hash_algo *algo;
+		const char *algo_name;
+		int ignore;
+
+		if (strncmp(fit_get_name(fit, noffset, NULL), FIT_HASH_NODENAME,
+			    strlen(FIT_HASH_NODENAME)))
+			continue;
+		fit_image_hash_get_ignore(fit, noffset, &ignore);
+		if (ignore)
+			continue;
+		if (hs->count == FIT_HASH_STREAM_MAX ||
+		    fit_image_hash_get_algo(fit, noffset, &algo_name) ||
+		    hash_progressive_lookup_algo(algo_name, &algo)) {
+			ret = -EPROTONOSUPPORT;
+			goto err;
+		}
+		hs->hash[hs->count].noffset = noffset;
+		hs->hash[hs->count].algo = algo;
+		ret = fit_hash_stream_init_chunks(hs, hs->count);
+		if (ret)
+			goto err;
+		if (!hs->hash[hs->count].chunk_size ||
+		    hs->hash[hs->count].chunk_count) {
+			ret = algo->hash_init(algo, &hs->hash[hs->count].ctx);
+			if (ret) {
+				ret = -ENOMEM;
+				goto err;
+			}
+		}
+		hs->count++;
+	}
+	if (noffset == -FDT_ERR_TRUNCATED || noffset == -FDT_ERR_BADSTRUCTURE) {
+		ret = -EPROTONOSUPPORT;
+		goto err;
+	}
+
+	return 0;
+
+err:
+	fit_image_hash_stream_abort(hs);
+
+	return ret;
+}
+
+int fit_image_hash_stream_update(struct fit_hash_stream *hs, const void *data,
+				 ulong len)
+{
+	int ret;
+	int i;
+
+	for (i = 0; i < hs->count; i++) {
+		struct hash_algo *algo = hs->hash[i].algo;
+
+		if (hs->hash[i].chunk_size)
+			ret = fit_hash_stream_update_chunks(hs, i, data, len);
+		else if (algo->hash_update(algo, hs->hash[i].ctx, data, len, 0))
+			ret = -EIO;
+		else
+			ret = 0;
+		if (ret) {
+			fit_image_hash_stream_abort(hs);
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+int fit_image_hash_stream_finish(struct fit_hash_stream *hs)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(uint8_t, value, FIT_MAX_HASH_LEN);
+	char *err_msg = NULL;
+	int noffset = 0;
+	int ret = 0;
+	int i;
+
+	for (i = 0; i < hs->count; i++) {
+		struct hash_algo *algo = hs->hash[i].algo;
+		uint8_t *fit_value;
+		int fit_value_len;
+
+		noffset = hs->hash[i].noffset;
+		if (hs->hash[i].chunk_size) {
+			/* the last chunk may be short */
+			if (hs->hash[i].chunk_pos) {
+				ret = fit_hash_stream_end_chunk(hs, i);
+				if (ret)
+					break;
+			}
+			printf("%s", algo->name);
+			if (hs->hash[i].chunk != hs->hash[i].chunk_count) {
+				err_msg = "Image too short for chunks";
+				ret = -EBADMSG;
+				break;
+			}
+			puts("+ ");
+			continue;
+		}
+
+		printf("%s", algo->name);
+		ret = algo->hash_finish(algo, hs->hash[i].ctx, value,
+					FIT_MAX_HASH_LEN);
+		hs->hash[i].ctx = NULL;
+		if (ret) {
+			err_msg = "Hash failed";
+			ret = -EIO;
+			break;
+		}
+		if (fit_image_hash_get_value(hs->fit, noffset, &fit_value,
+					     &fit_value_len)) {
+			err_msg = "Can't get hash value property";
+			ret = -EBADMSG;
+			break;
+		}
+		if (fit_value_len != algo->digest_size) {
+			err_msg = "Bad hash value len";
+			ret = -EBADMSG;
+			break;
+		} else if (memcmp(value, fit_value, fit_value_len)) {
+			err_msg = "Bad hash value";
+			ret = -EBADMSG;
+			break;
+		}
+		puts("+ ");
+	}
+	fit_image_hash_stream_abort(hs);
+	if (err_msg)
+		printf(" error!\n%s for '%s' hash node in '%s' image node\n",
+		       err_msg, fit_get_name(hs->fit, noffset, NULL),
+		       fit_get_name(hs->fit, hs->image_noffset, NULL));
+
+	return ret;
+}
+
+void fit_image_hash_stream_abort(struct fit_hash_stream *hs)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(uint8_t, value, FIT_MAX_HASH_LEN);
+	int i;
+
+	/* finishing a hash is the only way to free its context */
+	for (i = 0; i < hs->count; i++) {
+		struct hash_algo *algo = hs->hash[i].algo;
+
+		if (hs->hash[i].ctx)
+			algo->hash_finish(algo, hs->hash[i].ctx, value,
+					  FIT_MAX_HASH_LEN);
+		hs->hash[i].ctx = NULL;
+	}
+	hs->count = 0;
+}
+#endif /* FIT_HASH_STREAM */
+
 /**
  * fit_all_image_verify - verify data integrity for all images
  * @fit: pointer to the FIT format image header
@@ -1989,6 +2385,102 @@ static int fit_image_select(const void *fit, int rd_noffset, int verify)
 	return 0;
 }
 
+/**
+ * fit_image_can_hash_stream() - Check if an image can be verified while copied
+ *
+ * This is possible if fit_image_load() copies the image data to its load
+ * address as is, without decrypting, post-processing or decompressing it,
+ * and the copy does not overwrite data which has not been copied yet.
+ *
+ * @fit: FIT to check
+ * @noffset: Offset of image node in @fit
+ * @image_type: Type of image being loaded (IH_TYPE_...)
+ * @load_op: How to handle the load address
+ * Return: true if the hashes can be checked by fit_image_copy_verify()
+ */
+static bool fit_image_can_hash_stream(const void *fit, int noffset,
+				      int image_type,
+				      enum fit_load_op load_op)
+{
+	const void *buf;
+	size_t size;
+	ulong load, data;
+	uint8_t comp;
+
+	if (!CONFIG_IS_ENABLED(FIT_HASH_STREAM) ||
+	    IS_ENABLED(CONFIG_FIT_IMAGE_POST_PROCESS))
+		return false;
+	if (load_op == FIT_LOAD_IGNORED ||
+	    fit_image_get_load(fit, noffset, &load) ||
+	    (load_op == FIT_LOAD_OPTIONAL_NON_ZERO && !load))
+		return false;
+	if (IS_ENABLED(CONFIG_FIT_CIPHER) &&
+	    fdt_subnode_offset(fit, noffset, FIT_CIPHER_NODENAME) >= 0)
+		return false;
+	if (!fit_image_get_comp(fit, noffset, &comp) && comp != IH_COMP_NONE &&
+	    !(image_type == IH_TYPE_KERNEL ||
+	      image_type == IH_TYPE_KERNEL_NOLOAD ||
+	      image_type == IH_TYPE_RAMDISK))
+		return false;
+	if (fit_image_get_data(fit, noffset, &buf, &size))
+		return false;
+	data = map_to_sysmem(buf);
+
+	return load < data || load >= data + size;
+}
+
+/**
+ * fit_image_copy_verify() - Copy an image to its load address, checking hashes
+ *
+ * Each chunk of the image is hashed and then copied while it is still in the
+ * cache, so the image is only read once. If the image cannot be checked this
+ * way, it is verified in full before it is copied.
+ *
+ * @fit: FIT containing the image
+ * @noffset: Offset of image node in @fit
+ * @dst: Load address
+ * @src: Image data
+ * @len: Length of image data in bytes
+ * Return: 0 if OK, -EACCES if the hashes do not match
+ */
+static int fit_image_copy_verify(const void *fit, int noffset, void *dst,
+				 const void *src, ulong len)
+{
+	struct fit_hash_stream hs;
+	ulong done, count;
+	int ret;
+
+	puts("   Verifying Hash Integrity ... ");
+	ret = fit_image_hash_stream_init(&hs, fit, noffset, gd_fdt_blob());
+	if (ret) {
+		if (!fit_image_verify(fit, noffset)) {
+			puts("Bad Data Hash\n");
+			return -EACCES;
+		}
+		memmove(dst, src, len);
+		puts("OK\n");
+		return 0;
+	}
+
+	for (done = 0; done < len; done += count) {
+		count = len - done > CHUNKSZ ? CHUNKSZ : len - done;
+		ret = fit_image_hash_stream_update(&hs, src + done, count);
+		if (ret)
+			break;
+		memmove(dst + done, src + done, count);
+		schedule();
+	}
+	if (!ret)
+		ret = fit_image_hash_stream_finish(&hs);
+	if (ret) {
+		puts("Bad Data Hash\n");
+		return -EACCES;
+	}
+	puts("OK\n");
+
+	return 0;
+}
+
 int fit_get_node_from_config(struct bootm_headers *images,
 			     const char *prop_name, ulong addr)
 {
@@ -2072,6 +2564,7 @@ int fit_image_load(struct bootm_headers *images, ulong addr,
 	ulong load, load_end, data, len;
 	uint8_t os, comp;
 	const char *prop_name;
+	bool hash_stream;
 	int ret;
 
 	fit = map_sysmem(addr, 0);
@@ -2147,7 +2640,10 @@ int fit_image_load(struct bootm_headers *images, ulong addr,
 
 	printf("   Trying '%s' %s subimage\n", fit_uname, prop_name);
 
-	ret = fit_image_select(fit, noffset, images->verify);
+	/* if possible, check the hashes while copying the data, below */
+	hash_stream = images->verify &&
+		fit_image_can_hash_stream(fit, noffset, image_type, load_op);
+	ret = fit_image_select(fit, noffset, images->verify && !hash_stream);
 	if (ret) {
 		bootstage_error(bootstage_id + BOOTSTAGE_SUB_HASH);
 		return ret;
@@ -2294,7 +2790,27 @@ int fit_image_load(struct bootm_headers *images, ulong addr,
 	} else if (load != data) {
 		log_debug("copying\n");
 		loadbuf = map_sysmem(load, len);
-		memcpy(loadbuf, buf, len);
+		if (hash_stream) {
+			ret = fit_image_copy_verify(fit, noffset, loadbuf, buf,
+						    len);
+			if (ret) {
+				bootstage_error(bootstage_id +
+						BOOTSTAGE_SUB_HASH);
+				return ret;
+			}
+			hash_stream = false;
+		} else {
+			memcpy(loadbuf, buf, len);
+		}
+	}
+
+	/* the image was not copied after all, so check it now */
+	if (hash_stream) {
+		ret = fit_image_select(fit, noffset, true);
+		if (ret) {
+			bootstage_error(bootstage_id + BOOTSTAGE_SUB_HASH);
+			return ret;
+		}
 	}
 
 	if (image_type == IH_TYPE_RAMDISK && comp != IH_COMP_NONE)
@@ -12,9 +12,32 @@
 #include <asm/byteorder.h>
 #include <linux/compiler.h>
 #include <mapmem.h>
+#include <time.h>
 #include <vsprintf.h>
 #include <dm/uclass.h>
 #include <dm/device.h>
+#include <linux/math64.h>
+#include <linux/sizes.h>
+
+/* Default buffer size and minimum time for each mode for 'aes bench' */
+#define AES_BENCH_LEN	SZ_1M
+#define AES_BENCH_MS	200
+
+enum {
+	AES_BENCH_CBC_ENC,
+	AES_BENCH_CBC_DEC,
+	AES_BENCH_CTR,
+	AES_BENCH_GCM_ENC,
+
+	AES_BENCH_COUNT,
+};
+
+static const char *const aes_bench_name[AES_BENCH_COUNT] = {
+	[AES_BENCH_CBC_ENC]	= "cbc encrypt",
+	[AES_BENCH_CBC_DEC]	= "cbc decrypt",
+	[AES_BENCH_CTR]		= "ctr",
+	[AES_BENCH_GCM_ENC]	= "gcm encrypt",
+};
 
 u32 aes_get_key_len(char *command)
 {
@@ -259,6 +282,75 @@ int cmd_aes_cbc(int argc, char *const argv[], u32 key_len)
 	return CMD_RET_SUCCESS;
 }
 
+int cmd_aes_bench(int argc, char *const argv[], u32 key_len)
+{
+	u8 key[AES256_KEY_LENGTH], key_exp[AES256_EXPAND_KEY_LENGTH];
+	u8 iv[AES_BLOCK_LENGTH], tag[AES_GCM_TAG_LENGTH];
+	ulong len = AES_BENCH_LEN, i;
+	u32 aes_blocks;
+	int mode;
+	u8 *buf;
+
+	if (argc > 3)
+		return CMD_RET_USAGE;
+	if (argc == 3)
+		len = hextoul(argv[2], NULL);
+
+	aes_blocks = len / AES_BLOCK_LENGTH;
+	if (!aes_blocks)
+		return CMD_RET_USAGE;
+	len = aes_blocks * AES_BLOCK_LENGTH;
+
+	buf = malloc(len);
+	if (!buf) {
+		printf("Cannot allocate %lx bytes\n", len);
+		return CMD_RET_FAILURE;
+	}
+	for (i = 0; i < len; i++)
+		buf[i] = i * 7 + (i >> 8);
+	for (i = 0; i < sizeof(key); i++)
+		key[i] = i;
+	memset(iv, '\0', sizeof(iv));
+	aes_expand_key(key, key_len, key_exp);
+
+	for (mode = 0; mode < AES_BENCH_COUNT; mode++) {
+		ulong start, elapsed;
+		u64 bytes = 0, rate;
+
+		start = get_timer(0);
+		do {
+			switch (mode) {
+			case AES_BENCH_CBC_ENC:
+				aes_cbc_encrypt_blocks(key_len, key_exp, iv,
+						       buf, buf, aes_blocks);
+				break;
+			case AES_BENCH_CBC_DEC:
+				aes_cbc_decrypt_blocks(key_len, key_exp, iv,
+						       buf, buf, aes_blocks);
+				break;
+			case AES_BENCH_CTR:
+				aes_ctr_blocks(key_len, key_exp, iv, buf, buf,
+					       aes_blocks);
+				break;
+			case AES_BENCH_GCM_ENC:
+				aes_gcm_encrypt(key_len, key_exp, iv, NULL, 0,
+						buf, buf, len, tag);
+				break;
+			}
+			bytes += len;
+			elapsed = get_timer(start);
+		} while (elapsed < AES_BENCH_MS);
+
+		/* in hundredths of a MiB/s */
+		rate = div_u64((bytes * 1000 * 100) >> 20, elapsed);
+		printf("aes-%u %-12s %6llu.%02llu MiB/s\n", key_len * 8,
+		       aes_bench_name[mode], rate / 100, rate % 100);
+	}
+	free(buf);
+
+	return CMD_RET_SUCCESS;
+}
+
 /**
  * do_aes() - Handle the "aes" command-line command
  * @cmdtp:	Command data struct pointer
@@ -280,6 +372,8 @@ static int do_aes(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 
 	if (!strncmp(argv[1], "enc", 3) || !strncmp(argv[1], "dec", 3))
 		return cmd_aes_cbc_simple(argc, argv, key_len);
+	else if (!strcmp(argv[1], "bench"))
+		return cmd_aes_bench(argc, argv, key_len);
 	else if (CONFIG_IS_ENABLED(DM_AES) && !strncmp(argv[1], "get_slots", 9))
 		return cmd_aes_get_slots();
 	else if (CONFIG_IS_ENABLED(DM_AES) && !strncmp(argv[1], "set_key", 7))
@@ -307,7 +401,10 @@ U_BOOT_LONGHELP(aes,
 	"                             $key with initialization vector at address\n"
 	"                             $iv. Store the result at address $dst.\n"
 	"                             The $len size must be multiple of 16 bytes.\n"
-	"                             The $key and $iv must be 16 bytes long."
+	"                             The $key and $iv must be 16 bytes long.\n"
+	"aes [.128,.192,.256] bench [size] - Measure the CBC, CTR and GCM\n"
+	"                             throughput on a buffer of $size bytes\n"
+	"                             (hex, default 100000)."
 
 #if CONFIG_IS_ENABLED(DM_AES)
 	"\n"
@@ -12,7 +12,9 @@
 #include <command.h>
 #include <env.h>
 #include <hash.h>
+#include <vsprintf.h>
 #include <linux/ctype.h>
+#include <linux/sizes.h>
 
 #if IS_ENABLED(CONFIG_HASH_VERIFY)
 #define HARGS 6
@@ -20,12 +22,35 @@
 #define HARGS 5
 #endif
 
+/* Default buffer size for 'hash bench' */
+#define HASH_BENCH_SIZE		SZ_1M
+
+static int do_hash_bench(int argc, char *const argv[])
+{
+	ulong len = HASH_BENCH_SIZE;
+
+	if (argc > 2)
+		len = hextoul(argv[2], NULL);
+	if (!len)
+		return CMD_RET_USAGE;
+
+	if (hash_bench(len)) {
+		printf("Cannot allocate %lx bytes\n", len);
+		return CMD_RET_FAILURE;
+	}
+
+	return 0;
+}
+
 static int do_hash(struct cmd_tbl *cmdtp, int flag, int argc,
 		   char *const argv[])
 {
 	char *s;
 	int flags = HASH_FLAG_ENV;
 
+	if (argc >= 2 && !strcmp(argv[1], "bench"))
+		return do_hash_bench(argc, argv);
+
 	if (argc < 4)
 		return CMD_RET_USAGE;
 
@@ -48,10 +73,15 @@ U_BOOT_CMD(
 	hash,	HARGS,	1,	do_hash,
 	"compute hash message digest",
 	"algorithm address count [[*]hash_dest]\n"
-		"    - compute message digest [save to env var / *address]"
+		"    - compute message digest [save to env var / *address]\n"
+	"hash algorithm,algorithm... address count\n"
+		"    - compute several message digests in one pass"
 #if IS_ENABLED(CONFIG_HASH_VERIFY)
 	"\nhash -v algorithm address count [*]hash\n"
 		"    - verify message digest of memory area to immediate value, \n"
 		"      env var or *address"
 #endif
+	"\nhash bench [size]\n"
+		"    - report the speed of each algorithm hashing size bytes\n"
+		"      (hex, default 100000)"
 );
@@ -20,6 +20,11 @@
 #include <asm/global_data.h>
 #include <asm/io.h>
 #include <linux/errno.h>
+#include <linux/kernel.h>
+#include <linux/math64.h>
+#include <linux/sizes.h>
+#include <time.h>
+#include <u-boot/schedule.h>
 #else
 #include "mkimage.h"
 #include <linux/compiler_attributes.h>
@@ -34,6 +39,8 @@
 #include <u-boot/sha256.h>
 #include <u-boot/sha512.h>
 #include <u-boot/md5.h>
+#include <u-boot/blake2.h>
+#include <linux/xxhash.h>
 
 static int __maybe_unused hash_init_sha1(struct hash_algo *algo, void **ctxp)
 {
@@ -168,7 +175,8 @@ static int __maybe_unused hash_finish_crc16_ccitt(struct hash_algo *algo,
 	if (size < algo->digest_size)
 		return -1;
 
-	*((uint16_t *)dest_buf) = *((uint16_t *)ctx);
+	/* big-endian, like crc16_ccitt_wd_buf() */
+	*((uint16_t *)dest_buf) = cpu_to_be16(*((uint16_t *)ctx));
 	free(ctx);
 	return 0;
 }
@@ -195,10 +203,119 @@ static int __maybe_unused hash_finish_crc32(struct hash_algo *algo, void *ctx,
 	if (size < algo->digest_size)
 		return -1;
 
-	*((uint32_t *)dest_buf) = *((uint32_t *)ctx);
+	/* big-endian, like crc32_wd_buf() */
+	*((uint32_t *)dest_buf) = cpu_to_be32(*((uint32_t *)ctx));
+	free(ctx);
+	return 0;
+}
+
+#if CONFIG_IS_ENABLED(XXHASH)
+/* xxh64 digests are stored big-endian, the canonical form shown by xxhsum */
+static void xxh64_put_digest(struct xxh64_state *state, void *dest_buf)
+{
+	uint64_t digest = cpu_to_be64(xxh64_digest(state));
+
+	memcpy(dest_buf, &digest, sizeof(digest));
+}
+
+static void xxh64_wd_buf(const unsigned char *input, unsigned int ilen,
+			 unsigned char *output, unsigned int chunk_sz)
+{
+	struct xxh64_state state;
+
+	xxh64_reset(&state, 0);
+	while (ilen) {
+		unsigned int chunk = ilen < chunk_sz ? ilen : chunk_sz;
+
+		xxh64_update(&state, input, chunk);
+		input += chunk;
+		ilen -= chunk;
+#ifndef USE_HOSTCC
+		schedule();
+#endif
+	}
+	xxh64_put_digest(&state, output);
+}
+
+static int hash_init_xxh64(struct hash_algo *algo, void **ctxp)
+{
+	struct xxh64_state *ctx = malloc(sizeof(struct xxh64_state));
+
+	if (!ctx)
+		return -ENOMEM;
+	xxh64_reset(ctx, 0);
+	*ctxp = ctx;
+	return 0;
+}
+
+static int hash_update_xxh64(struct hash_algo *algo, void *ctx,
+			     const void *buf, unsigned int size, int is_last)
+{
+	xxh64_update(ctx, buf, size);
+	return 0;
+}
+
+static int hash_finish_xxh64(struct hash_algo *algo, void *ctx,
+			     void *dest_buf, int size)
+{
+	if (size < algo->digest_size)
+		return -1;
+
+	xxh64_put_digest(ctx, dest_buf);
+	free(ctx);
+	return 0;
+}
+#endif
+
+#if CONFIG_IS_ENABLED(BLAKE2)
+static void blake2b_wd_buf(const unsigned char *input, unsigned int ilen,
+			   unsigned char *output, unsigned int chunk_sz)
+{
+	blake2b_state state;
+
+	blake2b_init(&state, BLAKE2B_OUTBYTES);
+	while (ilen) {
+		unsigned int chunk = ilen < chunk_sz ? ilen : chunk_sz;
+
+		blake2b_update(&state, input, chunk);
+		input += chunk;
+		ilen -= chunk;
+#ifndef USE_HOSTCC
+		schedule();
+#endif
+	}
+	blake2b_final(&state, output, BLAKE2B_OUTBYTES);
+}
+
+static int hash_init_blake2b(struct hash_algo *algo, void **ctxp)
+{
+	blake2b_state *ctx = malloc(sizeof(blake2b_state));
+
+	if (!ctx)
+		return -ENOMEM;
+	blake2b_init(ctx, BLAKE2B_OUTBYTES);
+	*ctxp = ctx;
+	return 0;
+}
+
+static int hash_update_blake2b(struct hash_algo *algo, void *ctx,
+			       const void *buf, unsigned int size, int is_last)
+{
+	blake2b_update(ctx, buf, size);
+	return 0;
+}
+
+static int hash_finish_blake2b(struct hash_algo *algo, void *ctx,
+			       void *dest_buf, int size)
+{
+	if (size < algo->digest_size)
+		return -1;
+
+	blake2b_final(ctx, dest_buf, BLAKE2B_OUTBYTES);
 	free(ctx);
 	return 0;
 }
+#endif
 
 /*
  * These are the hash algorithms we support.  If we have hardware acceleration
@@ -298,6 +415,28 @@ static struct hash_algo hash_algo[] = {
 #endif
 	},
 #endif
+#if CONFIG_IS_ENABLED(BLAKE2)
+	{
+		.name		= "blake2b",
+		.digest_size	= BLAKE2B_OUTBYTES,
+		.chunk_size	= CHUNKSZ,
+		.hash_func_ws	= blake2b_wd_buf,
+		.hash_init	= hash_init_blake2b,
+		.hash_update	= hash_update_blake2b,
+		.hash_finish	= hash_finish_blake2b,
+	},
+#endif
+#if CONFIG_IS_ENABLED(XXHASH)
+	{
+		.name		= "xxh64",
+		.digest_size	= 8,
+		.chunk_size	= CHUNKSZ,
+		.hash_func_ws	= xxh64_wd_buf,
+		.hash_init	= hash_init_xxh64,
+		.hash_update	= hash_update_xxh64,
+		.hash_finish	= hash_finish_xxh64,
+	},
+#endif
 #if CONFIG_IS_ENABLED(CRC16)
 	{
 		.name		= "crc16-ccitt",
@@ -416,6 +555,112 @@ int hash_block(const char *algo_name, const void *data, unsigned int len,
 	return 0;
 }
 
+/*
+ * Size of the chunks fed to each algorithm by hash_multi_update(), small
+ * enough that a chunk is still in the L1 cache for the later algorithms
+ */
+#define HASH_MULTI_CHUNK	SZ_8K
+
+/* Free all contexts but @skip, which is already freed, dropping the results */
+static void hash_multi_free(struct hash_multi *hm, int skip)
+{
+	uint8_t output[HASH_MAX_DIGEST_SIZE];
+	int i;
+
+	for (i = 0; i < hm->count; i++) {
+		if (i != skip)
+			hm->algo[i]->hash_finish(hm->algo[i], hm->ctx[i],
+						 output, sizeof(output));
+	}
+	hm->count = 0;
+}
+
+int hash_multi_init(struct hash_multi *hm, const char *const algo_names[],
+		    int count)
+{
+	int ret;
+	int i;
+
+	if (count < 1 || count > HASH_MULTI_MAX)
+		return -EINVAL;
+
+	hm->count = 0;
+	for (i = 0; i < count; i++) {
+		struct hash_algo *algo;
+
+		ret = hash_progressive_lookup_algo(algo_names[i], &algo);
+		if (!ret && algo->digest_size > HASH_MAX_DIGEST_SIZE)
+			ret = -EPROTONOSUPPORT;
+		if (!ret && algo->hash_init(algo, &hm->ctx[i]))
+			ret = -ENOMEM;
+		if (ret) {
+			hash_multi_free(hm, -1);
+			return ret;
+		}
+		hm->algo[i] = algo;
+		hm->count++;
+	}
+
+	return 0;
+}
+
+int hash_multi_update(struct hash_multi *hm, const void *buf, ulong size,
+		      bool is_last)
+{
+	const uint8_t *p = buf;
+	int i;
+
+	do {
+		ulong chunk = min_t(ulong, size, HASH_MULTI_CHUNK);
+		bool last = is_last && chunk == size;
+
+		for (i = 0; i < hm->count; i++) {
+			if (hm->algo[i]->hash_update(hm->algo[i], hm->ctx[i], p,
+						     chunk, last)) {
+				hash_multi_free(hm, i);
+				return -EIO;
+			}
+		}
+		p += chunk;
+		size -= chunk;
+		schedule();
+	} while (size);
+
+	return 0;
+}
+
+int hash_multi_finish(struct hash_multi *hm, uint8_t *const outputs[])
+{
+	int ret = 0;
+	int i;
+
+	for (i = 0; i < hm->count; i++) {
+		if (hm->algo[i]->hash_finish(hm->algo[i], hm->ctx[i],
+					     outputs[i],
+					     hm->algo[i]->digest_size))
+			ret = -EIO;
+	}
+	hm->count = 0;
+
+	return ret;
+}
+
+int hash_multi_block(const char *const algo_names[], int count,
+		     const void *data, ulong len, uint8_t *const outputs[])
+{
+	struct hash_multi hm;
+	int ret;
+
+	ret = hash_multi_init(&hm, algo_names, count);
+	if (ret)
+		return ret;
+	ret = hash_multi_update(&hm, data, len, true);
+	if (ret)
+		return ret;
+
+	return hash_multi_finish(&hm, outputs);
+}
+
 #if !defined(CONFIG_XPL_BUILD) && (defined(CONFIG_CMD_HASH) || \
 	defined(CONFIG_CMD_SHA1SUM) || defined(CONFIG_CMD_CRC32)) || \
 	defined(CONFIG_CMD_MD5SUM)
@@ -540,6 +785,57 @@ static void hash_show(struct hash_algo *algo, ulong addr, ulong len, uint8_t *ou
 		printf("%02x", output[i]);
 }
 
+/*
+ * Show several digests of a memory area, given as a comma-separated list of
+ * algorithms, reading the memory only once. They cannot be verified or
+ * stored.
+ */
+static int hash_command_multi(const char *algo_names, int flags, ulong addr,
+			      ulong len, int argc)
+{
+	uint8_t digests[HASH_MULTI_MAX][HASH_MAX_DIGEST_SIZE];
+	const char *names[HASH_MULTI_MAX];
+	uint8_t *outputs[HASH_MULTI_MAX];
+	struct hash_algo *algo;
+	char list[64];
+	char *s = list;
+	int count = 0;
+	void *buf;
+	int ret;
+	int i;
+
+	if ((flags & HASH_FLAG_VERIFY) || argc)
+		return CMD_RET_USAGE;
+
+	if (strlcpy(list, algo_names, sizeof(list)) >= sizeof(list))
+		return CMD_RET_USAGE;
+	while (s) {
+		if (count == HASH_MULTI_MAX) {
+			printf("Too many hash algorithms\n");
+			return CMD_RET_FAILURE;
+		}
+		names[count] = strsep(&s, ",");
+		outputs[count] = digests[count];
+		count++;
+	}
+
+	buf = map_sysmem(addr, len);
+	ret = hash_multi_block(names, count, buf, len, outputs);
+	unmap_sysmem(buf);
+	if (ret) {
+		printf("Cannot hash with '%s' (err=%d)\n", algo_names, ret);
+		return CMD_RET_FAILURE;
+	}
+
+	for (i = 0; i < count; i++) {
+		hash_lookup_algo(names[i], &algo);
+		hash_show(algo, addr, len, digests[i]);
+		printf("\n");
+	}
+
+	return 0;
+}
+
 int hash_command(const char *algo_name, int flags, struct cmd_tbl *cmdtp,
 		 int flag, int argc, char *const argv[])
 {
@@ -551,6 +847,10 @@ int hash_command(const char *algo_name, int flags, struct cmd_tbl *cmdtp,
 	addr = hextoul(*argv++, NULL);
 	len = hextoul(*argv++, NULL);
 
+	if (multi_hash() && strchr(algo_name, ','))
+		return hash_command_multi(algo_name, flags, addr, len,
+					  argc - 2);
+
 	if (multi_hash()) {
 		struct hash_algo *algo;
 		u8 *output;
@@ -632,5 +932,44 @@ int hash_command(const char *algo_name, int flags, struct cmd_tbl *cmdtp,
 
 	return 0;
 }
+
+#if IS_ENABLED(CONFIG_CMD_HASH)
+/* Hash the buffer for at least this long to get a stable figure */
+#define HASH_BENCH_MS	200
+
+int hash_bench(ulong len)
+{
+	uint8_t output[HASH_MAX_DIGEST_SIZE];
+	u8 *buf;
+	ulong i;
+
+	buf = malloc(len);
+	if (!buf)
+		return -ENOMEM;
+	for (i = 0; i < len; i++)
+		buf[i] = i * 7 + (i >> 8);
+
+	for (i = 0; i < ARRAY_SIZE(hash_algo); i++) {
+		struct hash_algo *algo = &hash_algo[i];
+		ulong start, elapsed;
+		u64 bytes = 0, rate;
+
+		start = get_timer(0);
+		do {
+			algo->hash_func_ws(buf, len, output, algo->chunk_size);
+			bytes += len;
+			elapsed = get_timer(start);
+		} while (elapsed < HASH_BENCH_MS);
+
+		/* in hundredths of a MiB/s */
+		rate = div_u64((bytes * 1000 * 100) >> 20, elapsed);
+		printf("%-12s %6llu.%02llu MiB/s\n", algo->name,
+		       rate / 100, rate % 100);
+	}
+	free(buf);
+
+	return 0;
+}
+#endif /* CONFIG_CMD_HASH */
 #endif /* CONFIG_CMD_HASH || CONFIG_CMD_SHA1SUM || CONFIG_CMD_CRC32) */
 #endif /* !USE_HOSTCC */
@@ -4,6 +4,7 @@
  * Written by Simon Glass <sjg@chromium.org>
  */
 
+#include <decomp_stream.h>
 #include <errno.h>
 #include <fpga.h>
 #include <gzip.h>
@@ -193,6 +194,164 @@ static int get_aligned_image_size(struct spl_load_info *info, int data_size,
 	return ALIGN(data_size, spl_get_bl_len(info));
 }
 
+/**
+ * spl_fit_stream_supported() - Check if an image can be streamed
+ *
+ * Compressed images can be read in chunks and decompressed straight to their
+ * load address, unless the compressed data must be post-processed as a whole
+ * first, or must be verified but its hashes cannot be checked as it is read.
+ *
+ * @comp: Compression type of the image (IH_COMP_...)
+ * @hashed: true if the hashes of the image are checked as it is read
+ * Return: true if load_simple_fit_stream() can be used
+ */
+static bool spl_fit_stream_supported(int comp, bool hashed)
+{
+	if (!CONFIG_IS_ENABLED(DECOMP_STREAM) ||
+	    CONFIG_IS_ENABLED(FIT_IMAGE_POST_PROCESS))
+		return false;
+	if (CONFIG_IS_ENABLED(FIT_SIGNATURE) && !hashed)
+		return false;
+
+	return (IS_ENABLED(CONFIG_SPL_GZIP) && comp == IH_COMP_GZIP) ||
+	       (IS_ENABLED(CONFIG_SPL_LZMA) && comp == IH_COMP_LZMA);
+}
+
+/**
+ * load_simple_fit_stream() - Read and decompress an image in chunks
+ *
+ * This reads the compressed data SPL_DECOMP_STREAM_CHUNK bytes at a time into
+ * a buffer at CONFIG_SYS_LOAD_ADDR and decompresses each chunk straight to the
+ * load address, so the compressed image is never staged in memory as a whole.
+ *
+ * @info:	points to information about the device to load data from
+ * @offset:	offset of the data on the device, in bytes
+ * @size:	size of the compressed data in bytes
+ * @comp:	compression type (IH_COMP_...)
+ * @load_ptr:	pointer to the load address
+ * @hs:		hashes to check over the compressed data, or NULL for none
+ * @lenp:	returns the size of the decompressed data
+ * Return:	0 on success, -EPERM if the hashes do not match, or another
+ *		negative error number
+ */
+static int load_simple_fit_stream(struct spl_load_info *info, ulong offset,
+				  ulong size, int comp, void *load_ptr,
+				  struct fit_hash_stream *hs, size_t *lenp)
+{
+	ulong chunk = ALIGN(CONFIG_IS_ENABLED(DECOMP_STREAM,
+					      (CONFIG_SPL_DECOMP_STREAM_CHUNK),
+					      (0)),
+			    spl_get_bl_len(info));
+	ulong overhead = get_aligned_image_overhead(info, offset);
+	ulong read_offset = get_aligned_image_offset(info, offset);
+	struct decomp_stream ds;
+	ulong out_len;
+	void *buf;
+	int ret;
+
+	buf = map_sysmem(ALIGN(CONFIG_SYS_LOAD_ADDR, ARCH_DMA_MINALIGN), chunk);
+	ret = decomp_stream_init(&ds, comp, load_ptr, CONFIG_SYS_BOOTM_LEN);
+	if (ret)
+		goto err;
+
+	size += overhead;
+	while (size) {
+		ulong count = min(chunk, size);
+		ulong aligned = ALIGN(count, spl_get_bl_len(info));
+
+		log_debug("stream %lx bytes from offset %lx\n", count,
+			  read_offset);
+		if (info->read(info, read_offset, aligned, buf) < count) {
+			decomp_stream_abort(&ds);
+			ret = -EIO;
+			goto err;
+		}
+		if (hs) {
+			ret = fit_image_hash_stream_update(hs, buf + overhead,
+							   count - overhead);
+			if (ret) {
+				decomp_stream_abort(&ds);
+				return ret;
+			}
+		}
+		ret = decomp_stream_feed(&ds, buf + overhead, count - overhead);
+		if (ret)
+			break;
+		read_offset += aligned;
+		size -= count;
+		overhead = 0;
+	}
+	if (!ret)
+		ret = decomp_stream_finish(&ds, &out_len);
+	if (ret) {
+		puts("Uncompressing error\n");
+		goto err;
+	}
+	if (hs) {
+		if (fit_image_hash_stream_finish(hs))
+			return -EPERM;
+		puts("OK\n");
+	}
+	*lenp = out_len;
+
+	return 0;
+
+err:
+	if (hs)
+		fit_image_hash_stream_abort(hs);
+
+	return ret;
+}
+
+/**
+ * spl_fit_read_hashed() - Read an image in chunks, hashing each one
+ *
+ * Each chunk is hashed straight after it is read, while it is still in the
+ * cache, so there is no need for a second pass over the image to verify it.
+ * On error @hs is freed.
+ *
+ * @info:	points to information about the device to load data from
+ * @read_offset: offset on the device to read from, aligned to the block size
+ * @size:	number of bytes to read, aligned to the block size
+ * @buf:	buffer to read into
+ * @overhead:	number of bytes at the start of @buf before the image data
+ * @len:	size of the image data in bytes
+ * @hs:		hashes to update with the image data
+ * Return:	0 on success, or a negative error number
+ */
+static int spl_fit_read_hashed(struct spl_load_info *info, ulong read_offset,
+			       ulong size, void *buf, ulong overhead, ulong len,
+			       struct fit_hash_stream *hs)
+{
+	ulong chunk = ALIGN(CONFIG_IS_ENABLED(FIT_HASH_STREAM,
+					      (CONFIG_SPL_FIT_HASH_STREAM_CHUNK),
+					      (0)),
+			    spl_get_bl_len(info));
+	ulong pos, count;
+	int ret;
+
+	for (pos = 0; pos < overhead + len; pos += count) {
+		ulong start = max(pos, overhead);
+		ulong end;
+
+		count = min(chunk, size - pos);
+		end = min(pos + count, overhead + len);
+		if (info->read(info, read_offset + pos, count,
+			       buf + pos) < end - pos) {
+			fit_image_hash_stream_abort(hs);
+			return -EIO;
+		}
+		if (start < end) {
+			ret = fit_image_hash_stream_update(hs, buf + start,
+							   end - start);
+			if (ret)
+				return ret;
+		}
+	}
+
+	return 0;
+}
+
 /**
  * load_simple_fit(): load the image described in a certain FIT node
  * @info:	points to information about the device to load data from
@@ -225,6 +384,8 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 	const void *data;
 	const void *fit = ctx->fit;
 	bool external_data = false;
+	struct fit_hash_stream hs;
+	bool hashed = false;
 
 	log_debug("starting\n");
 	if (CONFIG_IS_ENABLED(BOOTMETH_VBE) &&
@@ -291,6 +452,28 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 			return 0;
 		}
 
+		/* if possible, check the hashes as the data is read */
+		if (CONFIG_IS_ENABLED(FIT_SIGNATURE) &&
+		    CONFIG_IS_ENABLED(FIT_HASH_STREAM) &&
+		    !fit_image_hash_stream_init(&hs, fit, node, gd_fdt_blob())) {
+			printf("## Checking hash(es) for Image %s ... ",
+			       fit_get_name(fit, node, NULL));
+			hashed = true;
+		}
+
+		if (spl_fit_stream_supported(image_comp, hashed)) {
+			int ret;
+
+			ret = load_simple_fit_stream(info, fit_offset + offset,
+						     len, image_comp,
+						     map_sysmem(load_addr, 0),
+						     hashed ? &hs : NULL,
+						     &length);
+			if (ret)
+				return ret;
+			goto done;
+		}
+
 		if (spl_decompression_enabled() &&
 		    (image_comp == IH_COMP_GZIP || image_comp == IH_COMP_LZMA))
 			src_ptr = map_sysmem(ALIGN(CONFIG_SYS_LOAD_ADDR, ARCH_DMA_MINALIGN), len);
@@ -305,8 +488,18 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 		log_debug("reading from offset %x / %lx size %lx to %p: ",
 			  offset, read_offset, size, src_ptr);
 
-		if (info->read(info, read_offset, size, src_ptr) < length)
+		if (hashed) {
+			int ret;
+
+			ret = spl_fit_read_hashed(info, read_offset, size,
+						  src_ptr, overhead, length,
+						  &hs);
+			if (ret)
+				return ret;
+		} else if (info->read(info, read_offset, size,
+				      src_ptr) < length) {
 			return -EIO;
+		}
 
 		debug("External data: dst=%p, offset=%x, size=%lx\n",
 		      src_ptr, offset, (unsigned long)length);
@@ -322,7 +515,11 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 		src = (void *)data;	/* cast away const */
 	}
 
-	if (CONFIG_IS_ENABLED(FIT_SIGNATURE)) {
+	if (hashed) {
+		if (fit_image_hash_stream_finish(&hs))
+			return -EPERM;
+		puts("OK\n");
+	} else if (CONFIG_IS_ENABLED(FIT_SIGNATURE)) {
 		printf("## Checking hash(es) for Image %s ... ",
 		       fit_get_name(fit, node, NULL));
 		if (!fit_image_verify_with_data(fit, node, gd_fdt_blob(), src,
@@ -356,6 +553,7 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 		memmove(load_ptr, src, length);
 	}
 
+done:
 	if (image_info) {
 		ulong entry_point;
 
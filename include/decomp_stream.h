@@ -0,0 +1,106 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Decompressing a compressed image in pieces, as it is read from storage
+ *
+ * Copyright 2026 The U-Boot Authors
+ */
+
+#ifndef __DECOMP_STREAM_H
+#define __DECOMP_STREAM_H
+
+#include <linux/types.h>
+
+struct decomp_stream_ops;
+struct hash_algo;
+
+/**
+ * struct decomp_stream - State for decompressing a stream in pieces
+ *
+ * The compressed data is passed to decomp_stream_feed() in pieces of any
+ * size, as it becomes available, and is decompressed straight into the
+ * output buffer. This avoids staging the whole compressed image in memory
+ * before decompressing it.
+ *
+ * If @hash is set, every byte passed to decomp_stream_feed() is also passed
+ * to the hash, so the compressed data can be verified in the same pass. The
+ * caller is responsible for calling hash_init() and hash_finish().
+ *
+ * @comp: Compression type (IH_COMP_...)
+ * @out: Output buffer
+ * @out_size: Size of output buffer in bytes
+ * @out_len: Number of bytes written to @out so far
+ * @in_len: Number of compressed bytes fed so far
+ * @done: true once the end of the compressed stream has been seen. Any
+ *	further data fed is ignored
+ * @hash: Hash algorithm to run over the compressed data, or NULL for none
+ * @hash_ctx: Hash context to use with @hash
+ * @ops: Decompressor operations, selected by @comp
+ * @priv: Private state for the decompressor
+ */
+struct decomp_stream {
+	int comp;
+	void *out;
+	ulong out_size;
+	ulong out_len;
+	ulong in_len;
+	bool done;
+	struct hash_algo *hash;
+	void *hash_ctx;
+	const struct decomp_stream_ops *ops;
+	void *priv;
+};
+
+/**
+ * decomp_stream_supported() - Check if a compression type can be streamed
+ *
+ * @comp: Compression type (IH_COMP_...)
+ * Return: true if decomp_stream_init() supports @comp
+ */
+bool decomp_stream_supported(int comp);
+
+/**
+ * decomp_stream_init() - Set up to decompress a stream
+ *
+ * @ds: Stream to set up
+ * @comp: Compression type (IH_COMP_...)
+ * @out: Output buffer
+ * @out_size: Size of output buffer in bytes
+ * Return: 0 if OK, -EPROTONOSUPPORT if @comp is not supported, -ENOMEM if out
+ * of memory
+ */
+int decomp_stream_init(struct decomp_stream *ds, int comp, void *out,
+		       ulong out_size);
+
+/**
+ * decomp_stream_feed() - Decompress the next piece of a stream
+ *
+ * On error the stream is freed, so there is no need to call
+ * decomp_stream_abort()
+ *
+ * @ds: Stream to use
+ * @in: Compressed data
+ * @len: Length of compressed data in bytes
+ * Return: 0 if OK, -ENOSPC if the output buffer is too small, -EINVAL if the
+ * compressed data is corrupt, other -ve on other error
+ */
+int decomp_stream_feed(struct decomp_stream *ds, const void *in, ulong len);
+
+/**
+ * decomp_stream_finish() - Finish decompressing a stream
+ *
+ * This checks that the whole stream has been seen and frees the stream.
+ *
+ * @ds: Stream to finish
+ * @out_lenp: Returns the number of bytes written to the output buffer
+ * Return: 0 if OK, -EINVAL if the stream was truncated
+ */
+int decomp_stream_finish(struct decomp_stream *ds, ulong *out_lenp);
+
+/**
+ * decomp_stream_abort() - Free a stream without finishing it
+ *
+ * @ds: Stream to free
+ */
+void decomp_stream_abort(struct decomp_stream *ds);
+
+#endif
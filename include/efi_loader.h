@@ -1067,6 +1067,8 @@ struct efi_sig_data {
 	size_t size;
 };
 
+struct efi_sig_index;
+
 /**
  * struct efi_signature_store - A decoded data of signature database
  *
@@ -1075,11 +1077,14 @@ struct efi_sig_data {
  * @next:		Pointer to next entry
  * @sig_type:		Signature type
  * @sig_data_list:	Pointer to signature list
+ * @index:		Sorted lookup tables for the whole database, held
+ *			in the first entry only
  */
 struct efi_signature_store {
 	struct efi_signature_store *next;
 	efi_guid_t sig_type;
 	struct efi_sig_data *sig_data_list;
+	struct efi_sig_index *index;
 };
 
 struct x509_certificate;
@@ -1127,6 +1132,8 @@ void efi_sigstore_free(struct efi_signature_store *sigstore);
 struct efi_signature_store *efi_build_signature_store(void *sig_list,
 						      efi_uintn_t size);
 struct efi_signature_store *efi_sigstore_parse_sigdb(u16 *name);
+struct efi_signature_store *efi_sigstore_get_sigdb(u16 *name);
+void efi_sigstore_invalidate(const u16 *name, const efi_guid_t *vendor);
 
 bool efi_secure_boot_enabled(void);
 
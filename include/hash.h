@@ -16,7 +16,8 @@ struct cmd_tbl;
  * Maximum digest size for all algorithms we support. Having this value
  * avoids a malloc() or C99 local declaration in common/cmd_hash.c.
  */
-#if CONFIG_IS_ENABLED(SHA384) || CONFIG_IS_ENABLED(SHA512)
+#if CONFIG_IS_ENABLED(SHA384) || CONFIG_IS_ENABLED(SHA512) || \
+	CONFIG_IS_ENABLED(BLAKE2)
 #define HASH_MAX_DIGEST_SIZE	64
 #else
 #define HASH_MAX_DIGEST_SIZE	32
@@ -120,6 +121,87 @@ int hash_command(const char *algo_name, int flags, struct cmd_tbl *cmdtp,
 int hash_block(const char *algo_name, const void *data, unsigned int len,
 	       uint8_t *output, int *output_size);
 
+/* Maximum number of algorithms in a struct hash_multi */
+#define HASH_MULTI_MAX		8
+
+/**
+ * struct hash_multi - Several digests of the same data, worked out together
+ *
+ * The data is fed to each algorithm in turn in chunks small enough to stay
+ * in the CPU cache, so it is only read from memory once however many digests
+ * are needed.
+ *
+ * @count: Number of algorithms in use
+ * @algo: Algorithms in use
+ * @ctx: Progressive hashing context for each algorithm
+ */
+struct hash_multi {
+	int count;
+	struct hash_algo *algo[HASH_MULTI_MAX];
+	void *ctx[HASH_MULTI_MAX];
+};
+
+/**
+ * hash_multi_init() - Start working out several digests of the same data
+ *
+ * @hm: Context to set up
+ * @algo_names: Names of the algorithms to use
+ * @count: Number of algorithms, at most HASH_MULTI_MAX
+ * Return: 0 if ok, -EINVAL if @count is out of range, -EPROTONOSUPPORT if
+ * an algorithm does not support progressive hashing, -ENOMEM if out of
+ * memory
+ */
+int hash_multi_init(struct hash_multi *hm, const char *const algo_names[],
+		    int count);
+
+/**
+ * hash_multi_update() - Add data to all the digests
+ *
+ * All contexts are freed if an error occurs.
+ *
+ * @hm: Context set up by hash_multi_init()
+ * @buf: Data to hash
+ * @size: Size of the data in bytes
+ * @is_last: true if this is the last update
+ * Return: 0 if ok, -EIO if an algorithm failed
+ */
+int hash_multi_update(struct hash_multi *hm, const void *buf, ulong size,
+		      bool is_last);
+
+/**
+ * hash_multi_finish() - Write out all the digests and free the contexts
+ *
+ * @hm: Context set up by hash_multi_init()
+ * @outputs: Buffer for each digest, in the order the algorithms were given
+ *	to hash_multi_init(), each holding that algorithm's digest_size bytes
+ * Return: 0 if ok, -EIO if an algorithm failed
+ */
+int hash_multi_finish(struct hash_multi *hm, uint8_t *const outputs[]);
+
+/**
+ * hash_multi_block() - Hash a block with several algorithms in one pass
+ *
+ * @algo_names: Names of the algorithms to use
+ * @count: Number of algorithms, at most HASH_MULTI_MAX
+ * @data: Data to hash
+ * @len: Size of the data in bytes
+ * @outputs: Buffer for each digest, in the order of @algo_names
+ * Return: 0 if ok, other -ve value on error (see hash_multi_init())
+ */
+int hash_multi_block(const char *const algo_names[], int count,
+		     const void *data, ulong len, uint8_t *const outputs[]);
+
+/**
+ * hash_bench() - Measure the speed of each hash algorithm
+ *
+ * Each algorithm hashes a buffer of @len bytes repeatedly for a short time
+ * and its throughput in MiB/s is printed.
+ *
+ * @len: Size of the buffer to hash, in bytes
+ * Return: 0 if ok, -ENOMEM if the buffer could not be allocated
+ */
+int hash_bench(ulong len);
+
 #endif /* !USE_HOSTCC */
 
 /**
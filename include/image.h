@@ -1070,6 +1070,8 @@ int booti_setup(ulong image, ulong *relocated_addr, ulong *size,
 #define FIT_ALGO_PROP		"algo"
 #define FIT_VALUE_PROP		"value"
 #define FIT_IGNORE_PROP		"uboot-ignore"
+#define FIT_CHUNK_SIZE_PROP	"chunk-size"
+#define FIT_CHUNK_VALUE_PROP	"chunk-value"
 #define FIT_SIG_NODENAME	"signature"
 #define FIT_KEY_REQUIRED	"required"
 #define FIT_KEY_HINT		"key-name-hint"
@@ -1260,6 +1262,26 @@ int fit_image_hash_get_algo(const void *fit, int noffset, const char **algo);
 int fit_image_hash_get_value(const void *fit, int noffset, uint8_t **value,
 				int *value_len);
 
+/**
+ * fit_image_hash_get_chunks() - Get the chunk table of a hash node
+ *
+ * A hash node with a chunk-size property holds a hash of each chunk of the
+ * image in its chunk-value property, one after the other. Its value property
+ * is then the hash of chunk-value, rather than of the image itself, so each
+ * chunk can be checked as soon as it has been read.
+ *
+ * @fit: FIT to read from
+ * @noffset: Offset of hash node
+ * @chunk_sizep: Returns the size of each chunk in bytes (the last chunk may
+ *	be smaller)
+ * @tablep: Returns a pointer to the chunk table
+ * @table_lenp: Returns the size of the chunk table in bytes
+ * Return: 0 if OK, -ENOENT if the hash node covers the whole image, -EINVAL
+ * if the chunk-size property is invalid or there is no chunk table
+ */
+int fit_image_hash_get_chunks(const void *fit, int noffset, ulong *chunk_sizep,
+			      const uint8_t **tablep, int *table_lenp);
+
 int fit_set_timestamp(void *fit, int noffset, time_t timestamp);
 
 /**
@@ -1343,6 +1365,96 @@ int fit_image_verify_with_data(const void *fit, int image_noffset,
 			       size_t size);
 
 int fit_image_verify(const void *fit, int noffset);
+
+#define FIT_HASH_STREAM_MAX	4
+
+/**
+ * struct fit_hash_stream - State for checking the hashes of an image in pieces
+ *
+ * This allows the hashes of an image to be checked as its data is loaded,
+ * rather than in a separate pass over the data once it is all in memory.
+ *
+ * @fit: FIT containing the image
+ * @image_noffset: Offset of the image node in @fit
+ * @count: Number of entries in @hash
+ * @hash: Hashes to check
+ * @hash.noffset: Offset of the hash node in @fit
+ * @hash.algo: Hash algorithm
+ * @hash.ctx: Progressive hash context for @hash.algo
+ * @hash.chunk_size: Size of each chunk, or 0 if the hash covers the whole image
+ *	(see fit_image_hash_get_chunks())
+ * @hash.chunk_pos: Number of bytes of the current chunk hashed so far
+ * @hash.chunk: Index of the current chunk
+ * @hash.chunk_count: Number of chunks in @hash.table
+ * @hash.table: Hash of each chunk, already checked against the hash value
+ */
+struct fit_hash_stream {
+	const void *fit;
+	int image_noffset;
+	int count;
+	struct {
+		int noffset;
+		struct hash_algo *algo;
+		void *ctx;
+		ulong chunk_size;
+		ulong chunk_pos;
+		int chunk;
+		int chunk_count;
+		const uint8_t *table;
+	} hash[FIT_HASH_STREAM_MAX];
+};
+
+/**
+ * fit_image_hash_stream_init() - Start checking the hashes of an image
+ *
+ * This fails if the image cannot be checked in pieces, e.g. because it has
+ * a signature or uses a hash algorithm without progressive support. The
+ * caller should then check the image with fit_image_verify_with_data() once
+ * it is all in memory, which also reports any problem with the hash nodes.
+ *
+ * @hs: Stream to set up
+ * @fit: FIT containing the image
+ * @image_noffset: Offset of the image node in @fit
+ * @key_blob: FDT containing public keys
+ * Return: 0 if OK, -EPROTONOSUPPORT if the image cannot be checked in pieces,
+ * -ENOMEM if out of memory
+ */
+int fit_image_hash_stream_init(struct fit_hash_stream *hs, const void *fit,
+			       int image_noffset, const void *key_blob);
+
+/**
+ * fit_image_hash_stream_update() - Add the next piece of image data
+ *
+ * Chunked hashes are checked as soon as each chunk is complete. On error the
+ * stream is freed, so there is no need to call fit_image_hash_stream_abort()
+ *
+ * @hs: Stream to update
+ * @data: Image data
+ * @len: Length of @data in bytes
+ * Return: 0 if OK, -EBADMSG if a chunk does not match its hash, -EIO if a
+ * hash failed
+ */
+int fit_image_hash_stream_update(struct fit_hash_stream *hs, const void *data,
+				 ulong len);
+
+/**
+ * fit_image_hash_stream_finish() - Check the hashes of an image
+ *
+ * This prints the name of each hash as it is checked, in the same way as
+ * fit_image_verify_with_data(), and frees the stream.
+ *
+ * @hs: Stream to finish
+ * Return: 0 if all hashes match, -EBADMSG if not, -EIO if a hash failed
+ */
+int fit_image_hash_stream_finish(struct fit_hash_stream *hs);
+
+/**
+ * fit_image_hash_stream_abort() - Free a stream without checking the hashes
+ *
+ * @hs: Stream to free
+ */
+void fit_image_hash_stream_abort(struct fit_hash_stream *hs);
+
 #if CONFIG_IS_ENABLED(FIT_SIGNATURE)
 int fit_config_verify(const void *fit, int conf_noffset);
 #else
@@ -455,4 +455,100 @@ struct abuf;
  */
 int zstd_decompress(struct abuf *in, struct abuf *out);
 
+/**
+ * struct zstd_stream - State for decompressing Zstandard data in pieces
+ *
+ * This wraps a zstd_dstream so that callers can feed compressed data as it
+ * becomes available. Any number of concatenated frames is accepted, including
+ * skippable frames. Anything that is not a valid frame header, once at least
+ * one frame has been decoded, is treated as trailing padding and ignored.
+ *
+ * @dstream: Streaming decompression context, inside @workspace
+ * @workspace: Memory allocated for the context and its buffers
+ * @frames: Number of complete frames decoded so far, including skippable
+ *	frames
+ * @tail: Number of bytes seen since the end of the last frame
+ * @frame_end: true if the input so far ends at the end of a frame, or is
+ *	followed by too few bytes to tell whether another frame starts
+ * @done: true once trailing padding has been seen. Any further input is
+ *	ignored
+ */
+struct zstd_stream {
+	zstd_dstream *dstream;
+	void *workspace;
+	uint frames;
+	uint tail;
+	bool frame_end;
+	bool done;
+};
+
+/**
+ * zstd_stream_init() - Set up to decompress Zstandard data in pieces
+ *
+ * Normally the decoder keeps its own copy of the last @max_window bytes of
+ * output, so that the caller can pass a different output buffer on each call
+ * and memory use is bounded by the window size rather than the image size.
+ *
+ * If @flat is true the caller must instead pass the same output buffer, with
+ * the same size, on every call to zstd_stream_feed(), leaving @out->pos as
+ * it was returned. The decoder then uses the output as its window, so only
+ * about 128KB is needed regardless of the window size.
+ *
+ * @zs: Stream to set up
+ * @max_window: Largest window size to accept, in bytes. Ignored if @flat
+ * @flat: true if the output is a single flat buffer
+ * Return: 0 if OK, -ENOMEM if out of memory
+ */
+int zstd_stream_init(struct zstd_stream *zs, size_t max_window, bool flat);
+
+/**
+ * zstd_stream_feed() - Decompress the next piece of a stream
+ *
+ * This consumes as much input as possible, stopping early only if the output
+ * buffer is full. The caller should check @in->pos and @out->pos to see what
+ * happened.
+ *
+ * @zs: Stream to use
+ * @in: Compressed data; @in->pos is updated with the number of bytes used
+ * @out: Output buffer; @out->pos is updated with the number of bytes written
+ * Return: 0 if OK, -E2BIG if a frame needs a larger window than the stream
+ * was set up for, -EINVAL if the data is corrupt
+ */
+int zstd_stream_feed(struct zstd_stream *zs, zstd_in_buffer *in,
+		     zstd_out_buffer *out);
+
+/**
+ * zstd_stream_finish() - Finish decompressing a stream
+ *
+ * This checks that the stream ended at the end of a frame and frees it.
+ *
+ * @zs: Stream to finish
+ * Return: 0 if OK, -EINVAL if the stream was truncated
+ */
+int zstd_stream_finish(struct zstd_stream *zs);
+
+/**
+ * zstd_stream_free() - Free a stream without finishing it
+ *
+ * @zs: Stream to free
+ */
+void zstd_stream_free(struct zstd_stream *zs);
+
+/**
+ * zstd_seekable_read() - Read part of a file in the zstd seekable format
+ *
+ * A seekable file is a series of independent frames followed by a seek table
+ * giving the compressed and decompressed size of each. Only the frames which
+ * cover the requested range are decompressed, starting from the nearest
+ * frame boundary rather than the start of the file.
+ *
+ * @in: Complete seekable file
+ * @offset: Offset into the decompressed data to read from
+ * @out: Output buffer; its size is the number of bytes to read
+ * Return: number of bytes read, which is less than the size of @out only at
+ * the end of the data, -ENOENT if @in has no seek table, -EINVAL if it is
+ * corrupt, other -ve on other error
+ */
+int zstd_seekable_read(struct abuf *in, ulong offset, struct abuf *out);
+
 #endif  /* LINUX_ZSTD_H */
@@ -87,6 +87,7 @@ struct ip_tcp_hdr {
 #define TCP_OPT_LEN_A	0x0a		/* Timestamp Length		*/
 #define TCP_MSS		1460		/* Max segment size		*/
 #define TCP_SCALE	0x01		/* Scale			*/
+#define TCP_MAX_SCALE	14		/* Largest scale (RFC 7323)	*/
 
 /**
  * struct tcp_mss - TCP option structure for MSS (Max segment size)
@@ -156,6 +157,24 @@ struct tcp_sack_v {
 	struct	sack_edges hill[TCP_SACK_HILLS];
 } __packed;
 
+/*
+ * Next to the timestamp option there is only room for three SACK blocks
+ * in a segment, but more hills are kept so that data received out of order
+ * need not be sent again.
+ */
+#define TCP_SACK_BLOCKS	3
+#define TCP_RX_HILLS	16
+
+/**
+ * struct tcp_rx_hills - data received beyond rcv_nxt
+ * @len: Length of a SACK option listing all the hills
+ * @hill: L & R edges of the hills, in sequence order
+ */
+struct tcp_rx_hills {
+	u8	len;
+	struct	sack_edges hill[TCP_RX_HILLS];
+};
+
 /**
  * struct tcp_t_opt - TCP option structure for time stamps
  * @kind: Field ID
@@ -357,7 +376,10 @@ enum tcp_status {
  * @loc_timestamp:	Local timestamp
  * @rmt_timestamp:	Remote timestamp
  *
+ * @rcv_wnd_scale:	Local window scale factor
  * @rmt_win_scale:	Remote window scale factor
+ * @win_scale_ok:	Non-zero if both SYN segments carried a window scale
+ *			  option, so that the factors are in use
  *
  * @lost:		Used for SACK
  *
@@ -419,10 +441,12 @@ struct tcp_stream {
 	u32		rmt_timestamp;
 
 	/* TCP window scale */
+	u8		rcv_wnd_scale;
 	u8		rmt_win_scale;
+	int		win_scale_ok;
 
 	/* TCP sliding window control used to request re-TX */
-	struct tcp_sack_v lost;
+	struct tcp_rx_hills lost;
 
 	/* used for data retransmission */
 	int		retry_cnt;
@@ -495,6 +519,21 @@ void tcp_stream_put(struct tcp_stream *tcp);
  */
 void tcp_stream_restart_rx_timer(struct tcp_stream *tcp);
 
+/*
+ * tcp_stream_set_rcv_wnd -- Set the receive window of a new stream. Call it
+ *                           from the on_create() handler, before the SYN
+ *                           segment is sent. The window is limited to
+ *                           CONFIG_TCP_RCV_WND_MAX and, if the remote side
+ *                           does not do window scaling, to 64KiB.
+ *
+ *                           A window larger than the packet buffers only
+ *                           makes sense if rx() copies the data straight to
+ *                           its final place, whatever order it arrives in.
+ * @tcp:	TCP stream
+ * @size:	Receive window in bytes
+ */
+void tcp_stream_set_rcv_wnd(struct tcp_stream *tcp, ulong size);
+
 enum tcp_state  tcp_stream_get_state(struct tcp_stream *tcp);
 enum tcp_status tcp_stream_get_status(struct tcp_stream *tcp);
 
@@ -6,21 +6,90 @@
 #ifndef __LZ4_H
 #define __LZ4_H
 
+#include <linux/types.h>
+
+struct ulz4f_stream;
+
 /**
  * ulz4fn() - Decompress LZ4 data
  *
+ * This handles any number of LZ4 frames, with linked or independent blocks,
+ * and skips skippable frames. Once one frame has been decoded, anything that
+ * does not start with a frame magic number is ignored. Block and content
+ * checksums are verified if CONFIG_LZ4_CHECKSUM is enabled.
+ *
  * @src: Source data to decompress
  * @srcn: Length of source data
  * @dst: Destination for uncompressed data
  * @dstn: Returns length of uncompressed data
  * Return: 0 if OK, -EPROTONOSUPPORT if the magic number or version number are
- *	not recognised or independent blocks are used, -EINVAL if the reserved
- *	fields are non-zero, or input is overrun, -EENOBUFS if the destination
- *	buffer is overrun, -EEPROTO if the compressed data causes an error in
- *	the decompression algorithm
+ *	not recognised or a dictionary is needed, -EINVAL if the reserved
+ *	fields are non-zero, the content size is wrong or input is overrun,
+ *	-ENOBUFS if the destination buffer is overrun, -EPROTO if the compressed
+ *	data causes an error in the decompression algorithm, -EBADMSG if a
+ *	checksum does not match
  */
 int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn);
 
+/**
+ * ulz4f_content_size() - Get the decompressed size of an LZ4 frame
+ *
+ * This allows the caller to allocate the right amount of space before
+ * decompressing. The size is only available if the frame header includes it
+ * ('lz4 --content-size').
+ *
+ * @src: Start of LZ4 frame
+ * @srcn: Length of source data
+ * @sizep: Returns the decompressed size of the frame
+ * Return: 0 if OK, -ENOENT if the frame does not give its size, other -ve
+ *	error if the header is invalid (see ulz4fn())
+ */
+int ulz4f_content_size(const void *src, size_t srcn, u64 *sizep);
+
+/**
+ * ulz4f_stream_new() - Set up to decompress LZ4 frames in pieces
+ *
+ * The compressed data is passed to ulz4f_stream_feed() in pieces of any size
+ * and decompressed into a single output buffer. Compressed blocks which are
+ * split between pieces are gathered in a buffer first, so smaller blocks
+ * ('lz4 -B4') use less memory.
+ *
+ * @dst: Output buffer
+ * @dst_size: Size of output buffer in bytes
+ * @strmp: Returns the new stream
+ * Return: 0 if OK, -ENOMEM if out of memory
+ */
+int ulz4f_stream_new(void *dst, size_t dst_size, struct ulz4f_stream **strmp);
+
+/**
+ * ulz4f_stream_feed() - Decompress the next piece of LZ4 data
+ *
+ * @strm: Stream to use
+ * @src: Compressed data
+ * @srcn: Length of compressed data in bytes
+ * @dstn: Returns the number of bytes written to the output buffer so far
+ * Return: 0 if OK, -ENOSPC if the output buffer is too small, -ENOMEM if out
+ *	of memory, other -ve error as for ulz4fn()
+ */
+int ulz4f_stream_feed(struct ulz4f_stream *strm, const void *src, size_t srcn,
+		      size_t *dstn);
+
+/**
+ * ulz4f_stream_ended() - Check if the data so far is complete
+ *
+ * @strm: Stream to check
+ * Return: true if at least one frame has been seen and the data ends after
+ *	the end of a frame
+ */
+bool ulz4f_stream_ended(struct ulz4f_stream *strm);
+
+/**
+ * ulz4f_stream_free() - Free a stream
+ *
+ * @strm: Stream to free, or NULL
+ */
+void ulz4f_stream_free(struct ulz4f_stream *strm);
+
 /**
  * LZ4_decompress_safe() - Decompression protected against buffer overflow
  * @source: source address of the compressed data
@@ -56,6 +56,9 @@ void rsa_free_key_prop(struct key_prop *prop);
  *
  * Operation: out[] = sig ^ exponent % modulus
  *
+ * The key is converted for Montgomery arithmetic on first use and the result
+ * is kept, so that later verifications with the same key can skip this.
+ *
  * @sig:	RSA PKCS1.5 signature
  * @sig_len:	Length of signature in number of bytes
  * @node:	Node with RSA key elements like modulus, exponent, R^2, n0inv
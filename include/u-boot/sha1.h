@@ -70,6 +70,30 @@ void sha1_starts(sha1_context *ctx);
 void sha1_update(sha1_context *ctx, const unsigned char *input,
 		 unsigned int ilen);
 
+/**
+ * \brief	   SHA-1 process whole 64-byte blocks
+ *
+ * This is weak so that architecture code can provide a faster version,
+ * which must fall back to sha1_process_generic() if the CPU it runs on
+ * lacks the instructions used.
+ *
+ * \param ctx	   SHA-1 context
+ * \param data     buffer holding the blocks
+ * \param blocks   number of blocks
+ */
+void sha1_process(sha1_context *ctx, const unsigned char *data,
+		  unsigned int blocks);
+
+/**
+ * \brief	   SHA-1 process whole 64-byte blocks, in portable C
+ *
+ * \param ctx	   SHA-1 context
+ * \param data     buffer holding the blocks
+ * \param blocks   number of blocks
+ */
+void sha1_process_generic(sha1_context *ctx, const unsigned char *data,
+			  unsigned int blocks);
+
 /**
  * \brief	   SHA-1 final digest
  *
@@ -34,6 +34,17 @@ void sha512_starts(sha512_context * ctx);
 void sha512_update(sha512_context *ctx, const uint8_t *input, uint32_t length);
 void sha512_finish(sha512_context * ctx, uint8_t digest[SHA512_SUM_LEN]);
 
+/*
+ * Hash whole 128-byte blocks, for SHA-384 as well as SHA-512.
+ * sha512_process() is weak so that architecture code can provide a faster
+ * version, which must fall back to sha512_process_generic() if the CPU lacks
+ * the instructions it uses.
+ */
+void sha512_process(sha512_context *ctx, const uint8_t *data,
+		    unsigned int blocks);
+void sha512_process_generic(sha512_context *ctx, const uint8_t *data,
+			    unsigned int blocks);
+
 void sha512_csum_wd(const unsigned char *input, unsigned int ilen,
 		unsigned char *output, unsigned int chunk_sz);
 
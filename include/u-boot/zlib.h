@@ -750,6 +750,9 @@ ZEXTERN int ZEXPORT inflateInit2_ OF((z_streamp strm, int  windowBits,
 extern void *gzalloc(void *, unsigned, unsigned);
 extern void gzfree(void *, void *, unsigned);
 
+/* Set to 0 to use the stock inflate fast path (CONFIG_ZLIB_INFLATE_CHUNK) */
+extern int inflate_chunk_enable;
+
 #ifdef __cplusplus
 }
 #endif
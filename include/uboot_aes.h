@@ -38,8 +38,18 @@ enum {
 	AES192_EXPAND_KEY_LENGTH = 4 * AES_STATECOLS * (AES192_ROUNDS + 1),
 	AES256_EXPAND_KEY_LENGTH = 4 * AES_STATECOLS * (AES256_ROUNDS + 1),
 	AES_BLOCK_LENGTH	= 128 / 8,
+	AES_GCM_IV_LENGTH	= 96 / 8,
+	AES_GCM_TAG_LENGTH	= 128 / 8,
 };
 
+/**
+ * aes_get_rounds() - Get the number of rounds for a key size
+ *
+ * @key_size	Size of the key (in bytes)
+ * Return:	number of rounds, AES128_ROUNDS for an unknown size
+ */
+u32 aes_get_rounds(u32 key_size);
+
 /**
  * aes_expand_key() - Expand the AES key
  *
@@ -109,6 +119,83 @@ void aes_cbc_encrypt_blocks(u32 key_size, u8 *key_exp, u8 *iv, u8 *src, u8 *dst,
 void aes_cbc_decrypt_blocks(u32 key_size, u8 *key_exp, u8 *iv, u8 *src, u8 *dst,
 			    u32 num_aes_blocks);
 
+/*
+ * C versions of the above, which an architecture with faster AES
+ * instructions can fall back to when the CPU does not have them
+ */
+void aes_cbc_encrypt_blocks_generic(u32 key_size, u8 *key_exp, u8 *iv,
+				    u8 *src, u8 *dst, u32 num_aes_blocks);
+void aes_cbc_decrypt_blocks_generic(u32 key_size, u8 *key_exp, u8 *iv,
+				    u8 *src, u8 *dst, u32 num_aes_blocks);
+
+/**
+ * aes_ctr_blocks() - Encrypt or decrypt multiple blocks of data with AES CTR
+ *
+ * @key_size		Size of the aes key (in bits)
+ * @key_exp		Expanded key to use
+ * @ctr			Counter block, as a 128-bit big-endian number,
+ *			which is advanced by num_aes_blocks
+ * @src			Source data
+ * @dst			Destination buffer, which may be the same as src
+ * @num_aes_blocks	Number of AES blocks to process
+ */
+void aes_ctr_blocks(u32 key_size, u8 *key_exp, u8 *ctr, u8 *src, u8 *dst,
+		    u32 num_aes_blocks);
+void aes_ctr_blocks_generic(u32 key_size, u8 *key_exp, u8 *ctr, u8 *src,
+			    u8 *dst, u32 num_aes_blocks);
+
+/**
+ * aes_ctr_crypt() - Encrypt or decrypt data of any length with AES CTR
+ *
+ * Only the last call for a stream may have a length which is not a multiple
+ * of AES_BLOCK_LENGTH, since the rest of the last key stream block is lost.
+ *
+ * @key_size		Size of the aes key (in bits)
+ * @key_exp		Expanded key to use
+ * @ctr			Counter block, advanced past the blocks used
+ * @src			Source data
+ * @dst			Destination buffer, which may be the same as src
+ * @len			Number of bytes to process
+ */
+void aes_ctr_crypt(u32 key_size, u8 *key_exp, u8 *ctr, u8 *src, u8 *dst,
+		   u32 len);
+
+/**
+ * aes_gcm_encrypt() - Encrypt and authenticate data with AES GCM
+ *
+ * @key_size		Size of the aes key (in bits)
+ * @key_exp		Expanded key to use
+ * @iv			Initialization vector, AES_GCM_IV_LENGTH bytes
+ * @aad			Additional data, which is authenticated but not
+ *			encrypted
+ * @aad_len		Length of the additional data in bytes
+ * @src			Source data to encrypt
+ * @dst			Destination buffer, which may be the same as src
+ * @len			Length of the data in bytes
+ * @tag			Buffer for the authentication tag,
+ *			AES_GCM_TAG_LENGTH bytes
+ */
+void aes_gcm_encrypt(u32 key_size, u8 *key_exp, u8 *iv, u8 *aad, u32 aad_len,
+		     u8 *src, u8 *dst, u32 len, u8 *tag);
+
+/**
+ * aes_gcm_decrypt() - Decrypt and check data with AES GCM
+ *
+ * @key_size		Size of the aes key (in bits)
+ * @key_exp		Expanded key to use
+ * @iv			Initialization vector, AES_GCM_IV_LENGTH bytes
+ * @aad			Additional data
+ * @aad_len		Length of the additional data in bytes
+ * @src			Source data to decrypt
+ * @dst			Destination buffer, which may be the same as src
+ * @len			Length of the data in bytes
+ * @tag			Expected tag, AES_GCM_TAG_LENGTH bytes
+ * Return:		0 if OK, -EBADMSG if the tag does not match, in which
+ *			case dst is cleared
+ */
+int aes_gcm_decrypt(u32 key_size, u8 *key_exp, u8 *iv, u8 *aad, u32 aad_len,
+		    u8 *src, u8 *dst, u32 len, u8 *tag);
+
 /* An AES block filled with zeros */
 static const u8 AES_ZERO_BLOCK[AES_BLOCK_LENGTH] = { 0 };
 struct udevice;
@@ -24,10 +24,12 @@
 #ifndef USE_HOSTCC
 #include <display_options.h>
 #include <log.h>
+#include <linux/kernel.h>
 #include <linux/string.h>
 #else
 #include <string.h>
 #endif
+#include <linux/compiler_attributes.h>
 #include "uboot_aes.h"
 
 /* forward s-box */
@@ -102,415 +104,185 @@ static const u8 inv_sbox[256] = {
 	0xe1, 0x69, 0x14, 0x63, 0x55, 0x21, 0x0c, 0x7d
 };
 
-/* combined Xtimes2[Sbox[]] */
-static const u8 x2_sbox[256] = {
-	0xc6, 0xf8, 0xee, 0xf6, 0xff, 0xd6, 0xde, 0x91,
-	0x60, 0x02, 0xce, 0x56, 0xe7, 0xb5, 0x4d, 0xec,
-	0x8f, 0x1f, 0x89, 0xfa, 0xef, 0xb2, 0x8e, 0xfb,
-	0x41, 0xb3, 0x5f, 0x45, 0x23, 0x53, 0xe4, 0x9b,
-	0x75, 0xe1, 0x3d, 0x4c, 0x6c, 0x7e, 0xf5, 0x83,
-	0x68, 0x51, 0xd1, 0xf9, 0xe2, 0xab, 0x62, 0x2a,
-	0x08, 0x95, 0x46, 0x9d, 0x30, 0x37, 0x0a, 0x2f,
-	0x0e, 0x24, 0x1b, 0xdf, 0xcd, 0x4e, 0x7f, 0xea,
-	0x12, 0x1d, 0x58, 0x34, 0x36, 0xdc, 0xb4, 0x5b,
-	0xa4, 0x76, 0xb7, 0x7d, 0x52, 0xdd, 0x5e, 0x13,
-	0xa6, 0xb9, 0x00, 0xc1, 0x40, 0xe3, 0x79, 0xb6,
-	0xd4, 0x8d, 0x67, 0x72, 0x94, 0x98, 0xb0, 0x85,
-	0xbb, 0xc5, 0x4f, 0xed, 0x86, 0x9a, 0x66, 0x11,
-	0x8a, 0xe9, 0x04, 0xfe, 0xa0, 0x78, 0x25, 0x4b,
-	0xa2, 0x5d, 0x80, 0x05, 0x3f, 0x21, 0x70, 0xf1,
-	0x63, 0x77, 0xaf, 0x42, 0x20, 0xe5, 0xfd, 0xbf,
-	0x81, 0x18, 0x26, 0xc3, 0xbe, 0x35, 0x88, 0x2e,
-	0x93, 0x55, 0xfc, 0x7a, 0xc8, 0xba, 0x32, 0xe6,
-	0xc0, 0x19, 0x9e, 0xa3, 0x44, 0x54, 0x3b, 0x0b,
-	0x8c, 0xc7, 0x6b, 0x28, 0xa7, 0xbc, 0x16, 0xad,
-	0xdb, 0x64, 0x74, 0x14, 0x92, 0x0c, 0x48, 0xb8,
-	0x9f, 0xbd, 0x43, 0xc4, 0x39, 0x31, 0xd3, 0xf2,
-	0xd5, 0x8b, 0x6e, 0xda, 0x01, 0xb1, 0x9c, 0x49,
-	0xd8, 0xac, 0xf3, 0xcf, 0xca, 0xf4, 0x47, 0x10,
-	0x6f, 0xf0, 0x4a, 0x5c, 0x38, 0x57, 0x73, 0x97,
-	0xcb, 0xa1, 0xe8, 0x3e, 0x96, 0x61, 0x0d, 0x0f,
-	0xe0, 0x7c, 0x71, 0xcc, 0x90, 0x06, 0xf7, 0x1c,
-	0xc2, 0x6a, 0xae, 0x69, 0x17, 0x99, 0x3a, 0x27,
-	0xd9, 0xeb, 0x2b, 0x22, 0xd2, 0xa9, 0x07, 0x33,
-	0x2d, 0x3c, 0x15, 0xc9, 0x87, 0xaa, 0x50, 0xa5,
-	0x03, 0x59, 0x09, 0x1a, 0x65, 0xd7, 0x84, 0xd0,
-	0x82, 0x29, 0x5a, 0x1e, 0x7b, 0xa8, 0x6d, 0x2c
-};
-
-/* combined Xtimes3[Sbox[]] */
-static const u8 x3_sbox[256] = {
-	0xa5, 0x84, 0x99, 0x8d, 0x0d, 0xbd, 0xb1, 0x54,
-	0x50, 0x03, 0xa9, 0x7d, 0x19, 0x62, 0xe6, 0x9a,
-	0x45, 0x9d, 0x40, 0x87, 0x15, 0xeb, 0xc9, 0x0b,
-	0xec, 0x67, 0xfd, 0xea, 0xbf, 0xf7, 0x96, 0x5b,
-	0xc2, 0x1c, 0xae, 0x6a, 0x5a, 0x41, 0x02, 0x4f,
-	0x5c, 0xf4, 0x34, 0x08, 0x93, 0x73, 0x53, 0x3f,
-	0x0c, 0x52, 0x65, 0x5e, 0x28, 0xa1, 0x0f, 0xb5,
-	0x09, 0x36, 0x9b, 0x3d, 0x26, 0x69, 0xcd, 0x9f,
-	0x1b, 0x9e, 0x74, 0x2e, 0x2d, 0xb2, 0xee, 0xfb,
-	0xf6, 0x4d, 0x61, 0xce, 0x7b, 0x3e, 0x71, 0x97,
-	0xf5, 0x68, 0x00, 0x2c, 0x60, 0x1f, 0xc8, 0xed,
-	0xbe, 0x46, 0xd9, 0x4b, 0xde, 0xd4, 0xe8, 0x4a,
-	0x6b, 0x2a, 0xe5, 0x16, 0xc5, 0xd7, 0x55, 0x94,
-	0xcf, 0x10, 0x06, 0x81, 0xf0, 0x44, 0xba, 0xe3,
-	0xf3, 0xfe, 0xc0, 0x8a, 0xad, 0xbc, 0x48, 0x04,
-	0xdf, 0xc1, 0x75, 0x63, 0x30, 0x1a, 0x0e, 0x6d,
-	0x4c, 0x14, 0x35, 0x2f, 0xe1, 0xa2, 0xcc, 0x39,
-	0x57, 0xf2, 0x82, 0x47, 0xac, 0xe7, 0x2b, 0x95,
-	0xa0, 0x98, 0xd1, 0x7f, 0x66, 0x7e, 0xab, 0x83,
-	0xca, 0x29, 0xd3, 0x3c, 0x79, 0xe2, 0x1d, 0x76,
-	0x3b, 0x56, 0x4e, 0x1e, 0xdb, 0x0a, 0x6c, 0xe4,
-	0x5d, 0x6e, 0xef, 0xa6, 0xa8, 0xa4, 0x37, 0x8b,
-	0x32, 0x43, 0x59, 0xb7, 0x8c, 0x64, 0xd2, 0xe0,
-	0xb4, 0xfa, 0x07, 0x25, 0xaf, 0x8e, 0xe9, 0x18,
-	0xd5, 0x88, 0x6f, 0x72, 0x24, 0xf1, 0xc7, 0x51,
-	0x23, 0x7c, 0x9c, 0x21, 0xdd, 0xdc, 0x86, 0x85,
-	0x90, 0x42, 0xc4, 0xaa, 0xd8, 0x05, 0x01, 0x12,
-	0xa3, 0x5f, 0xf9, 0xd0, 0x91, 0x58, 0x27, 0xb9,
-	0x38, 0x13, 0xb3, 0x33, 0xbb, 0x70, 0x89, 0xa7,
-	0xb6, 0x22, 0x92, 0x20, 0x49, 0xff, 0x78, 0x7a,
-	0x8f, 0xf8, 0x80, 0x17, 0xda, 0x31, 0xc6, 0xb8,
-	0xc3, 0xb0, 0x77, 0x11, 0xcb, 0xfc, 0xd6, 0x3a
-};
-
 /*
- * modular multiplication tables based on:
- *
- * Xtime2[x] = (x & 0x80 ? 0x1b : 0) ^ (x + x)
- * Xtime3[x] = x^Xtime2[x];
+ * The rounds work on the state as four big-endian 32-bit columns. A lookup
+ * in te0 does SubBytes and MixColumns for one byte of a column at once, and
+ * a lookup in td0 does InvSubBytes and InvMixColumns; the tables for the
+ * other three rows are the same words rotated, so only one is stored for
+ * each direction.
  */
-static const u8 x_time_9[256] = {
-	0x00, 0x09, 0x12, 0x1b, 0x24, 0x2d, 0x36, 0x3f,
-	0x48, 0x41, 0x5a, 0x53, 0x6c, 0x65, 0x7e, 0x77,
-	0x90, 0x99, 0x82, 0x8b, 0xb4, 0xbd, 0xa6, 0xaf,
-	0xd8, 0xd1, 0xca, 0xc3, 0xfc, 0xf5, 0xee, 0xe7,
-	0x3b, 0x32, 0x29, 0x20, 0x1f, 0x16, 0x0d, 0x04,
-	0x73, 0x7a, 0x61, 0x68, 0x57, 0x5e, 0x45, 0x4c,
-	0xab, 0xa2, 0xb9, 0xb0, 0x8f, 0x86, 0x9d, 0x94,
-	0xe3, 0xea, 0xf1, 0xf8, 0xc7, 0xce, 0xd5, 0xdc,
-	0x76, 0x7f, 0x64, 0x6d, 0x52, 0x5b, 0x40, 0x49,
-	0x3e, 0x37, 0x2c, 0x25, 0x1a, 0x13, 0x08, 0x01,
-	0xe6, 0xef, 0xf4, 0xfd, 0xc2, 0xcb, 0xd0, 0xd9,
-	0xae, 0xa7, 0xbc, 0xb5, 0x8a, 0x83, 0x98, 0x91,
-	0x4d, 0x44, 0x5f, 0x56, 0x69, 0x60, 0x7b, 0x72,
-	0x05, 0x0c, 0x17, 0x1e, 0x21, 0x28, 0x33, 0x3a,
-	0xdd, 0xd4, 0xcf, 0xc6, 0xf9, 0xf0, 0xeb, 0xe2,
-	0x95, 0x9c, 0x87, 0x8e, 0xb1, 0xb8, 0xa3, 0xaa,
-	0xec, 0xe5, 0xfe, 0xf7, 0xc8, 0xc1, 0xda, 0xd3,
-	0xa4, 0xad, 0xb6, 0xbf, 0x80, 0x89, 0x92, 0x9b,
-	0x7c, 0x75, 0x6e, 0x67, 0x58, 0x51, 0x4a, 0x43,
-	0x34, 0x3d, 0x26, 0x2f, 0x10, 0x19, 0x02, 0x0b,
-	0xd7, 0xde, 0xc5, 0xcc, 0xf3, 0xfa, 0xe1, 0xe8,
-	0x9f, 0x96, 0x8d, 0x84, 0xbb, 0xb2, 0xa9, 0xa0,
-	0x47, 0x4e, 0x55, 0x5c, 0x63, 0x6a, 0x71, 0x78,
-	0x0f, 0x06, 0x1d, 0x14, 0x2b, 0x22, 0x39, 0x30,
-	0x9a, 0x93, 0x88, 0x81, 0xbe, 0xb7, 0xac, 0xa5,
-	0xd2, 0xdb, 0xc0, 0xc9, 0xf6, 0xff, 0xe4, 0xed,
-	0x0a, 0x03, 0x18, 0x11, 0x2e, 0x27, 0x3c, 0x35,
-	0x42, 0x4b, 0x50, 0x59, 0x66, 0x6f, 0x74, 0x7d,
-	0xa1, 0xa8, 0xb3, 0xba, 0x85, 0x8c, 0x97, 0x9e,
-	0xe9, 0xe0, 0xfb, 0xf2, 0xcd, 0xc4, 0xdf, 0xd6,
-	0x31, 0x38, 0x23, 0x2a, 0x15, 0x1c, 0x07, 0x0e,
-	0x79, 0x70, 0x6b, 0x62, 0x5d, 0x54, 0x4f, 0x46
+/* S-box combined with MixColumns: column (02, 01, 01, 03) * S[x] */
+static const u32 te0[256] = {
+	0xc66363a5, 0xf87c7c84, 0xee777799, 0xf67b7b8d,
+	0xfff2f20d, 0xd66b6bbd, 0xde6f6fb1, 0x91c5c554,
+	0x60303050, 0x02010103, 0xce6767a9, 0x562b2b7d,
+	0xe7fefe19, 0xb5d7d762, 0x4dababe6, 0xec76769a,
+	0x8fcaca45, 0x1f82829d, 0x89c9c940, 0xfa7d7d87,
+	0xeffafa15, 0xb25959eb, 0x8e4747c9, 0xfbf0f00b,
+	0x41adadec, 0xb3d4d467, 0x5fa2a2fd, 0x45afafea,
+	0x239c9cbf, 0x53a4a4f7, 0xe4727296, 0x9bc0c05b,
+	0x75b7b7c2, 0xe1fdfd1c, 0x3d9393ae, 0x4c26266a,
+	0x6c36365a, 0x7e3f3f41, 0xf5f7f702, 0x83cccc4f,
+	0x6834345c, 0x51a5a5f4, 0xd1e5e534, 0xf9f1f108,
+	0xe2717193, 0xabd8d873, 0x62313153, 0x2a15153f,
+	0x0804040c, 0x95c7c752, 0x46232365, 0x9dc3c35e,
+	0x30181828, 0x379696a1, 0x0a05050f, 0x2f9a9ab5,
+	0x0e070709, 0x24121236, 0x1b80809b, 0xdfe2e23d,
+	0xcdebeb26, 0x4e272769, 0x7fb2b2cd, 0xea75759f,
+	0x1209091b, 0x1d83839e, 0x582c2c74, 0x341a1a2e,
+	0x361b1b2d, 0xdc6e6eb2, 0xb45a5aee, 0x5ba0a0fb,
+	0xa45252f6, 0x763b3b4d, 0xb7d6d661, 0x7db3b3ce,
+	0x5229297b, 0xdde3e33e, 0x5e2f2f71, 0x13848497,
+	0xa65353f5, 0xb9d1d168, 0x00000000, 0xc1eded2c,
+	0x40202060, 0xe3fcfc1f, 0x79b1b1c8, 0xb65b5bed,
+	0xd46a6abe, 0x8dcbcb46, 0x67bebed9, 0x7239394b,
+	0x944a4ade, 0x984c4cd4, 0xb05858e8, 0x85cfcf4a,
+	0xbbd0d06b, 0xc5efef2a, 0x4faaaae5, 0xedfbfb16,
+	0x864343c5, 0x9a4d4dd7, 0x66333355, 0x11858594,
+	0x8a4545cf, 0xe9f9f910, 0x04020206, 0xfe7f7f81,
+	0xa05050f0, 0x783c3c44, 0x259f9fba, 0x4ba8a8e3,
+	0xa25151f3, 0x5da3a3fe, 0x804040c0, 0x058f8f8a,
+	0x3f9292ad, 0x219d9dbc, 0x70383848, 0xf1f5f504,
+	0x63bcbcdf, 0x77b6b6c1, 0xafdada75, 0x42212163,
+	0x20101030, 0xe5ffff1a, 0xfdf3f30e, 0xbfd2d26d,
+	0x81cdcd4c, 0x180c0c14, 0x26131335, 0xc3ecec2f,
+	0xbe5f5fe1, 0x359797a2, 0x884444cc, 0x2e171739,
+	0x93c4c457, 0x55a7a7f2, 0xfc7e7e82, 0x7a3d3d47,
+	0xc86464ac, 0xba5d5de7, 0x3219192b, 0xe6737395,
+	0xc06060a0, 0x19818198, 0x9e4f4fd1, 0xa3dcdc7f,
+	0x44222266, 0x542a2a7e, 0x3b9090ab, 0x0b888883,
+	0x8c4646ca, 0xc7eeee29, 0x6bb8b8d3, 0x2814143c,
+	0xa7dede79, 0xbc5e5ee2, 0x160b0b1d, 0xaddbdb76,
+	0xdbe0e03b, 0x64323256, 0x743a3a4e, 0x140a0a1e,
+	0x924949db, 0x0c06060a, 0x4824246c, 0xb85c5ce4,
+	0x9fc2c25d, 0xbdd3d36e, 0x43acacef, 0xc46262a6,
+	0x399191a8, 0x319595a4, 0xd3e4e437, 0xf279798b,
+	0xd5e7e732, 0x8bc8c843, 0x6e373759, 0xda6d6db7,
+	0x018d8d8c, 0xb1d5d564, 0x9c4e4ed2, 0x49a9a9e0,
+	0xd86c6cb4, 0xac5656fa, 0xf3f4f407, 0xcfeaea25,
+	0xca6565af, 0xf47a7a8e, 0x47aeaee9, 0x10080818,
+	0x6fbabad5, 0xf0787888, 0x4a25256f, 0x5c2e2e72,
+	0x381c1c24, 0x57a6a6f1, 0x73b4b4c7, 0x97c6c651,
+	0xcbe8e823, 0xa1dddd7c, 0xe874749c, 0x3e1f1f21,
+	0x964b4bdd, 0x61bdbddc, 0x0d8b8b86, 0x0f8a8a85,
+	0xe0707090, 0x7c3e3e42, 0x71b5b5c4, 0xcc6666aa,
+	0x904848d8, 0x06030305, 0xf7f6f601, 0x1c0e0e12,
+	0xc26161a3, 0x6a35355f, 0xae5757f9, 0x69b9b9d0,
+	0x17868691, 0x99c1c158, 0x3a1d1d27, 0x279e9eb9,
+	0xd9e1e138, 0xebf8f813, 0x2b9898b3, 0x22111133,
+	0xd26969bb, 0xa9d9d970, 0x078e8e89, 0x339494a7,
+	0x2d9b9bb6, 0x3c1e1e22, 0x15878792, 0xc9e9e920,
+	0x87cece49, 0xaa5555ff, 0x50282878, 0xa5dfdf7a,
+	0x038c8c8f, 0x59a1a1f8, 0x09898980, 0x1a0d0d17,
+	0x65bfbfda, 0xd7e6e631, 0x844242c6, 0xd06868b8,
+	0x824141c3, 0x299999b0, 0x5a2d2d77, 0x1e0f0f11,
+	0x7bb0b0cb, 0xa85454fc, 0x6dbbbbd6, 0x2c16163a
 };
 
-static const u8 x_time_b[256] = {
-	0x00, 0x0b, 0x16, 0x1d, 0x2c, 0x27, 0x3a, 0x31,
-	0x58, 0x53, 0x4e, 0x45, 0x74, 0x7f, 0x62, 0x69,
-	0xb0, 0xbb, 0xa6, 0xad, 0x9c, 0x97, 0x8a, 0x81,
-	0xe8, 0xe3, 0xfe, 0xf5, 0xc4, 0xcf, 0xd2, 0xd9,
-	0x7b, 0x70, 0x6d, 0x66, 0x57, 0x5c, 0x41, 0x4a,
-	0x23, 0x28, 0x35, 0x3e, 0x0f, 0x04, 0x19, 0x12,
-	0xcb, 0xc0, 0xdd, 0xd6, 0xe7, 0xec, 0xf1, 0xfa,
-	0x93, 0x98, 0x85, 0x8e, 0xbf, 0xb4, 0xa9, 0xa2,
-	0xf6, 0xfd, 0xe0, 0xeb, 0xda, 0xd1, 0xcc, 0xc7,
-	0xae, 0xa5, 0xb8, 0xb3, 0x82, 0x89, 0x94, 0x9f,
-	0x46, 0x4d, 0x50, 0x5b, 0x6a, 0x61, 0x7c, 0x77,
-	0x1e, 0x15, 0x08, 0x03, 0x32, 0x39, 0x24, 0x2f,
-	0x8d, 0x86, 0x9b, 0x90, 0xa1, 0xaa, 0xb7, 0xbc,
-	0xd5, 0xde, 0xc3, 0xc8, 0xf9, 0xf2, 0xef, 0xe4,
-	0x3d, 0x36, 0x2b, 0x20, 0x11, 0x1a, 0x07, 0x0c,
-	0x65, 0x6e, 0x73, 0x78, 0x49, 0x42, 0x5f, 0x54,
-	0xf7, 0xfc, 0xe1, 0xea, 0xdb, 0xd0, 0xcd, 0xc6,
-	0xaf, 0xa4, 0xb9, 0xb2, 0x83, 0x88, 0x95, 0x9e,
-	0x47, 0x4c, 0x51, 0x5a, 0x6b, 0x60, 0x7d, 0x76,
-	0x1f, 0x14, 0x09, 0x02, 0x33, 0x38, 0x25, 0x2e,
-	0x8c, 0x87, 0x9a, 0x91, 0xa0, 0xab, 0xb6, 0xbd,
-	0xd4, 0xdf, 0xc2, 0xc9, 0xf8, 0xf3, 0xee, 0xe5,
-	0x3c, 0x37, 0x2a, 0x21, 0x10, 0x1b, 0x06, 0x0d,
-	0x64, 0x6f, 0x72, 0x79, 0x48, 0x43, 0x5e, 0x55,
-	0x01, 0x0a, 0x17, 0x1c, 0x2d, 0x26, 0x3b, 0x30,
-	0x59, 0x52, 0x4f, 0x44, 0x75, 0x7e, 0x63, 0x68,
-	0xb1, 0xba, 0xa7, 0xac, 0x9d, 0x96, 0x8b, 0x80,
-	0xe9, 0xe2, 0xff, 0xf4, 0xc5, 0xce, 0xd3, 0xd8,
-	0x7a, 0x71, 0x6c, 0x67, 0x56, 0x5d, 0x40, 0x4b,
-	0x22, 0x29, 0x34, 0x3f, 0x0e, 0x05, 0x18, 0x13,
-	0xca, 0xc1, 0xdc, 0xd7, 0xe6, 0xed, 0xf0, 0xfb,
-	0x92, 0x99, 0x84, 0x8f, 0xbe, 0xb5, 0xa8, 0xa3
+/* inverse S-box combined with InvMixColumns: (0e, 09, 0d, 0b) * Si[x] */
+static const u32 td0[256] = {
+	0x51f4a750, 0x7e416553, 0x1a17a4c3, 0x3a275e96,
+	0x3bab6bcb, 0x1f9d45f1, 0xacfa58ab, 0x4be30393,
+	0x2030fa55, 0xad766df6, 0x88cc7691, 0xf5024c25,
+	0x4fe5d7fc, 0xc52acbd7, 0x26354480, 0xb562a38f,
+	0xdeb15a49, 0x25ba1b67, 0x45ea0e98, 0x5dfec0e1,
+	0xc32f7502, 0x814cf012, 0x8d4697a3, 0x6bd3f9c6,
+	0x038f5fe7, 0x15929c95, 0xbf6d7aeb, 0x955259da,
+	0xd4be832d, 0x587421d3, 0x49e06929, 0x8ec9c844,
+	0x75c2896a, 0xf48e7978, 0x99583e6b, 0x27b971dd,
+	0xbee14fb6, 0xf088ad17, 0xc920ac66, 0x7dce3ab4,
+	0x63df4a18, 0xe51a3182, 0x97513360, 0x62537f45,
+	0xb16477e0, 0xbb6bae84, 0xfe81a01c, 0xf9082b94,
+	0x70486858, 0x8f45fd19, 0x94de6c87, 0x527bf8b7,
+	0xab73d323, 0x724b02e2, 0xe31f8f57, 0x6655ab2a,
+	0xb2eb2807, 0x2fb5c203, 0x86c57b9a, 0xd33708a5,
+	0x302887f2, 0x23bfa5b2, 0x02036aba, 0xed16825c,
+	0x8acf1c2b, 0xa779b492, 0xf307f2f0, 0x4e69e2a1,
+	0x65daf4cd, 0x0605bed5, 0xd134621f, 0xc4a6fe8a,
+	0x342e539d, 0xa2f355a0, 0x058ae132, 0xa4f6eb75,
+	0x0b83ec39, 0x4060efaa, 0x5e719f06, 0xbd6e1051,
+	0x3e218af9, 0x96dd063d, 0xdd3e05ae, 0x4de6bd46,
+	0x91548db5, 0x71c45d05, 0x0406d46f, 0x605015ff,
+	0x1998fb24, 0xd6bde997, 0x894043cc, 0x67d99e77,
+	0xb0e842bd, 0x07898b88, 0xe7195b38, 0x79c8eedb,
+	0xa17c0a47, 0x7c420fe9, 0xf8841ec9, 0x00000000,
+	0x09808683, 0x322bed48, 0x1e1170ac, 0x6c5a724e,
+	0xfd0efffb, 0x0f853856, 0x3daed51e, 0x362d3927,
+	0x0a0fd964, 0x685ca621, 0x9b5b54d1, 0x24362e3a,
+	0x0c0a67b1, 0x9357e70f, 0xb4ee96d2, 0x1b9b919e,
+	0x80c0c54f, 0x61dc20a2, 0x5a774b69, 0x1c121a16,
+	0xe293ba0a, 0xc0a02ae5, 0x3c22e043, 0x121b171d,
+	0x0e090d0b, 0xf28bc7ad, 0x2db6a8b9, 0x141ea9c8,
+	0x57f11985, 0xaf75074c, 0xee99ddbb, 0xa37f60fd,
+	0xf701269f, 0x5c72f5bc, 0x44663bc5, 0x5bfb7e34,
+	0x8b432976, 0xcb23c6dc, 0xb6edfc68, 0xb8e4f163,
+	0xd731dcca, 0x42638510, 0x13972240, 0x84c61120,
+	0x854a247d, 0xd2bb3df8, 0xaef93211, 0xc729a16d,
+	0x1d9e2f4b, 0xdcb230f3, 0x0d8652ec, 0x77c1e3d0,
+	0x2bb3166c, 0xa970b999, 0x119448fa, 0x47e96422,
+	0xa8fc8cc4, 0xa0f03f1a, 0x567d2cd8, 0x223390ef,
+	0x87494ec7, 0xd938d1c1, 0x8ccaa2fe, 0x98d40b36,
+	0xa6f581cf, 0xa57ade28, 0xdab78e26, 0x3fadbfa4,
+	0x2c3a9de4, 0x5078920d, 0x6a5fcc9b, 0x547e4662,
+	0xf68d13c2, 0x90d8b8e8, 0x2e39f75e, 0x82c3aff5,
+	0x9f5d80be, 0x69d0937c, 0x6fd52da9, 0xcf2512b3,
+	0xc8ac993b, 0x10187da7, 0xe89c636e, 0xdb3bbb7b,
+	0xcd267809, 0x6e5918f4, 0xec9ab701, 0x834f9aa8,
+	0xe6956e65, 0xaaffe67e, 0x21bccf08, 0xef15e8e6,
+	0xbae79bd9, 0x4a6f36ce, 0xea9f09d4, 0x29b07cd6,
+	0x31a4b2af, 0x2a3f2331, 0xc6a59430, 0x35a266c0,
+	0x744ebc37, 0xfc82caa6, 0xe090d0b0, 0x33a7d815,
+	0xf104984a, 0x41ecdaf7, 0x7fcd500e, 0x1791f62f,
+	0x764dd68d, 0x43efb04d, 0xccaa4d54, 0xe49604df,
+	0x9ed1b5e3, 0x4c6a881b, 0xc12c1fb8, 0x4665517f,
+	0x9d5eea04, 0x018c355d, 0xfa877473, 0xfb0b412e,
+	0xb3671d5a, 0x92dbd252, 0xe9105633, 0x6dd64713,
+	0x9ad7618c, 0x37a10c7a, 0x59f8148e, 0xeb133c89,
+	0xcea927ee, 0xb761c935, 0xe11ce5ed, 0x7a47b13c,
+	0x9cd2df59, 0x55f2733f, 0x1814ce79, 0x73c737bf,
+	0x53f7cdea, 0x5ffdaa5b, 0xdf3d6f14, 0x7844db86,
+	0xcaaff381, 0xb968c43e, 0x3824342c, 0xc2a3405f,
+	0x161dc372, 0xbce2250c, 0x283c498b, 0xff0d9541,
+	0x39a80171, 0x080cb3de, 0xd8b4e49c, 0x6456c190,
+	0x7bcb8461, 0xd532b670, 0x486c5c74, 0xd0b85742
 };
 
-static const u8 x_time_d[256] = {
-	0x00, 0x0d, 0x1a, 0x17, 0x34, 0x39, 0x2e, 0x23,
-	0x68, 0x65, 0x72, 0x7f, 0x5c, 0x51, 0x46, 0x4b,
-	0xd0, 0xdd, 0xca, 0xc7, 0xe4, 0xe9, 0xfe, 0xf3,
-	0xb8, 0xb5, 0xa2, 0xaf, 0x8c, 0x81, 0x96, 0x9b,
-	0xbb, 0xb6, 0xa1, 0xac, 0x8f, 0x82, 0x95, 0x98,
-	0xd3, 0xde, 0xc9, 0xc4, 0xe7, 0xea, 0xfd, 0xf0,
-	0x6b, 0x66, 0x71, 0x7c, 0x5f, 0x52, 0x45, 0x48,
-	0x03, 0x0e, 0x19, 0x14, 0x37, 0x3a, 0x2d, 0x20,
-	0x6d, 0x60, 0x77, 0x7a, 0x59, 0x54, 0x43, 0x4e,
-	0x05, 0x08, 0x1f, 0x12, 0x31, 0x3c, 0x2b, 0x26,
-	0xbd, 0xb0, 0xa7, 0xaa, 0x89, 0x84, 0x93, 0x9e,
-	0xd5, 0xd8, 0xcf, 0xc2, 0xe1, 0xec, 0xfb, 0xf6,
-	0xd6, 0xdb, 0xcc, 0xc1, 0xe2, 0xef, 0xf8, 0xf5,
-	0xbe, 0xb3, 0xa4, 0xa9, 0x8a, 0x87, 0x90, 0x9d,
-	0x06, 0x0b, 0x1c, 0x11, 0x32, 0x3f, 0x28, 0x25,
-	0x6e, 0x63, 0x74, 0x79, 0x5a, 0x57, 0x40, 0x4d,
-	0xda, 0xd7, 0xc0, 0xcd, 0xee, 0xe3, 0xf4, 0xf9,
-	0xb2, 0xbf, 0xa8, 0xa5, 0x86, 0x8b, 0x9c, 0x91,
-	0x0a, 0x07, 0x10, 0x1d, 0x3e, 0x33, 0x24, 0x29,
-	0x62, 0x6f, 0x78, 0x75, 0x56, 0x5b, 0x4c, 0x41,
-	0x61, 0x6c, 0x7b, 0x76, 0x55, 0x58, 0x4f, 0x42,
-	0x09, 0x04, 0x13, 0x1e, 0x3d, 0x30, 0x27, 0x2a,
-	0xb1, 0xbc, 0xab, 0xa6, 0x85, 0x88, 0x9f, 0x92,
-	0xd9, 0xd4, 0xc3, 0xce, 0xed, 0xe0, 0xf7, 0xfa,
-	0xb7, 0xba, 0xad, 0xa0, 0x83, 0x8e, 0x99, 0x94,
-	0xdf, 0xd2, 0xc5, 0xc8, 0xeb, 0xe6, 0xf1, 0xfc,
-	0x67, 0x6a, 0x7d, 0x70, 0x53, 0x5e, 0x49, 0x44,
-	0x0f, 0x02, 0x15, 0x18, 0x3b, 0x36, 0x21, 0x2c,
-	0x0c, 0x01, 0x16, 0x1b, 0x38, 0x35, 0x22, 0x2f,
-	0x64, 0x69, 0x7e, 0x73, 0x50, 0x5d, 0x4a, 0x47,
-	0xdc, 0xd1, 0xc6, 0xcb, 0xe8, 0xe5, 0xf2, 0xff,
-	0xb4, 0xb9, 0xae, 0xa3, 0x80, 0x8d, 0x9a, 0x97
-};
-
-static const u8 x_time_e[256] = {
-	0x00, 0x0e, 0x1c, 0x12, 0x38, 0x36, 0x24, 0x2a,
-	0x70, 0x7e, 0x6c, 0x62, 0x48, 0x46, 0x54, 0x5a,
-	0xe0, 0xee, 0xfc, 0xf2, 0xd8, 0xd6, 0xc4, 0xca,
-	0x90, 0x9e, 0x8c, 0x82, 0xa8, 0xa6, 0xb4, 0xba,
-	0xdb, 0xd5, 0xc7, 0xc9, 0xe3, 0xed, 0xff, 0xf1,
-	0xab, 0xa5, 0xb7, 0xb9, 0x93, 0x9d, 0x8f, 0x81,
-	0x3b, 0x35, 0x27, 0x29, 0x03, 0x0d, 0x1f, 0x11,
-	0x4b, 0x45, 0x57, 0x59, 0x73, 0x7d, 0x6f, 0x61,
-	0xad, 0xa3, 0xb1, 0xbf, 0x95, 0x9b, 0x89, 0x87,
-	0xdd, 0xd3, 0xc1, 0xcf, 0xe5, 0xeb, 0xf9, 0xf7,
-	0x4d, 0x43, 0x51, 0x5f, 0x75, 0x7b, 0x69, 0x67,
-	0x3d, 0x33, 0x21, 0x2f, 0x05, 0x0b, 0x19, 0x17,
-	0x76, 0x78, 0x6a, 0x64, 0x4e, 0x40, 0x52, 0x5c,
-	0x06, 0x08, 0x1a, 0x14, 0x3e, 0x30, 0x22, 0x2c,
-	0x96, 0x98, 0x8a, 0x84, 0xae, 0xa0, 0xb2, 0xbc,
-	0xe6, 0xe8, 0xfa, 0xf4, 0xde, 0xd0, 0xc2, 0xcc,
-	0x41, 0x4f, 0x5d, 0x53, 0x79, 0x77, 0x65, 0x6b,
-	0x31, 0x3f, 0x2d, 0x23, 0x09, 0x07, 0x15, 0x1b,
-	0xa1, 0xaf, 0xbd, 0xb3, 0x99, 0x97, 0x85, 0x8b,
-	0xd1, 0xdf, 0xcd, 0xc3, 0xe9, 0xe7, 0xf5, 0xfb,
-	0x9a, 0x94, 0x86, 0x88, 0xa2, 0xac, 0xbe, 0xb0,
-	0xea, 0xe4, 0xf6, 0xf8, 0xd2, 0xdc, 0xce, 0xc0,
-	0x7a, 0x74, 0x66, 0x68, 0x42, 0x4c, 0x5e, 0x50,
-	0x0a, 0x04, 0x16, 0x18, 0x32, 0x3c, 0x2e, 0x20,
-	0xec, 0xe2, 0xf0, 0xfe, 0xd4, 0xda, 0xc8, 0xc6,
-	0x9c, 0x92, 0x80, 0x8e, 0xa4, 0xaa, 0xb8, 0xb6,
-	0x0c, 0x02, 0x10, 0x1e, 0x34, 0x3a, 0x28, 0x26,
-	0x7c, 0x72, 0x60, 0x6e, 0x44, 0x4a, 0x58, 0x56,
-	0x37, 0x39, 0x2b, 0x25, 0x0f, 0x01, 0x13, 0x1d,
-	0x47, 0x49, 0x5b, 0x55, 0x7f, 0x71, 0x63, 0x6d,
-	0xd7, 0xd9, 0xcb, 0xc5, 0xef, 0xe1, 0xf3, 0xfd,
-	0xa7, 0xa9, 0xbb, 0xb5, 0x9f, 0x91, 0x83, 0x8d
-};
+#define AES_GETU32(p)	((u32)(p)[0] << 24 | (u32)(p)[1] << 16 | \
+			 (u32)(p)[2] << 8 | (u32)(p)[3])
 
-/*
- * Exchanges columns in each of 4 rows
- * row0 - unchanged, row1- shifted left 1,
- * row2 - shifted left 2 and row3 - shifted left 3
- */
-static void shift_rows(u8 *state)
+static inline void aes_putu32(u8 *p, u32 val)
 {
-	u8 tmp;
-
-	/* just substitute row 0 */
-	state[0] = sbox[state[0]];
-	state[4] = sbox[state[4]];
-	state[8] = sbox[state[8]];
-	state[12] = sbox[state[12]];
-
-	/* rotate row 1 */
-	tmp = sbox[state[1]];
-	state[1] = sbox[state[5]];
-	state[5] = sbox[state[9]];
-	state[9] = sbox[state[13]];
-	state[13] = tmp;
-
-	/* rotate row 2 */
-	tmp = sbox[state[2]];
-	state[2] = sbox[state[10]];
-	state[10] = tmp;
-	tmp = sbox[state[6]];
-	state[6] = sbox[state[14]];
-	state[14] = tmp;
-
-	/* rotate row 3 */
-	tmp = sbox[state[15]];
-	state[15] = sbox[state[11]];
-	state[11] = sbox[state[7]];
-	state[7] = sbox[state[3]];
-	state[3] = tmp;
+	p[0] = val >> 24;
+	p[1] = val >> 16;
+	p[2] = val >> 8;
+	p[3] = val;
 }
 
-/*
- * restores columns in each of 4 rows
- * row0 - unchanged, row1- shifted right 1,
- * row2 - shifted right 2 and row3 - shifted right 3
- */
-static void inv_shift_rows(u8 *state)
+static inline u32 aes_ror32(u32 val, int shift)
 {
-	u8 tmp;
-
-	/* restore row 0 */
-	state[0] = inv_sbox[state[0]];
-	state[4] = inv_sbox[state[4]];
-	state[8] = inv_sbox[state[8]];
-	state[12] = inv_sbox[state[12]];
-
-	/* restore row 1 */
-	tmp = inv_sbox[state[13]];
-	state[13] = inv_sbox[state[9]];
-	state[9] = inv_sbox[state[5]];
-	state[5] = inv_sbox[state[1]];
-	state[1] = tmp;
-
-	/* restore row 2 */
-	tmp = inv_sbox[state[2]];
-	state[2] = inv_sbox[state[10]];
-	state[10] = tmp;
-	tmp = inv_sbox[state[6]];
-	state[6] = inv_sbox[state[14]];
-	state[14] = tmp;
-
-	/* restore row 3 */
-	tmp = inv_sbox[state[3]];
-	state[3] = inv_sbox[state[7]];
-	state[7] = inv_sbox[state[11]];
-	state[11] = inv_sbox[state[15]];
-	state[15] = tmp;
+	return val >> shift | val << (32 - shift);
 }
 
-/* recombine and mix each row in a column */
-static void mix_sub_columns(u8 *state)
+/* one output column of a round: a, b, c, d are the source of rows 0 to 3 */
+static inline u32 aes_round_col(const u32 *tab, u32 a, u32 b, u32 c, u32 d)
 {
-	u8 tmp[4 * AES_STATECOLS];
-
-	/* mixing column 0 */
-	tmp[0] = x2_sbox[state[0]] ^ x3_sbox[state[5]] ^
-		 sbox[state[10]] ^ sbox[state[15]];
-	tmp[1] = sbox[state[0]] ^ x2_sbox[state[5]] ^
-		 x3_sbox[state[10]] ^ sbox[state[15]];
-	tmp[2] = sbox[state[0]] ^ sbox[state[5]] ^
-		 x2_sbox[state[10]] ^ x3_sbox[state[15]];
-	tmp[3] = x3_sbox[state[0]] ^ sbox[state[5]] ^
-		 sbox[state[10]] ^ x2_sbox[state[15]];
-
-	/* mixing column 1 */
-	tmp[4] = x2_sbox[state[4]] ^ x3_sbox[state[9]] ^
-		 sbox[state[14]] ^ sbox[state[3]];
-	tmp[5] = sbox[state[4]] ^ x2_sbox[state[9]] ^
-		 x3_sbox[state[14]] ^ sbox[state[3]];
-	tmp[6] = sbox[state[4]] ^ sbox[state[9]] ^
-		 x2_sbox[state[14]] ^ x3_sbox[state[3]];
-	tmp[7] = x3_sbox[state[4]] ^ sbox[state[9]] ^
-		 sbox[state[14]] ^ x2_sbox[state[3]];
-
-	/* mixing column 2 */
-	tmp[8] = x2_sbox[state[8]] ^ x3_sbox[state[13]] ^
-		 sbox[state[2]] ^ sbox[state[7]];
-	tmp[9] = sbox[state[8]] ^ x2_sbox[state[13]] ^
-		 x3_sbox[state[2]] ^ sbox[state[7]];
-	tmp[10] = sbox[state[8]] ^ sbox[state[13]] ^
-		  x2_sbox[state[2]] ^ x3_sbox[state[7]];
-	tmp[11] = x3_sbox[state[8]] ^ sbox[state[13]] ^
-		  sbox[state[2]] ^ x2_sbox[state[7]];
-
-	/* mixing column 3 */
-	tmp[12] = x2_sbox[state[12]] ^ x3_sbox[state[1]] ^
-		  sbox[state[6]] ^ sbox[state[11]];
-	tmp[13] = sbox[state[12]] ^ x2_sbox[state[1]] ^
-		  x3_sbox[state[6]] ^ sbox[state[11]];
-	tmp[14] = sbox[state[12]] ^ sbox[state[1]] ^
-		  x2_sbox[state[6]] ^ x3_sbox[state[11]];
-	tmp[15] = x3_sbox[state[12]] ^ sbox[state[1]] ^
-		  sbox[state[6]] ^ x2_sbox[state[11]];
-
-	memcpy(state, tmp, sizeof(tmp));
+	return tab[a >> 24] ^ aes_ror32(tab[(b >> 16) & 0xff], 8) ^
+	       aes_ror32(tab[(c >> 8) & 0xff], 16) ^
+	       aes_ror32(tab[d & 0xff], 24);
 }
 
-/* restore and un-mix each row in a column */
-static void inv_mix_sub_columns(u8 *state)
+/* the last round has no MixColumns, so uses the plain s-box */
+static inline u32 aes_final_col(const u8 *box, u32 a, u32 b, u32 c, u32 d)
 {
-	u8 tmp[4 * AES_STATECOLS];
-	int  i;
-
-	/* restore column 0 */
-	tmp[0] = x_time_e[state[0]] ^ x_time_b[state[1]] ^
-		 x_time_d[state[2]] ^ x_time_9[state[3]];
-	tmp[5] = x_time_9[state[0]] ^ x_time_e[state[1]] ^
-		 x_time_b[state[2]] ^ x_time_d[state[3]];
-	tmp[10] = x_time_d[state[0]] ^ x_time_9[state[1]] ^
-		  x_time_e[state[2]] ^ x_time_b[state[3]];
-	tmp[15] = x_time_b[state[0]] ^ x_time_d[state[1]] ^
-		  x_time_9[state[2]] ^ x_time_e[state[3]];
-
-	/* restore column 1 */
-	tmp[4] = x_time_e[state[4]] ^ x_time_b[state[5]] ^
-		 x_time_d[state[6]] ^ x_time_9[state[7]];
-	tmp[9] = x_time_9[state[4]] ^ x_time_e[state[5]] ^
-		 x_time_b[state[6]] ^ x_time_d[state[7]];
-	tmp[14] = x_time_d[state[4]] ^ x_time_9[state[5]] ^
-		  x_time_e[state[6]] ^ x_time_b[state[7]];
-	tmp[3] = x_time_b[state[4]] ^ x_time_d[state[5]] ^
-		 x_time_9[state[6]] ^ x_time_e[state[7]];
-
-	/* restore column 2 */
-	tmp[8] = x_time_e[state[8]] ^ x_time_b[state[9]] ^
-		 x_time_d[state[10]] ^ x_time_9[state[11]];
-	tmp[13] = x_time_9[state[8]] ^ x_time_e[state[9]] ^
-		  x_time_b[state[10]] ^ x_time_d[state[11]];
-	tmp[2] = x_time_d[state[8]] ^ x_time_9[state[9]] ^
-		 x_time_e[state[10]] ^ x_time_b[state[11]];
-	tmp[7] = x_time_b[state[8]] ^ x_time_d[state[9]] ^
-		 x_time_9[state[10]] ^ x_time_e[state[11]];
-
-	/* restore column 3 */
-	tmp[12] = x_time_e[state[12]] ^ x_time_b[state[13]] ^
-		  x_time_d[state[14]] ^ x_time_9[state[15]];
-	tmp[1] = x_time_9[state[12]] ^ x_time_e[state[13]] ^
-		 x_time_b[state[14]] ^ x_time_d[state[15]];
-	tmp[6] = x_time_d[state[12]] ^ x_time_9[state[13]] ^
-		 x_time_e[state[14]] ^ x_time_b[state[15]];
-	tmp[11] = x_time_b[state[12]] ^ x_time_d[state[13]] ^
-		  x_time_9[state[14]] ^ x_time_e[state[15]];
-
-	for (i = 0; i < 4 * AES_STATECOLS; i++)
-		state[i] = inv_sbox[tmp[i]];
-}
-
-/*
- * encrypt/decrypt columns of the key
- * n.b. you can replace this with byte-wise xor if you wish.
- */
-static void add_round_key(u32 *state, u32 *key)
-{
-	int idx;
-
-	for (idx = 0; idx < 4; idx++)
-		state[idx] ^= key[idx];
+	return (u32)box[a >> 24] << 24 | (u32)box[(b >> 16) & 0xff] << 16 |
+	       (u32)box[(c >> 8) & 0xff] << 8 | box[d & 0xff];
 }
 
 static u8 rcon[11] = {
 	0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36
 };
 
-static u32 aes_get_rounds(u32 key_len)
+u32 aes_get_rounds(u32 key_len)
 {
 	u32 rounds = AES128_ROUNDS;
 
@@ -570,51 +342,118 @@ void aes_expand_key(u8 *key, u32 key_len, u8 *expkey)
 	}
 }
 
-/* encrypt one 128 bit block */
-void aes_encrypt(u32 key_len, u8 *in, u8 *expkey, u8 *out)
+/* load the expanded key as columns, for encryption */
+static void aes_enc_key(u32 *rk, const u8 *expkey, u32 rounds)
 {
-	u8 state[AES_STATECOLS * 4];
-	u32 round, aes_rounds;
-
-	aes_rounds = aes_get_rounds(key_len);
+	u32 i;
 
-	memcpy(state, in, AES_STATECOLS * 4);
-	add_round_key((u32 *)state, (u32 *)expkey);
+	for (i = 0; i < AES_STATECOLS * (rounds + 1); i++)
+		rk[i] = AES_GETU32(expkey + 4 * i);
+}
 
-	for (round = 1; round < aes_rounds + 1; round++) {
-		if (round < aes_rounds)
-			mix_sub_columns(state);
-		else
-			shift_rows(state);
+/*
+ * Set up the key for the equivalent inverse cipher: the round keys in
+ * reverse order, with InvMixColumns applied to all but the first and last
+ */
+static void aes_dec_key(u32 *rk, const u8 *expkey, u32 rounds)
+{
+	const u8 *key;
+	u32 round, i, w;
+
+	for (round = 0; round <= rounds; round++) {
+		key = expkey + (rounds - round) * AES_STATECOLS * 4;
+		for (i = 0; i < AES_STATECOLS; i++) {
+			w = AES_GETU32(key + 4 * i);
+			if (round && round < rounds)
+				w = td0[sbox[w >> 24]] ^
+				    aes_ror32(td0[sbox[(w >> 16) & 0xff]], 8) ^
+				    aes_ror32(td0[sbox[(w >> 8) & 0xff]], 16) ^
+				    aes_ror32(td0[sbox[w & 0xff]], 24);
+			*rk++ = w;
+		}
+	}
+}
 
-		add_round_key((u32 *)state,
-			      (u32 *)expkey + round * AES_STATECOLS);
+static void aes_encrypt_block(const u32 *rk, u32 rounds, const u8 *in,
+			      u8 *out)
+{
+	u32 s0, s1, s2, s3, t0, t1, t2, t3;
+	u32 round;
+
+	s0 = AES_GETU32(in) ^ rk[0];
+	s1 = AES_GETU32(in + 4) ^ rk[1];
+	s2 = AES_GETU32(in + 8) ^ rk[2];
+	s3 = AES_GETU32(in + 12) ^ rk[3];
+
+	for (round = 1; round < rounds; round++) {
+		rk += AES_STATECOLS;
+		t0 = aes_round_col(te0, s0, s1, s2, s3) ^ rk[0];
+		t1 = aes_round_col(te0, s1, s2, s3, s0) ^ rk[1];
+		t2 = aes_round_col(te0, s2, s3, s0, s1) ^ rk[2];
+		t3 = aes_round_col(te0, s3, s0, s1, s2) ^ rk[3];
+		s0 = t0;
+		s1 = t1;
+		s2 = t2;
+		s3 = t3;
 	}
 
-	memcpy(out, state, sizeof(state));
+	rk += AES_STATECOLS;
+	aes_putu32(out, aes_final_col(sbox, s0, s1, s2, s3) ^ rk[0]);
+	aes_putu32(out + 4, aes_final_col(sbox, s1, s2, s3, s0) ^ rk[1]);
+	aes_putu32(out + 8, aes_final_col(sbox, s2, s3, s0, s1) ^ rk[2]);
+	aes_putu32(out + 12, aes_final_col(sbox, s3, s0, s1, s2) ^ rk[3]);
 }
 
-void aes_decrypt(u32 key_len, u8 *in, u8 *expkey, u8 *out)
+/* rk is the key from aes_dec_key() */
+static void aes_decrypt_block(const u32 *rk, u32 rounds, const u8 *in,
+			      u8 *out)
 {
-	u8 state[AES_STATECOLS * 4];
-	int round, aes_rounds;
+	u32 s0, s1, s2, s3, t0, t1, t2, t3;
+	u32 round;
+
+	s0 = AES_GETU32(in) ^ rk[0];
+	s1 = AES_GETU32(in + 4) ^ rk[1];
+	s2 = AES_GETU32(in + 8) ^ rk[2];
+	s3 = AES_GETU32(in + 12) ^ rk[3];
+
+	for (round = 1; round < rounds; round++) {
+		rk += AES_STATECOLS;
+		t0 = aes_round_col(td0, s0, s3, s2, s1) ^ rk[0];
+		t1 = aes_round_col(td0, s1, s0, s3, s2) ^ rk[1];
+		t2 = aes_round_col(td0, s2, s1, s0, s3) ^ rk[2];
+		t3 = aes_round_col(td0, s3, s2, s1, s0) ^ rk[3];
+		s0 = t0;
+		s1 = t1;
+		s2 = t2;
+		s3 = t3;
+	}
 
-	aes_rounds = aes_get_rounds(key_len);
+	rk += AES_STATECOLS;
+	aes_putu32(out, aes_final_col(inv_sbox, s0, s3, s2, s1) ^ rk[0]);
+	aes_putu32(out + 4, aes_final_col(inv_sbox, s1, s0, s3, s2) ^ rk[1]);
+	aes_putu32(out + 8, aes_final_col(inv_sbox, s2, s1, s0, s3) ^ rk[2]);
+	aes_putu32(out + 12, aes_final_col(inv_sbox, s3, s2, s1, s0) ^ rk[3]);
+}
 
-	memcpy(state, in, sizeof(state));
+/* encrypt one 128 bit block */
+void aes_encrypt(u32 key_len, u8 *in, u8 *expkey, u8 *out)
+{
+	u32 rk[AES_STATECOLS * (AES256_ROUNDS + 1)];
+	u32 aes_rounds;
 
-	add_round_key((u32 *)state,
-		      (u32 *)expkey + aes_rounds * AES_STATECOLS);
-	inv_shift_rows(state);
+	aes_rounds = aes_get_rounds(key_len);
+	aes_enc_key(rk, expkey, aes_rounds);
+	aes_encrypt_block(rk, aes_rounds, in, out);
+}
 
-	for (round = aes_rounds; round--; ) {
-		add_round_key((u32 *)state,
-			      (u32 *)expkey + round * AES_STATECOLS);
-		if (round)
-			inv_mix_sub_columns(state);
-	}
+void aes_decrypt(u32 key_len, u8 *in, u8 *expkey, u8 *out)
+{
+	u32 rk[AES_STATECOLS * (AES256_ROUNDS + 1)];
+	u32 aes_rounds;
 
-	memcpy(out, state, sizeof(state));
+	aes_rounds = aes_get_rounds(key_len);
+	aes_dec_key(rk, expkey, aes_rounds);
+	aes_decrypt_block(rk, aes_rounds, in, out);
 }
 
 static void debug_print_vector(char *name, u32 num_bytes, u8 *data)
@@ -633,12 +472,16 @@ void aes_apply_cbc_chain_data(u8 *cbc_chain_data, u8 *src, u8 *dst)
 		*dst++ = *src++ ^ *cbc_chain_data++;
 }
 
-void aes_cbc_encrypt_blocks(u32 key_len, u8 *key_exp, u8 *iv, u8 *src, u8 *dst,
-			    u32 num_aes_blocks)
+void aes_cbc_encrypt_blocks_generic(u32 key_len, u8 *key_exp, u8 *iv,
+				    u8 *src, u8 *dst, u32 num_aes_blocks)
 {
+	u32 rk[AES_STATECOLS * (AES256_ROUNDS + 1)];
 	u8 tmp_data[AES_BLOCK_LENGTH];
 	u8 *cbc_chain_data = iv;
-	u32 i;
+	u32 i, aes_rounds;
+
+	aes_rounds = aes_get_rounds(key_len);
+	aes_enc_key(rk, key_exp, aes_rounds);
 
 	for (i = 0; i < num_aes_blocks; i++) {
 		debug("encrypt_object: block %d of %d\n", i, num_aes_blocks);
@@ -649,7 +492,7 @@ void aes_cbc_encrypt_blocks(u32 key_len, u8 *key_exp, u8 *iv, u8 *src, u8 *dst,
 		debug_print_vector("AES Xor", AES_BLOCK_LENGTH, tmp_data);
 
 		/* Encrypt the AES block */
-		aes_encrypt(key_len, tmp_data, key_exp, dst);
+		aes_encrypt_block(rk, aes_rounds, tmp_data, dst);
 		debug_print_vector("AES Dst", AES_BLOCK_LENGTH, dst);
 
 		/* Update pointers for next loop. */
@@ -659,13 +502,24 @@ void aes_cbc_encrypt_blocks(u32 key_len, u8 *key_exp, u8 *iv, u8 *src, u8 *dst,
 	}
 }
 
-void aes_cbc_decrypt_blocks(u32 key_len, u8 *key_exp, u8 *iv, u8 *src, u8 *dst,
-			    u32 num_aes_blocks)
+__weak void aes_cbc_encrypt_blocks(u32 key_len, u8 *key_exp, u8 *iv, u8 *src,
+				   u8 *dst, u32 num_aes_blocks)
+{
+	aes_cbc_encrypt_blocks_generic(key_len, key_exp, iv, src, dst,
+				       num_aes_blocks);
+}
+
+void aes_cbc_decrypt_blocks_generic(u32 key_len, u8 *key_exp, u8 *iv,
+				    u8 *src, u8 *dst, u32 num_aes_blocks)
 {
+	u32 rk[AES_STATECOLS * (AES256_ROUNDS + 1)];
 	u8 tmp_data[AES_BLOCK_LENGTH], tmp_block[AES_BLOCK_LENGTH];
 	/* Convenient array of 0's for IV */
 	u8 cbc_chain_data[AES_BLOCK_LENGTH];
-	u32 i;
+	u32 i, aes_rounds;
+
+	aes_rounds = aes_get_rounds(key_len);
+	aes_dec_key(rk, key_exp, aes_rounds);
 
 	memcpy(cbc_chain_data, iv, AES_BLOCK_LENGTH);
 	for (i = 0; i < num_aes_blocks; i++) {
@@ -675,7 +529,7 @@ void aes_cbc_decrypt_blocks(u32 key_len, u8 *key_exp, u8 *iv, u8 *src, u8 *dst,
 		memcpy(tmp_block, src, AES_BLOCK_LENGTH);
 
 		/* Decrypt the AES block */
-		aes_decrypt(key_len, src, key_exp, tmp_data);
+		aes_decrypt_block(rk, aes_rounds, src, tmp_data);
 		debug_print_vector("AES Xor", AES_BLOCK_LENGTH, tmp_data);
 
 		/* Apply the chain data */
@@ -688,3 +542,241 @@ void aes_cbc_decrypt_blocks(u32 key_len, u8 *key_exp, u8 *iv, u8 *src, u8 *dst,
 		dst += AES_BLOCK_LENGTH;
 	}
 }
+
+__weak void aes_cbc_decrypt_blocks(u32 key_len, u8 *key_exp, u8 *iv, u8 *src,
+				   u8 *dst, u32 num_aes_blocks)
+{
+	aes_cbc_decrypt_blocks_generic(key_len, key_exp, iv, src, dst,
+				       num_aes_blocks);
+}
+
+/* add one to a 128-bit big-endian counter */
+static void aes_ctr_inc(u8 *ctr)
+{
+	int i;
+
+	for (i = AES_BLOCK_LENGTH - 1; i >= 0; i--) {
+		if (++ctr[i])
+			break;
+	}
+}
+
+void aes_ctr_blocks_generic(u32 key_len, u8 *key_exp, u8 *ctr, u8 *src,
+			    u8 *dst, u32 num_aes_blocks)
+{
+	u32 rk[AES_STATECOLS * (AES256_ROUNDS + 1)];
+	u8 stream[AES_BLOCK_LENGTH];
+	u32 i, aes_rounds;
+
+	aes_rounds = aes_get_rounds(key_len);
+	aes_enc_key(rk, key_exp, aes_rounds);
+
+	for (i = 0; i < num_aes_blocks; i++) {
+		aes_encrypt_block(rk, aes_rounds, ctr, stream);
+		aes_apply_cbc_chain_data(stream, src, dst);
+		aes_ctr_inc(ctr);
+		src += AES_BLOCK_LENGTH;
+		dst += AES_BLOCK_LENGTH;
+	}
+}
+
+__weak void aes_ctr_blocks(u32 key_len, u8 *key_exp, u8 *ctr, u8 *src,
+			   u8 *dst, u32 num_aes_blocks)
+{
+	aes_ctr_blocks_generic(key_len, key_exp, ctr, src, dst, num_aes_blocks);
+}
+
+void aes_ctr_crypt(u32 key_len, u8 *key_exp, u8 *ctr, u8 *src, u8 *dst,
+		   u32 len)
+{
+	u32 num_aes_blocks = len / AES_BLOCK_LENGTH;
+	u8 stream[AES_BLOCK_LENGTH];
+	u32 i;
+
+	aes_ctr_blocks(key_len, key_exp, ctr, src, dst, num_aes_blocks);
+
+	len %= AES_BLOCK_LENGTH;
+	if (!len)
+		return;
+
+	src += num_aes_blocks * AES_BLOCK_LENGTH;
+	dst += num_aes_blocks * AES_BLOCK_LENGTH;
+	aes_encrypt(key_len, ctr, key_exp, stream);
+	for (i = 0; i < len; i++)
+		dst[i] = src[i] ^ stream[i];
+	aes_ctr_inc(ctr);
+}
+
+/* data is encrypted and hashed in chunks of this size, while it is in cache */
+#define AES_GCM_CHUNK	4096
+
+/**
+ * struct aes_gcm_ghash - GHASH state
+ *
+ * @hh:	High halves of H times each 4-bit value, H being the hash key
+ * @hl:	Low halves of the same
+ * @y:	Hash so far
+ */
+struct aes_gcm_ghash {
+	u64 hh[16];
+	u64 hl[16];
+	u8 y[AES_BLOCK_LENGTH];
+};
+
+/* reduction of the four bits shifted out of the bottom of a product */
+static const u64 ghash_rem[16] = {
+	0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+	0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+};
+
+static void aes_gcm_init(struct aes_gcm_ghash *gh, const u8 *h)
+{
+	u64 vh, vl;
+	int i, j;
+
+	vh = (u64)AES_GETU32(h) << 32 | AES_GETU32(h + 4);
+	vl = (u64)AES_GETU32(h + 8) << 32 | AES_GETU32(h + 12);
+
+	/* GCM bit order is reversed, so H * x goes in entry 4 and so on */
+	gh->hh[0] = 0;
+	gh->hl[0] = 0;
+	gh->hh[8] = vh;
+	gh->hl[8] = vl;
+	for (i = 4; i > 0; i >>= 1) {
+		u64 carry = vl & 1;
+
+		vl = vh << 63 | vl >> 1;
+		vh = vh >> 1 ^ (carry ? 0xe100000000000000ULL : 0);
+		gh->hh[i] = vh;
+		gh->hl[i] = vl;
+	}
+	for (i = 2; i <= 8; i <<= 1) {
+		for (j = 1; j < i; j++) {
+			gh->hh[i + j] = gh->hh[i] ^ gh->hh[j];
+			gh->hl[i + j] = gh->hl[i] ^ gh->hl[j];
+		}
+	}
+	memset(gh->y, 0, sizeof(gh->y));
+}
+
+/* multiply z by x^4 and add in the product of H and a 4-bit value */
+static inline void aes_gcm_mul4(const struct aes_gcm_ghash *gh, u64 *zh,
+				u64 *zl, u8 nibble)
+{
+	u8 rem = *zl & 0xf;
+
+	*zl = (*zh << 60 | *zl >> 4) ^ gh->hl[nibble];
+	*zh = (*zh >> 4 ^ ghash_rem[rem] << 48) ^ gh->hh[nibble];
+}
+
+/* y = (y ^ block) * H */
+static void aes_gcm_ghash_block(struct aes_gcm_ghash *gh, const u8 *block)
+{
+	u64 zh = 0, zl = 0;
+	u8 x;
+	int i;
+
+	for (i = AES_BLOCK_LENGTH - 1; i >= 0; i--) {
+		x = gh->y[i] ^ block[i];
+		aes_gcm_mul4(gh, &zh, &zl, x & 0xf);
+		aes_gcm_mul4(gh, &zh, &zl, x >> 4);
+	}
+
+	aes_putu32(gh->y, zh >> 32);
+	aes_putu32(gh->y + 4, zh);
+	aes_putu32(gh->y + 8, zl >> 32);
+	aes_putu32(gh->y + 12, zl);
+}
+
+/* hash data, padding the last block with zeroes */
+static void aes_gcm_ghash(struct aes_gcm_ghash *gh, const u8 *data, u32 len)
+{
+	u8 block[AES_BLOCK_LENGTH];
+
+	for (; len >= AES_BLOCK_LENGTH; len -= AES_BLOCK_LENGTH) {
+		aes_gcm_ghash_block(gh, data);
+		data += AES_BLOCK_LENGTH;
+	}
+	if (len) {
+		memset(block, 0, sizeof(block));
+		memcpy(block, data, len);
+		aes_gcm_ghash_block(gh, block);
+	}
+}
+
+static void aes_gcm_crypt(u32 key_len, u8 *key_exp, u8 *iv, u8 *aad,
+			  u32 aad_len, u8 *src, u8 *dst, u32 len, u8 *tag,
+			  bool encrypt)
+{
+	u8 j0[AES_BLOCK_LENGTH], ctr[AES_BLOCK_LENGTH];
+	u8 block[AES_BLOCK_LENGTH];
+	struct aes_gcm_ghash gh;
+	u32 left, chunk;
+	int i;
+
+	/* the hash key is the encrypted zero block */
+	aes_encrypt(key_len, (u8 *)AES_ZERO_BLOCK, key_exp, block);
+	aes_gcm_init(&gh, block);
+	aes_gcm_ghash(&gh, aad, aad_len);
+
+	memcpy(j0, iv, AES_GCM_IV_LENGTH);
+	memset(j0 + AES_GCM_IV_LENGTH, 0, AES_BLOCK_LENGTH - AES_GCM_IV_LENGTH);
+	j0[AES_BLOCK_LENGTH - 1] = 1;
+
+	/*
+	 * GCM only increments the bottom 32 bits of the counter, but starting
+	 * from 2 they cannot wrap within 2^32 bytes, so plain CTR is the same
+	 */
+	memcpy(ctr, j0, AES_BLOCK_LENGTH);
+	aes_ctr_inc(ctr);
+	for (left = len; left; left -= chunk) {
+		chunk = min_t(u32, left, AES_GCM_CHUNK);
+		if (!encrypt)
+			aes_gcm_ghash(&gh, src, chunk);
+		aes_ctr_crypt(key_len, key_exp, ctr, src, dst, chunk);
+		if (encrypt)
+			aes_gcm_ghash(&gh, dst, chunk);
+		src += chunk;
+		dst += chunk;
+	}
+
+	/* finish with the lengths in bits */
+	aes_putu32(block, aad_len >> 29);
+	aes_putu32(block + 4, aad_len << 3);
+	aes_putu32(block + 8, len >> 29);
+	aes_putu32(block + 12, len << 3);
+	aes_gcm_ghash_block(&gh, block);
+
+	aes_encrypt(key_len, j0, key_exp, block);
+	for (i = 0; i < AES_GCM_TAG_LENGTH; i++)
+		tag[i] = block[i] ^ gh.y[i];
+}
+
+void aes_gcm_encrypt(u32 key_len, u8 *key_exp, u8 *iv, u8 *aad, u32 aad_len,
+		     u8 *src, u8 *dst, u32 len, u8 *tag)
+{
+	aes_gcm_crypt(key_len, key_exp, iv, aad, aad_len, src, dst, len, tag,
+		      true);
+}
+
+int aes_gcm_decrypt(u32 key_len, u8 *key_exp, u8 *iv, u8 *aad, u32 aad_len,
+		    u8 *src, u8 *dst, u32 len, u8 *tag)
+{
+	u8 calc[AES_GCM_TAG_LENGTH];
+	u8 diff = 0;
+	int i;
+
+	aes_gcm_crypt(key_len, key_exp, iv, aad, aad_len, src, dst, len, calc,
+		      false);
+
+	/* compare all of the tag, so the time taken does not depend on it */
+	for (i = 0; i < AES_GCM_TAG_LENGTH; i++)
+		diff |= calc[i] ^ tag[i];
+	if (diff) {
+		/* do not hand out data that failed authentication */
+		memset(dst, 0, len);
+		return -EBADMSG;
+	}
+
+	return 0;
+}
@@ -82,7 +82,7 @@ static void __efi_runtime make_crc_table(void)
   }
   crc_table_empty = 0;
 }
-#elif !defined(CONFIG_ARM64_CRC32)
+#elif !defined(CONFIG_ARM64_CRC32) && !CONFIG_IS_ENABLED(CRC32_SLICE_BY_8)
 /* ========================================================================
  * Table of CRC-32's of all single-byte values (made by make_crc_table)
  */
@@ -177,16 +177,139 @@ const uint32_t * ZEXPORT get_crc_table()
 
 /* ========================================================================= */
 
+#ifdef CONFIG_ARM64_CRC32
+/*
+ * The crc32x instruction has a latency of several cycles but can usually
+ * start every cycle, so large buffers are split into three lanes of
+ * CRC32_LANE bytes which are checksummed in parallel. The CRCs of the first
+ * two lanes are then moved past the bytes that follow them, by a carry-less
+ * multiply with x^(8 * n - 33) mod P, where n is the number of bytes to
+ * skip, and a crc32x of the product.
+ */
+#define CRC32_LANE		1024
+#define CRC32_SHIFT_1LANE	0xbbf2f6d6	/* x^(8 * 1024 - 33) mod P */
+#define CRC32_SHIFT_2LANES	0x7b4aa8b7	/* x^(16 * 1024 - 33) mod P */
+
+/* Carry-less multiples of k by each 4-bit value */
+#define CLMUL4(k, i) \
+	(((i) & 1 ? (u64)(k) : 0) ^ ((i) & 2 ? (u64)(k) << 1 : 0) ^ \
+	 ((i) & 4 ? (u64)(k) << 2 : 0) ^ ((i) & 8 ? (u64)(k) << 3 : 0))
+#define CLMUL4_ROW(k) { \
+	CLMUL4(k, 0), CLMUL4(k, 1), CLMUL4(k, 2), CLMUL4(k, 3), \
+	CLMUL4(k, 4), CLMUL4(k, 5), CLMUL4(k, 6), CLMUL4(k, 7), \
+	CLMUL4(k, 8), CLMUL4(k, 9), CLMUL4(k, 10), CLMUL4(k, 11), \
+	CLMUL4(k, 12), CLMUL4(k, 13), CLMUL4(k, 14), CLMUL4(k, 15) }
+
+static const u64 __efi_runtime_rodata crc32_shift_tab[2][16] = {
+	CLMUL4_ROW(CRC32_SHIFT_1LANE),
+	CLMUL4_ROW(CRC32_SHIFT_2LANES),
+};
+
+/* Carry-less multiply @val by the constant whose multiples are in @tab */
+static u64 __efi_runtime crc32_clmul(u32 val, const u64 *tab)
+{
+	u64 prod = 0;
+	int i;
+
+	for (i = 28; i >= 0; i -= 4)
+		prod = (prod << 4) ^ tab[(val >> i) & 15];
+
+	return prod;
+}
+
+#if CONFIG_IS_ENABLED(ARMV8_CE_CRC32)
+/* Below this the setup and final reduction of the PMULL path do not pay */
+#define CRC32_PMULL_MIN		4096
+
+/* Checksum @len bytes, a non-zero multiple of 64, using PMULL folding */
+u32 crc32_pmull_le(u32 crc, const u8 *buf, size_t len);
+#endif
+
+static uint32_t __efi_runtime crc32_arm64(uint32_t crc, const u8 *buf,
+					  size_t len)
+{
+	const u64 *p;
+
+	while (len && ((ulong)buf & 7)) {
+		crc = __builtin_aarch64_crc32b(crc, *buf++);
+		len--;
+	}
+#if CONFIG_IS_ENABLED(ARMV8_CE_CRC32)
+	if (len >= CRC32_PMULL_MIN) {
+		size_t todo = len & ~63UL;
+
+		crc = crc32_pmull_le(crc, buf, todo);
+		buf += todo;
+		len -= todo;
+	}
+#endif
+	p = (const u64 *)buf;
+	while (len >= 3 * CRC32_LANE) {
+		uint32_t crc1 = 0, crc2 = 0;
+		int i;
+
+		for (i = 0; i < CRC32_LANE / 8; i++) {
+			crc = __builtin_aarch64_crc32x(crc, p[i]);
+			crc1 = __builtin_aarch64_crc32x(crc1,
+							p[i + CRC32_LANE / 8]);
+			crc2 = __builtin_aarch64_crc32x(crc2,
+							p[i + CRC32_LANE / 4]);
+		}
+		crc = crc2 ^ __builtin_aarch64_crc32x(0,
+				crc32_clmul(crc, crc32_shift_tab[1]) ^
+				crc32_clmul(crc1, crc32_shift_tab[0]));
+		p += 3 * CRC32_LANE / 8;
+		len -= 3 * CRC32_LANE;
+	}
+	for (; len >= 8; len -= 8)
+		crc = __builtin_aarch64_crc32x(crc, *p++);
+	buf = (const u8 *)p;
+	while (len--)
+		crc = __builtin_aarch64_crc32b(crc, *buf++);
+
+	return crc;
+}
+#elif CONFIG_IS_ENABLED(CRC32_SLICE_BY_8)
+#include "crc32_slice8.h"
+
+/*
+ * Slicing-by-8: each step folds eight bytes into the CRC with eight
+ * independent table lookups, rather than one dependent lookup per byte
+ */
+static uint32_t __efi_runtime crc32_slice_by_8(uint32_t crc, const u8 *buf,
+					       size_t len)
+{
+	const uint32_t (*tab)[256] = crc32_slice8;
+
+	while (len && ((ulong)buf & 7)) {
+		crc = tab[0][(crc ^ *buf++) & 0xff] ^ (crc >> 8);
+		len--;
+	}
+	for (; len >= 8; len -= 8, buf += 8) {
+		uint32_t lo = le32_to_cpu(*(const uint32_t *)buf) ^ crc;
+		uint32_t hi = le32_to_cpu(*(const uint32_t *)(buf + 4));
+
+		crc = tab[7][lo & 0xff] ^ tab[6][(lo >> 8) & 0xff] ^
+		      tab[5][(lo >> 16) & 0xff] ^ tab[4][lo >> 24] ^
+		      tab[3][hi & 0xff] ^ tab[2][(hi >> 8) & 0xff] ^
+		      tab[1][(hi >> 16) & 0xff] ^ tab[0][hi >> 24];
+	}
+	while (len--)
+		crc = tab[0][(crc ^ *buf++) & 0xff] ^ (crc >> 8);
+
+	return crc;
+}
+#endif
+
 /* No ones complement version. JFFS2 (and other things ?)
  * don't use ones compliment in their CRC calculations.
  */
 uint32_t __efi_runtime crc32_no_comp(uint32_t crc, const Bytef *buf, uInt len)
 {
 #ifdef CONFIG_ARM64_CRC32
-    crc = cpu_to_le32(crc);
-    while (len--)
-        crc = __builtin_aarch64_crc32b(crc, *buf++);
-    return le32_to_cpu(crc);
+    return crc32_arm64(crc, buf, len);
+#elif CONFIG_IS_ENABLED(CRC32_SLICE_BY_8)
+    return crc32_slice_by_8(crc, buf, len);
 #else
     const uint32_t *tab = crc_table;
     const uint32_t *b =(const uint32_t *)buf;
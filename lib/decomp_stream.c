@@ -0,0 +1,477 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Decompressing a compressed image in pieces, as it is read from storage
+ *
+ * Copyright 2026 The U-Boot Authors
+ */
+
+#define LOG_CATEGORY	LOGC_BOOT
+
+#include <decomp_stream.h>
+#include <errno.h>
+#include <hash.h>
+#include <image.h>
+#include <log.h>
+#include <malloc.h>
+#include <watchdog.h>
+#include <asm/unaligned.h>
+#include <linux/string.h>
+#include <linux/zstd.h>
+#include <lzma/LzmaTypes.h>
+#include <lzma/LzmaDec.h>
+#include <u-boot/lz4.h>
+#include <u-boot/zlib.h>
+
+/**
+ * struct decomp_stream_ops - Operations for a streaming decompressor
+ *
+ * @comp: Compression type (IH_COMP_...)
+ * @init: Set up @ds->priv, returning 0 if OK or -ve on error
+ * @feed: Decompress @len bytes of input at @in, updating @ds->out_len and
+ *	setting @ds->done at the end of the stream. Returns 0 if OK or -ve on
+ *	error
+ * @ended: Check whether the input so far is a complete stream, for formats
+ *	which can end without an end marker (optional)
+ * @uninit: Free @ds->priv
+ */
+struct decomp_stream_ops {
+	int comp;
+	int (*init)(struct decomp_stream *ds);
+	int (*feed)(struct decomp_stream *ds, const void *in, ulong len);
+	bool (*ended)(struct decomp_stream *ds);
+	void (*uninit)(struct decomp_stream *ds);
+};
+
+static int none_feed(struct decomp_stream *ds, const void *in, ulong len)
+{
+	if (len > ds->out_size - ds->out_len)
+		return -ENOSPC;
+	memmove(ds->out + ds->out_len, in, len);
+	ds->out_len += len;
+
+	return 0;
+}
+
+static int none_init(struct decomp_stream *ds)
+{
+	return 0;
+}
+
+/* there is no end marker without compression */
+static bool none_ended(struct decomp_stream *ds)
+{
+	return true;
+}
+
+static void none_free(struct decomp_stream *ds)
+{
+}
+
+static int __maybe_unused gzip_init(struct decomp_stream *ds)
+{
+	z_stream *s;
+
+	s = calloc(1, sizeof(*s));
+	if (!s)
+		return -ENOMEM;
+	s->zalloc = gzalloc;
+	s->zfree = gzfree;
+
+	/* let zlib parse the gzip header and check the trailer */
+	if (inflateInit2(s, 16 + MAX_WBITS) != Z_OK) {
+		free(s);
+		return -ENOMEM;
+	}
+	ds->priv = s;
+
+	return 0;
+}
+
+static int __maybe_unused gzip_feed(struct decomp_stream *ds, const void *in,
+				    ulong len)
+{
+	z_stream *s = ds->priv;
+	int ret;
+
+	s->next_in = (void *)in;
+	s->avail_in = len;
+	s->next_out = ds->out + ds->out_len;
+	s->avail_out = ds->out_size - ds->out_len;
+
+	ret = inflate(s, Z_NO_FLUSH);
+	ds->out_len = ds->out_size - s->avail_out;
+	switch (ret) {
+	case Z_STREAM_END:
+		ds->done = true;
+		return 0;
+	case Z_OK:
+	case Z_BUF_ERROR:
+		/* inflate() only stops early if the output buffer is full */
+		if (s->avail_in)
+			return -ENOSPC;
+		return 0;
+	case Z_MEM_ERROR:
+		return -ENOMEM;
+	default:
+		log_debug("inflate() returned %d\n", ret);
+		return -EINVAL;
+	}
+}
+
+static void __maybe_unused gzip_free(struct decomp_stream *ds)
+{
+	inflateEnd(ds->priv);
+	free(ds->priv);
+}
+
+/**
+ * struct lzma_stream - Private state for LZMA streams
+ *
+ * @dec: LZMA decoder, using the output buffer as its dictionary
+ * @alloc: Allocator for the decoder
+ * @header: LZMA_Alone header, collected until complete
+ * @header_len: Number of bytes in @header
+ * @limit: Number of bytes expected in the output buffer
+ * @known_size: true if the header gives the uncompressed size
+ */
+struct lzma_stream {
+	CLzmaDec dec;
+	ISzAlloc alloc;
+	u8 header[LZMA_PROPS_SIZE + sizeof(u64)];
+	uint header_len;
+	SizeT limit;
+	bool known_size;
+};
+
+static void *lzma_alloc(void *p, size_t size)
+{
+	return malloc(size);
+}
+
+static void lzma_free_mem(void *p, void *address)
+{
+	free(address);
+}
+
+static int __maybe_unused lzma_init(struct decomp_stream *ds)
+{
+	struct lzma_stream *priv;
+
+	priv = calloc(1, sizeof(*priv));
+	if (!priv)
+		return -ENOMEM;
+	LzmaDec_Construct(&priv->dec);
+	priv->alloc.Alloc = lzma_alloc;
+	priv->alloc.Free = lzma_free_mem;
+	ds->priv = priv;
+
+	return 0;
+}
+
+/* Set up the decoder once the header is complete */
+static int lzma_start(struct decomp_stream *ds, struct lzma_stream *priv)
+{
+	u64 size = get_unaligned_le64(priv->header + LZMA_PROPS_SIZE);
+
+	if (size == ~0ULL) {
+		/* unknown size, so the stream must have an end marker */
+		priv->limit = ds->out_size;
+	} else {
+		if (size > ds->out_size)
+			return -ENOSPC;
+		priv->limit = size;
+		priv->known_size = true;
+	}
+	if (LzmaDec_AllocateProbs(&priv->dec, priv->header, LZMA_PROPS_SIZE,
+				  &priv->alloc) != SZ_OK)
+		return -EINVAL;
+	priv->dec.dic = ds->out;
+	priv->dec.dicBufSize = ds->out_size;
+	LzmaDec_Init(&priv->dec);
+
+	return 0;
+}
+
+static int __maybe_unused lzma_feed(struct decomp_stream *ds, const void *in,
+				    ulong len)
+{
+	struct lzma_stream *priv = ds->priv;
+	ELzmaStatus status;
+	SizeT in_size;
+	SRes res;
+	int ret;
+
+	if (priv->header_len < sizeof(priv->header)) {
+		uint count = min_t(ulong, sizeof(priv->header) - priv->header_len,
+				   len);
+
+		memcpy(priv->header + priv->header_len, in, count);
+		priv->header_len += count;
+		in += count;
+		len -= count;
+		if (priv->header_len < sizeof(priv->header))
+			return 0;
+		ret = lzma_start(ds, priv);
+		if (ret)
+			return ret;
+	}
+
+	in_size = len;
+	res = LzmaDec_DecodeToDic(&priv->dec, priv->limit, in, &in_size,
+				  LZMA_FINISH_END, &status);
+	ds->out_len = priv->dec.dicPos;
+	if (res != SZ_OK) {
+		log_debug("LzmaDec_DecodeToDic() returned %d\n", res);
+		return ds->out_len == ds->out_size ? -ENOSPC : -EINVAL;
+	}
+	/*
+	 * If the output buffer fills up, the end marker may still be in the
+	 * next piece of input, so leave it to decomp_stream_finish() to
+	 * report that the buffer is too small
+	 */
+	if (status == LZMA_STATUS_FINISHED_WITH_MARK ||
+	    (priv->known_size && ds->out_len == priv->limit))
+		ds->done = true;
+
+	return 0;
+}
+
+static void __maybe_unused lzma_free(struct decomp_stream *ds)
+{
+	struct lzma_stream *priv = ds->priv;
+
+	LzmaDec_FreeProbs(&priv->dec, &priv->alloc);
+	free(priv);
+}
+
+static int __maybe_unused lz4_init(struct decomp_stream *ds)
+{
+	return ulz4f_stream_new(ds->out, ds->out_size,
+				(struct ulz4f_stream **)&ds->priv);
+}
+
+static int __maybe_unused lz4_feed(struct decomp_stream *ds, const void *in,
+				   ulong len)
+{
+	size_t out_len;
+	int ret;
+
+	ret = ulz4f_stream_feed(ds->priv, in, len, &out_len);
+	ds->out_len = out_len;
+	switch (ret) {
+	case 0:
+	case -ENOSPC:
+	case -ENOMEM:
+		return ret;
+	default:
+		log_debug("ulz4f_stream_feed() returned %d\n", ret);
+		return -EINVAL;
+	}
+}
+
+/* LZ4 frames may be concatenated, so the stream can end after any frame */
+static bool __maybe_unused lz4_ended(struct decomp_stream *ds)
+{
+	return ulz4f_stream_ended(ds->priv);
+}
+
+static void __maybe_unused lz4_free(struct decomp_stream *ds)
+{
+	ulz4f_stream_free(ds->priv);
+}
+
+static int __maybe_unused zstd_init(struct decomp_stream *ds)
+{
+	struct zstd_stream *zs;
+	int ret;
+
+	zs = malloc(sizeof(*zs));
+	if (!zs)
+		return -ENOMEM;
+	/* the output buffer serves as the window */
+	ret = zstd_stream_init(zs, 0, true);
+	if (ret) {
+		free(zs);
+		return ret;
+	}
+	ds->priv = zs;
+
+	return 0;
+}
+
+static int __maybe_unused zstd_feed(struct decomp_stream *ds, const void *in,
+				    ulong len)
+{
+	struct zstd_stream *zs = ds->priv;
+	zstd_in_buffer zin = { .src = in, .size = len };
+	zstd_out_buffer zout = {
+		.dst = ds->out,
+		.size = ds->out_size,
+		.pos = ds->out_len,
+	};
+	int ret;
+
+	ret = zstd_stream_feed(zs, &zin, &zout);
+	ds->out_len = zout.pos;
+	if (ret)
+		return ret;
+	if (zs->done)
+		ds->done = true;
+	else if (zin.pos < zin.size)
+		return -ENOSPC;
+
+	return 0;
+}
+
+/* another frame may follow, so the stream can end after any frame */
+static bool __maybe_unused zstd_ended(struct decomp_stream *ds)
+{
+	struct zstd_stream *zs = ds->priv;
+
+	return zs->frame_end;
+}
+
+static void __maybe_unused zstd_free(struct decomp_stream *ds)
+{
+	zstd_stream_free(ds->priv);
+	free(ds->priv);
+}
+
+static const struct decomp_stream_ops decomp_stream_ops[] = {
+	{
+		.comp	= IH_COMP_NONE,
+		.init	= none_init,
+		.feed	= none_feed,
+		.ended	= none_ended,
+		.uninit	= none_free,
+	},
+#if CONFIG_IS_ENABLED(GZIP)
+	{
+		.comp	= IH_COMP_GZIP,
+		.init	= gzip_init,
+		.feed	= gzip_feed,
+		.uninit	= gzip_free,
+	},
+#endif
+#if CONFIG_IS_ENABLED(LZMA)
+	{
+		.comp	= IH_COMP_LZMA,
+		.init	= lzma_init,
+		.feed	= lzma_feed,
+		.uninit	= lzma_free,
+	},
+#endif
+#if CONFIG_IS_ENABLED(LZ4)
+	{
+		.comp	= IH_COMP_LZ4,
+		.init	= lz4_init,
+		.feed	= lz4_feed,
+		.ended	= lz4_ended,
+		.uninit	= lz4_free,
+	},
+#endif
+#if CONFIG_IS_ENABLED(ZSTD)
+	{
+		.comp	= IH_COMP_ZSTD,
+		.init	= zstd_init,
+		.feed	= zstd_feed,
+		.ended	= zstd_ended,
+		.uninit	= zstd_free,
+	},
+#endif
+};
+
+static const struct decomp_stream_ops *decomp_stream_find(int comp)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(decomp_stream_ops); i++) {
+		if (decomp_stream_ops[i].comp == comp)
+			return &decomp_stream_ops[i];
+	}
+
+	return NULL;
+}
+
+bool decomp_stream_supported(int comp)
+{
+	return decomp_stream_find(comp);
+}
+
+int decomp_stream_init(struct decomp_stream *ds, int comp, void *out,
+		       ulong out_size)
+{
+	int ret;
+
+	memset(ds, '\0', sizeof(*ds));
+	ds->comp = comp;
+	ds->out = out;
+	ds->out_size = out_size;
+	ds->ops = decomp_stream_find(comp);
+	if (!ds->ops)
+		return log_msg_ret("comp", -EPROTONOSUPPORT);
+	ret = ds->ops->init(ds);
+	if (ret) {
+		ds->ops = NULL;
+		return log_msg_ret("init", ret);
+	}
+
+	return 0;
+}
+
+int decomp_stream_feed(struct decomp_stream *ds, const void *in, ulong len)
+{
+	int ret;
+
+	if (!ds->ops)
+		return -EINVAL;
+	if (ds->hash) {
+		ret = ds->hash->hash_update(ds->hash, ds->hash_ctx, in, len, 0);
+		if (ret) {
+			/* the hash context has been freed */
+			ds->hash = NULL;
+			decomp_stream_abort(ds);
+			return log_msg_ret("hash", -EIO);
+		}
+	}
+	ds->in_len += len;
+	if (ds->done)
+		return 0;
+
+	ret = ds->ops->feed(ds, in, len);
+	schedule();
+	if (ret) {
+		log_debug("comp %d: failed at input offset %lx (err=%d)\n",
+			  ds->comp, ds->in_len - len, ret);
+		decomp_stream_abort(ds);
+		return ret;
+	}
+
+	return 0;
+}
+
+int decomp_stream_finish(struct decomp_stream *ds, ulong *out_lenp)
+{
+	bool done = ds->done;
+
+	if (!done && ds->ops && ds->ops->ended)
+		done = ds->ops->ended(ds);
+	*out_lenp = ds->out_len;
+	decomp_stream_abort(ds);
+	if (!done) {
+		if (ds->out_len == ds->out_size)
+			return log_msg_ret("full", -ENOSPC);
+		return log_msg_ret("end", -EINVAL);
+	}
+
+	return 0;
+}
+
+void decomp_stream_abort(struct decomp_stream *ds)
+{
+	if (ds->ops) {
+		ds->ops->uninit(ds);
+		ds->ops = NULL;
+		ds->priv = NULL;
+	}
+}
@@ -0,0 +1,893 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Software ECDSA signature verification for the NIST P-256 and P-384 curves
+ *
+ * Field elements are held in Montgomery form and points in Jacobian
+ * coordinates, so no field inversion is needed at all. u1 * G + u2 * Q is
+ * worked out with a single run of doublings (Shamir's trick), adding in
+ * fixed 4-bit windows of both scalars: the multiples of G come from a table
+ * built at compile time and the multiples of Q are worked out for each
+ * verification. The sequence of operations depends only on the scalars.
+ *
+ * Copyright 2026 The U-Boot Authors
+ */
+
+#include <crypto/ecdsa-uclass.h>
+#include <dm.h>
+#include <log.h>
+#include <u-boot/ecdsa.h>
+
+/* Use 64-bit limbs where the compiler has a 128-bit type for the products */
+#ifdef __SIZEOF_INT128__
+typedef u64 ecc_limb;
+typedef unsigned __int128 ecc_dlimb;
+#define ECC_L(hi, lo)	((u64)(hi) << 32 | (lo))
+#else
+typedef u32 ecc_limb;
+typedef u64 ecc_dlimb;
+#define ECC_L(hi, lo)	(lo), (hi)
+#endif
+
+#define ECC_LIMB_BITS	(sizeof(ecc_limb) * 8)
+#define ECC_MAX_LIMBS	(384 / ECC_LIMB_BITS)
+
+#define ECC_WINDOW_BITS	4
+#define ECC_TABLE_SIZE	((1 << ECC_WINDOW_BITS) - 1)
+
+/**
+ * struct ecc_mod - a modulus for Montgomery arithmetic
+ *
+ * @m:		Modulus as little endian limb array
+ * @rr:		R^2 mod m, where R is 2^bits
+ * @n0inv:	-1 / m[0] mod 2^ECC_LIMB_BITS
+ */
+struct ecc_mod {
+	const ecc_limb *m;
+	const ecc_limb *rr;
+	ecc_limb n0inv;
+};
+
+/**
+ * struct ecc_curve - a short Weierstrass curve y^2 = x^3 - 3x + b
+ *
+ * @name:	Curve name, as used in the 'ecdsa,curve' key property
+ * @bits:	Size of the field and of the group order in bits
+ * @len:	Number of limbs in a field element
+ * @p:		Field prime
+ * @n:		Group order
+ * @b:		Curve parameter b, in Montgomery form
+ * @g_table:	Multiples (i + 1) * G for i < ECC_TABLE_SIZE, as affine x, y
+ *		pairs in Montgomery form
+ */
+struct ecc_curve {
+	const char *name;
+	uint bits;
+	uint len;
+	struct ecc_mod p;
+	struct ecc_mod n;
+	const ecc_limb *b;
+	const ecc_limb *g_table;
+};
+
+/**
+ * struct ecc_point - a point in Jacobian coordinates
+ *
+ * This is (x / z^2, y / z^3) in affine coordinates; z = 0 for the point at
+ * infinity
+ */
+struct ecc_point {
+	ecc_limb x[ECC_MAX_LIMBS];
+	ecc_limb y[ECC_MAX_LIMBS];
+	ecc_limb z[ECC_MAX_LIMBS];
+};
+
+/* P-256 */
+static const ecc_limb p256_p[] = {
+	ECC_L(0xffffffff, 0xffffffff), ECC_L(0x00000000, 0xffffffff),
+	ECC_L(0x00000000, 0x00000000), ECC_L(0xffffffff, 0x00000001),
+};
+
+static const ecc_limb p256_p_rr[] = {
+	ECC_L(0x00000000, 0x00000003), ECC_L(0xfffffffb, 0xffffffff),
+	ECC_L(0xffffffff, 0xfffffffe), ECC_L(0x00000004, 0xfffffffd),
+};
+
+static const ecc_limb p256_b[] = {
+	ECC_L(0xd89cdf62, 0x29c4bddf), ECC_L(0xacf005cd, 0x78843090),
+	ECC_L(0xe5a220ab, 0xf7212ed6), ECC_L(0xdc30061d, 0x04874834),
+};
+
+static const ecc_limb p256_n[] = {
+	ECC_L(0xf3b9cac2, 0xfc632551), ECC_L(0xbce6faad, 0xa7179e84),
+	ECC_L(0xffffffff, 0xffffffff), ECC_L(0xffffffff, 0x00000000),
+};
+
+static const ecc_limb p256_n_rr[] = {
+	ECC_L(0x83244c95, 0xbe79eea2), ECC_L(0x4699799c, 0x49bd6fa6),
+	ECC_L(0x2845b239, 0x2b6bec59), ECC_L(0x66e12d94, 0xf3d95620),
+};
+
+/* (i + 1) * G as x, y in Montgomery form */
+static const ecc_limb p256_g_table[ECC_TABLE_SIZE][2 * 256 / ECC_LIMB_BITS] = {
+	{
+		ECC_L(0x79e730d4, 0x18a9143c), ECC_L(0x75ba95fc, 0x5fedb601),
+		ECC_L(0x79fb732b, 0x77622510), ECC_L(0x18905f76, 0xa53755c6),
+		ECC_L(0xddf25357, 0xce95560a), ECC_L(0x8b4ab8e4, 0xba19e45c),
+		ECC_L(0xd2e88688, 0xdd21f325), ECC_L(0x8571ff18, 0x25885d85),
+	},
+	{
+		ECC_L(0x850046d4, 0x10ddd64d), ECC_L(0xaa6ae3c1, 0xa433827d),
+		ECC_L(0x73220503, 0x8d1490d9), ECC_L(0xf6bb32e4, 0x3dcf3a3b),
+		ECC_L(0x2f3648d3, 0x61bee1a5), ECC_L(0x152cd7cb, 0xeb236ff8),
+		ECC_L(0x19a8fb0e, 0x92042dbe), ECC_L(0x78c57751, 0x0a5b8a3b),
+	},
+	{
+		ECC_L(0xffac3f90, 0x4eebc127), ECC_L(0xb027f84a, 0x087d81fb),
+		ECC_L(0x66ad77dd, 0x87cbbc98), ECC_L(0x26936a3f, 0xb6ff747e),
+		ECC_L(0xb04c5c1f, 0xc983a7eb), ECC_L(0x583e47ad, 0x0861fe1a),
+		ECC_L(0x78820831, 0x1a2ee98e), ECC_L(0xd5f06a29, 0xe587cc07),
+	},
+	{
+		ECC_L(0x74b0b50d, 0x46918dcc), ECC_L(0x4650a6ed, 0xc623c173),
+		ECC_L(0x0cdaacac, 0xe8100af2), ECC_L(0x577362f5, 0x41b0176b),
+		ECC_L(0x2d96f24c, 0xe4cbaba6), ECC_L(0x17628471, 0xfad6f447),
+		ECC_L(0x6b6c36de, 0xe5ddd22e), ECC_L(0x84b14c39, 0x4c5ab863),
+	},
+	{
+		ECC_L(0xbe1b8aae, 0xc45c61f5), ECC_L(0x90ec649a, 0x94b9537d),
+		ECC_L(0x941cb5aa, 0xd076c20c), ECC_L(0xc9079605, 0x890523c8),
+		ECC_L(0xeb309b4a, 0xe7ba4f10), ECC_L(0x73c568ef, 0xe5eb882b),
+		ECC_L(0x3540a987, 0x7e7a1f68), ECC_L(0x73a076bb, 0x2dd1e916),
+	},
+	{
+		ECC_L(0x40394737, 0x3e77664a), ECC_L(0x55ae744f, 0x346cee3e),
+		ECC_L(0xd50a961a, 0x5b17a3ad), ECC_L(0x13074b59, 0x54213673),
+		ECC_L(0x93d36220, 0xd377e44b), ECC_L(0x299c2b53, 0xadff14b5),
+		ECC_L(0xf424d44c, 0xef639f11), ECC_L(0xa4c9916d, 0x4a07f75f),
+	},
+	{
+		ECC_L(0x0746354e, 0xa0173b4f), ECC_L(0x2bd20213, 0xd23c00f7),
+		ECC_L(0xf43eaab5, 0x0c23bb08), ECC_L(0x13ba5119, 0xc3123e03),
+		ECC_L(0x2847d030, 0x3f5b9d4d), ECC_L(0x6742f2f2, 0x5da67bdd),
+		ECC_L(0xef933bdc, 0x77c94195), ECC_L(0xeaedd915, 0x6e240867),
+	},
+	{
+		ECC_L(0x27f14cd1, 0x9499a78f), ECC_L(0x462ab5c5, 0x6f9b3455),
+		ECC_L(0x8f90f02a, 0xf02cfc6b), ECC_L(0xb763891e, 0xb265230d),
+		ECC_L(0xf59da3a9, 0x532d4977), ECC_L(0x21e3327d, 0xcf9eba15),
+		ECC_L(0x123c7b84, 0xbe60bbf0), ECC_L(0x56ec12f2, 0x7706df76),
+	},
+	{
+		ECC_L(0x75c96e8f, 0x264e20e8), ECC_L(0xabe6bfed, 0x59a7a841),
+		ECC_L(0x2cc09c04, 0x44c8eb00), ECC_L(0xe05b3080, 0xf0c4e16b),
+		ECC_L(0x1eb7777a, 0xa45f3314), ECC_L(0x56af7bed, 0xce5d45e3),
+		ECC_L(0x2b6e019a, 0x88b12f1a), ECC_L(0x086659cd, 0xfd835f9b),
+	},
+	{
+		ECC_L(0x2c18dbd1, 0x9dc21ec8), ECC_L(0x98f9868a, 0x0fcf8139),
+		ECC_L(0x737d2cd6, 0x48250b49), ECC_L(0xcc61c947, 0x24b3428f),
+		ECC_L(0x0c2b4078, 0x80dd9e76), ECC_L(0xc43a8991, 0x383fbe08),
+		ECC_L(0x5f7d2d65, 0x779be5d2), ECC_L(0x78719a54, 0xeb3b4ab5),
+	},
+	{
+		ECC_L(0xea7d260a, 0x6245e404), ECC_L(0x9de40795, 0x6e7fdfe0),
+		ECC_L(0x1ff3a415, 0x8dac1ab5), ECC_L(0x3e7090f1, 0x649c9073),
+		ECC_L(0x1a768561, 0x2b944e88), ECC_L(0x250f939e, 0xe57f61c8),
+		ECC_L(0x0c0daa89, 0x1ead643d), ECC_L(0x68930023, 0xe125b88e),
+	},
+	{
+		ECC_L(0x04b71aa7, 0xd2697768), ECC_L(0xabdedef5, 0xca345a33),
+		ECC_L(0x2409d29d, 0xee37385e), ECC_L(0x4ee1df77, 0xcb83e156),
+		ECC_L(0x0cac12d9, 0x1cbb5b43), ECC_L(0x170ed2f6, 0xca895637),
+		ECC_L(0x28228cfa, 0x8ade6d66), ECC_L(0x7ff57c95, 0x53238aca),
+	},
+	{
+		ECC_L(0xccc42563, 0x4b2ed709), ECC_L(0x0e356769, 0x856fd30d),
+		ECC_L(0xbcbcd43f, 0x559e9811), ECC_L(0x738477ac, 0x5395b759),
+		ECC_L(0x35752b90, 0xc00ee17f), ECC_L(0x68748390, 0x742ed2e3),
+		ECC_L(0x7cd06422, 0xbd1f5bc1), ECC_L(0xfbc08769, 0xc9e7b797),
+	},
+	{
+		ECC_L(0xa242a35b, 0xb0cf664a), ECC_L(0x126e48f7, 0x7f9707e3),
+		ECC_L(0x1717bf54, 0xc6832660), ECC_L(0xfaae7332, 0xfd12c72e),
+		ECC_L(0x27b52db7, 0x995d586b), ECC_L(0xbe29569e, 0x832237c2),
+		ECC_L(0xe8e4193e, 0x2a65e7db), ECC_L(0x152706dc, 0x2eaa1bbb),
+	},
+	{
+		ECC_L(0x72bcd8b7, 0xbc60055b), ECC_L(0x03cc23ee, 0x56e27e4b),
+		ECC_L(0xee337424, 0xe4819370), ECC_L(0xe2aa0e43, 0x0ad3da09),
+		ECC_L(0x40b8524f, 0x6383c45d), ECC_L(0xd7663554, 0x42a41b25),
+		ECC_L(0x64efa6de, 0x778a4797), ECC_L(0x2042170a, 0x7079adf4),
+	},
+};
+
+/* P-384 */
+static const ecc_limb p384_p[] = {
+	ECC_L(0x00000000, 0xffffffff), ECC_L(0xffffffff, 0x00000000),
+	ECC_L(0xffffffff, 0xfffffffe), ECC_L(0xffffffff, 0xffffffff),
+	ECC_L(0xffffffff, 0xffffffff), ECC_L(0xffffffff, 0xffffffff),
+};
+
+static const ecc_limb p384_p_rr[] = {
+	ECC_L(0xfffffffe, 0x00000001), ECC_L(0x00000002, 0x00000000),
+	ECC_L(0xfffffffe, 0x00000000), ECC_L(0x00000002, 0x00000000),
+	ECC_L(0x00000000, 0x00000001), ECC_L(0x00000000, 0x00000000),
+};
+
+static const ecc_limb p384_b[] = {
+	ECC_L(0x08118871, 0x9d412dcc), ECC_L(0xf729add8, 0x7a4c32ec),
+	ECC_L(0x77f2209b, 0x1920022e), ECC_L(0xe3374bee, 0x94938ae2),
+	ECC_L(0xb62b21f4, 0x1f022094), ECC_L(0xcd08114b, 0x604fbff9),
+};
+
+static const ecc_limb p384_n[] = {
+	ECC_L(0xecec196a, 0xccc52973), ECC_L(0x581a0db2, 0x48b0a77a),
+	ECC_L(0xc7634d81, 0xf4372ddf), ECC_L(0xffffffff, 0xffffffff),
+	ECC_L(0xffffffff, 0xffffffff), ECC_L(0xffffffff, 0xffffffff),
+};
+
+static const ecc_limb p384_n_rr[] = {
+	ECC_L(0x2d319b24, 0x19b409a9), ECC_L(0xff3d81e5, 0xdf1aa419),
+	ECC_L(0xbc3e483a, 0xfcb82947), ECC_L(0xd40d4917, 0x4aab1cc5),
+	ECC_L(0x3fb05b7a, 0x28266895), ECC_L(0x0c84ee01, 0x2b39bf21),
+};
+
+/* (i + 1) * G as x, y in Montgomery form */
+static const ecc_limb p384_g_table[ECC_TABLE_SIZE][2 * 384 / ECC_LIMB_BITS] = {
+	{
+		ECC_L(0x3dd07566, 0x49c0b528), ECC_L(0x20e378e2, 0xa0d6ce38),
+		ECC_L(0x879c3afc, 0x541b4d6e), ECC_L(0x64548684, 0x59a30eff),
+		ECC_L(0x812ff723, 0x614ede2b), ECC_L(0x4d3aadc2, 0x299e1513),
+		ECC_L(0x23043dad, 0x4b03a4fe), ECC_L(0xa1bfa8bf, 0x7bb4a9ac),
+		ECC_L(0x8bade756, 0x2e83b050), ECC_L(0xc6c35219, 0x68f4ffd9),
+		ECC_L(0xdd800226, 0x3969a840), ECC_L(0x2b78abc2, 0x5a15c5e9),
+	},
+	{
+		ECC_L(0xc8229e55, 0x783dde91), ECC_L(0x8e6c8f2e, 0x022b53f0),
+		ECC_L(0x3504e6f0, 0xff9d48a1), ECC_L(0xda821495, 0xf0687f50),
+		ECC_L(0x9c90a4fd, 0x2de4b506), ECC_L(0xdb93b776, 0x427460c3),
+		ECC_L(0x42ea8463, 0x3140bfda), ECC_L(0xe8e8e4a8, 0xc2aaccd8),
+		ECC_L(0x15e4f18b, 0xdc588258), ECC_L(0x09f1fe41, 0x5172bad9),
+		ECC_L(0x070d4309, 0x00b0e684), ECC_L(0xe34947f7, 0x123df0c2),
+	},
+	{
+		ECC_L(0x05e4dbe6, 0xc1dc4073), ECC_L(0xc54ea9ff, 0xf04f779c),
+		ECC_L(0x6b2034e9, 0xa170ccf0), ECC_L(0x3a48d732, 0xd51c6c3e),
+		ECC_L(0xe36f7e2d, 0x263aa470), ECC_L(0xd283fe68, 0xe7c1c3ac),
+		ECC_L(0x7e284821, 0xc04ee157), ECC_L(0x92d789a7, 0x7ae0e36d),
+		ECC_L(0x132663c0, 0x4ef67446), ECC_L(0x68012d5a, 0xd2e1d0b4),
+		ECC_L(0xf6db68b1, 0x5102b339), ECC_L(0x465465fc, 0x983292af),
+	},
+	{
+		ECC_L(0x0aae8477, 0xebb68f2c), ECC_L(0x30594ccb, 0xee0421e3),
+		ECC_L(0x2e4f153b, 0x0aecac46), ECC_L(0x078358d4, 0x736400ad),
+		ECC_L(0xfb40f647, 0xd685d979), ECC_L(0xcfeee6dd, 0x34179228),
+		ECC_L(0x54f3e8e7, 0x9b3a03b2), ECC_L(0xe74bb7f1, 0x7bfec97e),
+		ECC_L(0x8e3e61a3, 0x4c542ad1), ECC_L(0x147162d3, 0x0418c693),
+		ECC_L(0xe607b9e3, 0x3820017d), ECC_L(0x50946875, 0x303df319),
+	},
+	{
+		ECC_L(0xbb595eba, 0x68f1f0df), ECC_L(0xc185c0cb, 0xcc873466),
+		ECC_L(0x7f1eb1b5, 0x293c703b), ECC_L(0x60db2cf5, 0xaacc05e6),
+		ECC_L(0xc676b987, 0xe2e8e4c6), ECC_L(0xe1bb26b1, 0x1d178ffb),
+		ECC_L(0x2b694ba0, 0x7073fa21), ECC_L(0x22c16e2e, 0x72f34566),
+		ECC_L(0x80b61b31, 0x01c35b99), ECC_L(0x4b237faf, 0x982c0411),
+		ECC_L(0xe6c59440, 0x24de236d), ECC_L(0x4db1c9d6, 0xe209e4a3),
+	},
+	{
+		ECC_L(0x7eb5c931, 0x7d56dad8), ECC_L(0xcb2454b3, 0x39d3413a),
+		ECC_L(0xec52930f, 0x580d57f2), ECC_L(0x2a33f666, 0x1bdf6015),
+		ECC_L(0x4f0f6a96, 0x2b02d33b), ECC_L(0xc482e189, 0xf0430c40),
+		ECC_L(0x3f62b16e, 0xa7b08203), ECC_L(0x739ac69d, 0x5b3d4dce),
+		ECC_L(0x8bd4bffc, 0xb79e33b0), ECC_L(0x93c9e5f6, 0x1b546f05),
+		ECC_L(0x586d8ede, 0xdf21559a), ECC_L(0xc9962152, 0xaf2a9eba),
+	},
+	{
+		ECC_L(0xdf13b9d1, 0x7d69222b), ECC_L(0x4ce6415f, 0x874774b1),
+		ECC_L(0x731edcf8, 0x211faa95), ECC_L(0x5f4215d1, 0x659753ed),
+		ECC_L(0xf893db58, 0x9db2df55), ECC_L(0x932c9f81, 0x1c89025b),
+		ECC_L(0x0996b220, 0x7706a61e), ECC_L(0x135349d5, 0xa8641c79),
+		ECC_L(0x65aad76f, 0x50130844), ECC_L(0x0ff37c04, 0x01fff780),
+		ECC_L(0xf57f238e, 0x693b0706), ECC_L(0xd90a16b6, 0xaf6c9b3e),
+	},
+	{
+		ECC_L(0x23f60a05, 0xdd9bcbba), ECC_L(0x9e336de5, 0xae9b587a),
+		ECC_L(0x1c5c2e71, 0x93d7e30f), ECC_L(0x1d9aebd6, 0x4f3ddb37),
+		ECC_L(0x1c7b5fe1, 0x16b66423), ECC_L(0x5db4f184, 0x349cd9b1),
+		ECC_L(0x0d2cfe83, 0xe6655a44), ECC_L(0x836dbb36, 0xb7e55e87),
+		ECC_L(0x701754bf, 0x7d8686e4), ECC_L(0xe9923263, 0xa42dbba2),
+		ECC_L(0x7008d943, 0xc48ecf0e), ECC_L(0x3c0c6dd7, 0x0d27ef61),
+	},
+	{
+		ECC_L(0x2f5d200e, 0x2353b92f), ECC_L(0xe35d8729, 0x3fd7e4f9),
+		ECC_L(0x26094833, 0xa96d745d), ECC_L(0xdc351dc1, 0x3cbfff3f),
+		ECC_L(0x26d464c6, 0xdad54d6a), ECC_L(0x5cab1d1d, 0x53636c6a),
+		ECC_L(0xf2813072, 0xb18ec0b0), ECC_L(0x3777e270, 0xd742aa2f),
+		ECC_L(0x27f061c7, 0x033ca7c2), ECC_L(0xa6ecaccc, 0x68ead0d8),
+		ECC_L(0x7d9429f4, 0xee69a754), ECC_L(0xe7706334, 0x31e8f5c6),
+	},
+	{
+		ECC_L(0x845539d3, 0xc8d99c02), ECC_L(0x2a15a9a6, 0xe58d6787),
+		ECC_L(0xe9f6368e, 0xab225fa3), ECC_L(0x54a612d7, 0xeb32cabe),
+		ECC_L(0xc2f64602, 0x5c4845ec), ECC_L(0xa91a5280, 0xdb1c212e),
+		ECC_L(0xbb971f78, 0xe67b5fce), ECC_L(0x03a530eb, 0x13b9e85c),
+		ECC_L(0x592ac0ba, 0x794eabfd), ECC_L(0x81961b8c, 0xcfd7fd1d),
+		ECC_L(0x3e03370a, 0x47a9b8aa), ECC_L(0x6eb995be, 0xc80174e8),
+	},
+	{
+		ECC_L(0xc7708b19, 0xb68b8c7d), ECC_L(0x4532077c, 0x44377aba),
+		ECC_L(0x0dcc6770, 0x6cdad64f), ECC_L(0x01b8bf56, 0x147b6602),
+		ECC_L(0xf8d89885, 0xf0561d79), ECC_L(0x9c19e9fc, 0x7ba9c437),
+		ECC_L(0x764eb146, 0xbdc4ba25), ECC_L(0x604fe46b, 0xac144b83),
+		ECC_L(0x3ce81329, 0x8a77e780), ECC_L(0x2e070f36, 0xfe9e682e),
+		ECC_L(0x41821d0c, 0x3a53287a), ECC_L(0x9aa62f9f, 0x3533f918),
+	},
+	{
+		ECC_L(0x3db84772, 0x70313de0), ECC_L(0xd4258cc5, 0x5d970420),
+		ECC_L(0x03aced26, 0xc8edfee1), ECC_L(0xf67eb422, 0x35d77d83),
+		ECC_L(0x523c40db, 0xcf9ab45c), ECC_L(0x627b415f, 0x9c35b26d),
+		ECC_L(0xfacc45e4, 0x8be55ed8), ECC_L(0x80d60af6, 0x27aa651a),
+		ECC_L(0x8c79848f, 0xd0e102ac), ECC_L(0x40c64a4e, 0x66bed5af),
+		ECC_L(0x0329eab1, 0xf7942f0e), ECC_L(0x0c6e430e, 0xf9c4af3d),
+	},
+	{
+		ECC_L(0x9b7aeb7e, 0x75ccbdfb), ECC_L(0xb25e28c5, 0xf6749a95),
+		ECC_L(0x8a7a8e46, 0x33b7d4ae), ECC_L(0xdb5203a8, 0xd9c1bd56),
+		ECC_L(0xd2657265, 0xed22df97), ECC_L(0xb51c56e1, 0x8cf23c94),
+		ECC_L(0xf4d39459, 0x6c3d812d), ECC_L(0xd8e88f1a, 0x87cae0c2),
+		ECC_L(0x789a2a48, 0xcf4d0fe3), ECC_L(0xb7feac2d, 0xfec38d60),
+		ECC_L(0x81fdbd1c, 0x3b490ec3), ECC_L(0x4617adb7, 0xcc6979e1),
+	},
+	{
+		ECC_L(0x5865e501, 0x8f75244c), ECC_L(0xd02225fb, 0x01ec909f),
+		ECC_L(0xca6b1af8, 0xb1f85c2a), ECC_L(0x44ce05ff, 0x88957166),
+		ECC_L(0x8058994c, 0x5710c0c9), ECC_L(0x46d227c4, 0x32f6b1ba),
+		ECC_L(0xbe4b4a90, 0x03cb68e5), ECC_L(0x540b8b82, 0x730a99d1),
+		ECC_L(0x1ecc8585, 0xe11dbbbf), ECC_L(0x72445345, 0xd9c3b691),
+		ECC_L(0x647d24db, 0x13690a74), ECC_L(0x4429839d, 0xdefbadf5),
+	},
+	{
+		ECC_L(0x446ad888, 0x4709f4a9), ECC_L(0x2b7210e2, 0xec3dabd8),
+		ECC_L(0x83ccf195, 0x50e07b34), ECC_L(0x59500917, 0x789b3075),
+		ECC_L(0x0fc01fd4, 0xeb085993), ECC_L(0xfb62d26f, 0x4903026b),
+		ECC_L(0x2309cc9d, 0x6fe989bb), ECC_L(0x61609cbd, 0x144bd586),
+		ECC_L(0x4b23d3a0, 0xde06610c), ECC_L(0xdddc2866, 0xd898f470),
+		ECC_L(0x8733fc41, 0x400c5797), ECC_L(0x5a68c6fe, 0xd0bc2716),
+	},
+};
+
+static const struct ecc_curve ecc_curves[] = {
+	{
+		.name = "prime256v1",
+		.bits = 256,
+		.len = 256 / ECC_LIMB_BITS,
+		.p = { p256_p, p256_p_rr, (ecc_limb)0x0000000000000001ULL },
+		.n = { p256_n, p256_n_rr, (ecc_limb)0xccd1c8aaee00bc4fULL },
+		.b = p256_b,
+		.g_table = &p256_g_table[0][0],
+	}, {
+		.name = "secp384r1",
+		.bits = 384,
+		.len = 384 / ECC_LIMB_BITS,
+		.p = { p384_p, p384_p_rr, (ecc_limb)0x0000000100000001ULL },
+		.n = { p384_n, p384_n_rr, (ecc_limb)0x6ed46089e88fdc45ULL },
+		.b = p384_b,
+		.g_table = &p384_g_table[0][0],
+	},
+};
+
+static bool ecc_is_zero(const ecc_limb *a, uint len)
+{
+	uint i;
+
+	for (i = 0; i < len; i++) {
+		if (a[i])
+			return false;
+	}
+
+	return true;
+}
+
+/* Return true if a >= b */
+static bool ecc_ge(const ecc_limb *a, const ecc_limb *b, uint len)
+{
+	int i;
+
+	for (i = len - 1; i >= 0; i--) {
+		if (a[i] != b[i])
+			return a[i] > b[i];
+	}
+
+	return true;
+}
+
+/* r = a + b, returning the carry */
+static ecc_limb ecc_add_raw(ecc_limb *r, const ecc_limb *a, const ecc_limb *b,
+			    uint len)
+{
+	ecc_dlimb acc = 0;
+	uint i;
+
+	for (i = 0; i < len; i++) {
+		acc += (ecc_dlimb)a[i] + b[i];
+		r[i] = (ecc_limb)acc;
+		acc >>= ECC_LIMB_BITS;
+	}
+
+	return acc;
+}
+
+/* r = a - b, returning the borrow */
+static ecc_limb ecc_sub_raw(ecc_limb *r, const ecc_limb *a, const ecc_limb *b,
+			    uint len)
+{
+	ecc_limb borrow = 0;
+	uint i;
+
+	for (i = 0; i < len; i++) {
+		ecc_dlimb acc = (ecc_dlimb)a[i] - b[i] - borrow;
+
+		r[i] = (ecc_limb)acc;
+		borrow = (ecc_limb)(acc >> ECC_LIMB_BITS) & 1;
+	}
+
+	return borrow;
+}
+
+/* r = a + b mod m, for a, b < m */
+static void ecc_mod_add(const struct ecc_mod *m, uint len, ecc_limb *r,
+			const ecc_limb *a, const ecc_limb *b)
+{
+	if (ecc_add_raw(r, a, b, len) || ecc_ge(r, m->m, len))
+		ecc_sub_raw(r, r, m->m, len);
+}
+
+/* r = a - b mod m, for a, b < m */
+static void ecc_mod_sub(const struct ecc_mod *m, uint len, ecc_limb *r,
+			const ecc_limb *a, const ecc_limb *b)
+{
+	if (ecc_sub_raw(r, a, b, len))
+		ecc_add_raw(r, r, m->m, len);
+}
+
+/**
+ * __ecc_mod_mul() - Montgomery multiplication
+ *
+ * Operation: r = a * b / R mod m, for a, b < m. @r may be the same as @a or
+ * @b.
+ *
+ * @m:		Modulus
+ * @len:	Number of limbs
+ * @r:		Result, < m
+ * @a:		Multiplier
+ * @b:		Multiplicand
+ */
+static __always_inline void __ecc_mod_mul(const struct ecc_mod *m, uint len,
+					  ecc_limb *r, const ecc_limb *a,
+					  const ecc_limb *b)
+{
+	ecc_limb t[ECC_MAX_LIMBS], d0;
+	ecc_dlimb acc_a, acc_b;
+	uint i, j;
+
+	memset(t, '\0', len * sizeof(ecc_limb));
+	for (j = 0; j < len; j++) {
+		acc_a = (ecc_dlimb)a[j] * b[0] + t[0];
+		d0 = (ecc_limb)acc_a * m->n0inv;
+		acc_b = (ecc_dlimb)d0 * m->m[0] + (ecc_limb)acc_a;
+		for (i = 1; i < len; i++) {
+			acc_a = (acc_a >> ECC_LIMB_BITS) +
+				(ecc_dlimb)a[j] * b[i] + t[i];
+			acc_b = (acc_b >> ECC_LIMB_BITS) +
+				(ecc_dlimb)d0 * m->m[i] + (ecc_limb)acc_a;
+			t[i - 1] = (ecc_limb)acc_b;
+		}
+		acc_a = (acc_a >> ECC_LIMB_BITS) + (acc_b >> ECC_LIMB_BITS);
+		t[len - 1] = (ecc_limb)acc_a;
+		if (acc_a >> ECC_LIMB_BITS)
+			ecc_sub_raw(t, t, m->m, len);
+	}
+	if (ecc_ge(t, m->m, len))
+		ecc_sub_raw(t, t, m->m, len);
+	memcpy(r, t, len * sizeof(ecc_limb));
+}
+
+/* Montgomery multiplication, with the loops unrolled for each curve size */
+static void ecc_mod_mul(const struct ecc_mod *m, uint len, ecc_limb *r,
+			const ecc_limb *a, const ecc_limb *b)
+{
+	if (len == 256 / ECC_LIMB_BITS)
+		__ecc_mod_mul(m, 256 / ECC_LIMB_BITS, r, a, b);
+	else
+		__ecc_mod_mul(m, 384 / ECC_LIMB_BITS, r, a, b);
+}
+
+/**
+ * ecc_mod_inv() - Modular inverse, for a prime modulus
+ *
+ * This works out a^(m - 2) with fixed 4-bit windows
+ *
+ * @m:		Modulus, which must be prime
+ * @len:	Number of limbs
+ * @r:		Result in Montgomery form
+ * @a:		Value to invert in Montgomery form, non-zero
+ */
+static void ecc_mod_inv(const struct ecc_mod *m, uint len, ecc_limb *r,
+			const ecc_limb *a)
+{
+	ecc_limb table[ECC_TABLE_SIZE][ECC_MAX_LIMBS];
+	ecc_limb exp[ECC_MAX_LIMBS], acc[ECC_MAX_LIMBS];
+	int i, j;
+	uint d;
+
+	/* the moduli are odd and well above 2, so this does not borrow */
+	memcpy(exp, m->m, len * sizeof(ecc_limb));
+	exp[0] -= 2;
+
+	memcpy(table[0], a, len * sizeof(ecc_limb));
+	for (i = 1; i < ECC_TABLE_SIZE; i++)
+		ecc_mod_mul(m, len, table[i], table[i - 1], a);
+
+	for (i = len * ECC_LIMB_BITS / ECC_WINDOW_BITS - 1; i >= 0; i--) {
+		d = exp[i * ECC_WINDOW_BITS / ECC_LIMB_BITS] >>
+			(i * ECC_WINDOW_BITS % ECC_LIMB_BITS) & ECC_TABLE_SIZE;
+		if (i == len * ECC_LIMB_BITS / ECC_WINDOW_BITS - 1) {
+			/* the top window of both group orders is 0xf */
+			memcpy(acc, table[d - 1], len * sizeof(ecc_limb));
+			continue;
+		}
+		for (j = 0; j < ECC_WINDOW_BITS; j++)
+			ecc_mod_mul(m, len, acc, acc, acc);
+		if (d)
+			ecc_mod_mul(m, len, acc, acc, table[d - 1]);
+	}
+	memcpy(r, acc, len * sizeof(ecc_limb));
+}
+
+/* r = R mod m, i.e. one in Montgomery form */
+static void ecc_mod_one(const struct ecc_mod *m, uint len, ecc_limb *r)
+{
+	memset(r, '\0', len * sizeof(ecc_limb));
+	r[0] = 1;
+	ecc_mod_mul(m, len, r, r, m->rr);
+}
+
+/* Convert a big endian byte array of up to len limbs to a limb array */
+static void ecc_from_be(ecc_limb *dst, uint len, const u8 *src, uint size)
+{
+	uint i;
+
+	memset(dst, '\0', len * sizeof(ecc_limb));
+	for (i = 0; i < size; i++)
+		dst[i / sizeof(ecc_limb)] |= (ecc_limb)src[size - 1 - i] <<
+					     (i % sizeof(ecc_limb) * 8);
+}
+
+/* Get window @i of the scalar @k */
+static uint ecc_window(const ecc_limb *k, int i)
+{
+	return k[i * ECC_WINDOW_BITS / ECC_LIMB_BITS] >>
+		(i * ECC_WINDOW_BITS % ECC_LIMB_BITS) & ECC_TABLE_SIZE;
+}
+
+/**
+ * ecc_point_double() - Double a point
+ *
+ * This uses the dbl-2001-b formulas for a = -3. The point at infinity stays
+ * where it is, since z remains zero.
+ *
+ * @c:		Curve
+ * @r:		Result, which may be the same as @a
+ * @a:		Point to double
+ */
+static void ecc_point_double(const struct ecc_curve *c, struct ecc_point *r,
+			     const struct ecc_point *a)
+{
+	const struct ecc_mod *p = &c->p;
+	ecc_limb delta[ECC_MAX_LIMBS], gamma[ECC_MAX_LIMBS];
+	ecc_limb beta[ECC_MAX_LIMBS], alpha[ECC_MAX_LIMBS];
+	ecc_limb t[ECC_MAX_LIMBS];
+	uint len = c->len;
+
+	ecc_mod_mul(p, len, delta, a->z, a->z);
+	ecc_mod_mul(p, len, gamma, a->y, a->y);
+	ecc_mod_mul(p, len, beta, a->x, gamma);
+
+	/* alpha = 3 * (x - delta) * (x + delta) */
+	ecc_mod_sub(p, len, t, a->x, delta);
+	ecc_mod_add(p, len, alpha, a->x, delta);
+	ecc_mod_mul(p, len, alpha, alpha, t);
+	ecc_mod_add(p, len, t, alpha, alpha);
+	ecc_mod_add(p, len, alpha, alpha, t);
+
+	/* z' = (y + z)^2 - gamma - delta */
+	ecc_mod_add(p, len, t, a->y, a->z);
+	ecc_mod_mul(p, len, t, t, t);
+	ecc_mod_sub(p, len, t, t, gamma);
+	ecc_mod_sub(p, len, r->z, t, delta);
+
+	/* x' = alpha^2 - 8 * beta */
+	ecc_mod_add(p, len, beta, beta, beta);
+	ecc_mod_add(p, len, beta, beta, beta);
+	ecc_mod_mul(p, len, t, alpha, alpha);
+	ecc_mod_sub(p, len, t, t, beta);
+	ecc_mod_sub(p, len, r->x, t, beta);
+
+	/* y' = alpha * (4 * beta - x') - 8 * gamma^2 */
+	ecc_mod_sub(p, len, t, beta, r->x);
+	ecc_mod_mul(p, len, t, alpha, t);
+	ecc_mod_mul(p, len, gamma, gamma, gamma);
+	ecc_mod_add(p, len, gamma, gamma, gamma);
+	ecc_mod_add(p, len, gamma, gamma, gamma);
+	ecc_mod_add(p, len, gamma, gamma, gamma);
+	ecc_mod_sub(p, len, r->y, t, gamma);
+}
+
+/**
+ * ecc_point_add() - Add two points
+ *
+ * This uses the add-2007-bl formulas, or madd-2007-bl when @b is affine,
+ * i.e. z = 1 and @b_z is NULL.
+ *
+ * @c:		Curve
+ * @r:		Result, which may be the same as @a
+ * @a:		First point
+ * @b_x:	x coordinate of the second point
+ * @b_y:	y coordinate of the second point
+ * @b_z:	z coordinate of the second point, or NULL if it is affine
+ */
+static void ecc_point_add(const struct ecc_curve *c, struct ecc_point *r,
+			  const struct ecc_point *a, const ecc_limb *b_x,
+			  const ecc_limb *b_y, const ecc_limb *b_z)
+{
+	const struct ecc_mod *p = &c->p;
+	ecc_limb u1[ECC_MAX_LIMBS], u2[ECC_MAX_LIMBS];
+	ecc_limb s1[ECC_MAX_LIMBS], s2[ECC_MAX_LIMBS];
+	ecc_limb z1z1[ECC_MAX_LIMBS], z2z2[ECC_MAX_LIMBS];
+	ecc_limb h[ECC_MAX_LIMBS], i[ECC_MAX_LIMBS], j[ECC_MAX_LIMBS];
+	uint len = c->len;
+
+	if (ecc_is_zero(a->z, len)) {
+		memcpy(r->x, b_x, len * sizeof(ecc_limb));
+		memcpy(r->y, b_y, len * sizeof(ecc_limb));
+		if (b_z)
+			memcpy(r->z, b_z, len * sizeof(ecc_limb));
+		else
+			ecc_mod_one(p, len, r->z);
+		return;
+	}
+	if (b_z && ecc_is_zero(b_z, len)) {
+		if (r != a)
+			memcpy(r, a, sizeof(*r));
+		return;
+	}
+
+	/* u1 = x1 * z2^2, s1 = y1 * z2^3 and likewise for u2, s2 */
+	ecc_mod_mul(p, len, z1z1, a->z, a->z);
+	if (b_z) {
+		ecc_mod_mul(p, len, z2z2, b_z, b_z);
+		ecc_mod_mul(p, len, u1, a->x, z2z2);
+		ecc_mod_mul(p, len, s1, b_z, z2z2);
+		ecc_mod_mul(p, len, s1, a->y, s1);
+	} else {
+		memcpy(u1, a->x, len * sizeof(ecc_limb));
+		memcpy(s1, a->y, len * sizeof(ecc_limb));
+	}
+	ecc_mod_mul(p, len, u2, b_x, z1z1);
+	ecc_mod_mul(p, len, s2, a->z, z1z1);
+	ecc_mod_mul(p, len, s2, b_y, s2);
+
+	ecc_mod_sub(p, len, h, u2, u1);
+	ecc_mod_sub(p, len, s2, s2, s1);
+	if (ecc_is_zero(h, len)) {
+		if (ecc_is_zero(s2, len)) {
+			ecc_point_double(c, r, a);
+		} else {
+			/* a = -b */
+			memset(r->z, '\0', len * sizeof(ecc_limb));
+		}
+		return;
+	}
+
+	/* i = (2 * h)^2, j = h * i, r = 2 * (s2 - s1), v = u1 * i */
+	ecc_mod_add(p, len, i, h, h);
+	ecc_mod_mul(p, len, i, i, i);
+	ecc_mod_mul(p, len, j, h, i);
+	ecc_mod_add(p, len, s2, s2, s2);
+	ecc_mod_mul(p, len, u1, u1, i);
+
+	/* z' = ((z1 + z2)^2 - z1z1 - z2z2) * h, i.e. 2 * z1 * z2 * h */
+	if (b_z) {
+		ecc_mod_add(p, len, i, a->z, b_z);
+		ecc_mod_mul(p, len, i, i, i);
+		ecc_mod_sub(p, len, i, i, z1z1);
+		ecc_mod_sub(p, len, i, i, z2z2);
+	} else {
+		ecc_mod_add(p, len, i, a->z, a->z);
+	}
+	ecc_mod_mul(p, len, r->z, i, h);
+
+	/* x' = r^2 - j - 2 * v */
+	ecc_mod_mul(p, len, i, s2, s2);
+	ecc_mod_sub(p, len, i, i, j);
+	ecc_mod_sub(p, len, i, i, u1);
+	ecc_mod_sub(p, len, r->x, i, u1);
+
+	/* y' = r * (v - x') - 2 * s1 * j */
+	ecc_mod_sub(p, len, u1, u1, r->x);
+	ecc_mod_mul(p, len, u1, s2, u1);
+	ecc_mod_mul(p, len, j, s1, j);
+	ecc_mod_add(p, len, j, j, j);
+	ecc_mod_sub(p, len, r->y, u1, j);
+}
+
+/**
+ * ecc_check_point() - check that a point is on the curve
+ *
+ * @c:		Curve
+ * @x:		x coordinate, in Montgomery form
+ * @y:		y coordinate, in Montgomery form
+ * Return: true if y^2 = x^3 - 3x + b
+ */
+static bool ecc_check_point(const struct ecc_curve *c, const ecc_limb *x,
+			    const ecc_limb *y)
+{
+	ecc_limb lhs[ECC_MAX_LIMBS], rhs[ECC_MAX_LIMBS];
+	const struct ecc_mod *p = &c->p;
+	uint len = c->len;
+
+	ecc_mod_mul(p, len, lhs, y, y);
+	ecc_mod_mul(p, len, rhs, x, x);
+	ecc_mod_mul(p, len, rhs, rhs, x);
+	ecc_mod_sub(p, len, rhs, rhs, x);
+	ecc_mod_sub(p, len, rhs, rhs, x);
+	ecc_mod_sub(p, len, rhs, rhs, x);
+	ecc_mod_add(p, len, rhs, rhs, c->b);
+
+	return !memcmp(lhs, rhs, len * sizeof(ecc_limb));
+}
+
+/**
+ * ecc_verify() - Verify an ECDSA signature
+ *
+ * @c:		Curve
+ * @key:	Public key
+ * @hash:	Hash of the signed data
+ * @hash_len:	Length of @hash in bytes
+ * @sig:	Signature as (r, s) pair, each c->bits / 8 bytes
+ * Return: 0 if the signature is valid, -EPERM if not, -EINVAL if the key is
+ *	not valid
+ */
+static int ecc_verify(const struct ecc_curve *c,
+		      const struct ecdsa_public_key *key, const u8 *hash,
+		      uint hash_len, const u8 *sig)
+{
+	ecc_limb r[ECC_MAX_LIMBS], s[ECC_MAX_LIMBS], e[ECC_MAX_LIMBS];
+	ecc_limb u1[ECC_MAX_LIMBS], u2[ECC_MAX_LIMBS], t[ECC_MAX_LIMBS];
+	struct ecc_point q_table[ECC_TABLE_SIZE], acc;
+	const struct ecc_mod *p = &c->p, *n = &c->n;
+	uint len = c->len, size = c->bits / 8;
+	const ecc_limb *g;
+	uint d;
+	int i;
+
+	ecc_from_be(r, len, sig, size);
+	ecc_from_be(s, len, sig + size, size);
+	if (ecc_is_zero(r, len) || ecc_is_zero(s, len) ||
+	    ecc_ge(r, n->m, len) || ecc_ge(s, n->m, len))
+		return -EPERM;
+
+	/* e is the leftmost bits of the hash, reduced mod n */
+	if (hash_len > size)
+		hash_len = size;
+	ecc_from_be(e, len, hash, hash_len);
+	if (ecc_ge(e, n->m, len))
+		ecc_sub_raw(e, e, n->m, len);
+
+	/* u1 = e / s mod n, u2 = r / s mod n */
+	ecc_mod_mul(n, len, t, s, n->rr);
+	ecc_mod_inv(n, len, t, t);
+	ecc_mod_mul(n, len, u1, e, t);
+	ecc_mod_mul(n, len, u2, r, t);
+
+	/* table of multiples of the public key Q */
+	ecc_from_be(q_table[0].x, len, key->x, size);
+	ecc_from_be(q_table[0].y, len, key->y, size);
+	if (ecc_ge(q_table[0].x, p->m, len) || ecc_ge(q_table[0].y, p->m, len))
+		return -EINVAL;
+	ecc_mod_mul(p, len, q_table[0].x, q_table[0].x, p->rr);
+	ecc_mod_mul(p, len, q_table[0].y, q_table[0].y, p->rr);
+	if (!ecc_check_point(c, q_table[0].x, q_table[0].y)) {
+		debug("ECDSA public key is not on curve %s\n", c->name);
+		return -EINVAL;
+	}
+	ecc_mod_one(p, len, q_table[0].z);
+	ecc_point_double(c, &q_table[1], &q_table[0]);
+	for (i = 2; i < ECC_TABLE_SIZE; i++)
+		ecc_point_add(c, &q_table[i], &q_table[i - 1], q_table[0].x,
+			      q_table[0].y, q_table[0].z);
+
+	/* acc = u1 * G + u2 * Q */
+	memset(acc.z, '\0', len * sizeof(ecc_limb));
+	for (i = c->bits / ECC_WINDOW_BITS - 1; i >= 0; i--) {
+		if (!ecc_is_zero(acc.z, len)) {
+			ecc_point_double(c, &acc, &acc);
+			ecc_point_double(c, &acc, &acc);
+			ecc_point_double(c, &acc, &acc);
+			ecc_point_double(c, &acc, &acc);
+		}
+
+		d = ecc_window(u1, i);
+		if (d) {
+			g = c->g_table + (d - 1) * 2 * len;
+			ecc_point_add(c, &acc, &acc, g, g + len, NULL);
+		}
+		d = ecc_window(u2, i);
+		if (d)
+			ecc_point_add(c, &acc, &acc, q_table[d - 1].x,
+				      q_table[d - 1].y, q_table[d - 1].z);
+	}
+	if (ecc_is_zero(acc.z, len))
+		return -EPERM;
+
+	/*
+	 * Check that x(acc) mod n = r, i.e. acc.x = r' * acc.z^2 for r' = r or,
+	 * if it is below p, r + n. This avoids an inversion.
+	 */
+	ecc_mod_mul(p, len, acc.z, acc.z, acc.z);
+	ecc_mod_mul(p, len, t, r, p->rr);
+	ecc_mod_mul(p, len, t, t, acc.z);
+	if (!memcmp(t, acc.x, len * sizeof(ecc_limb)))
+		return 0;
+	if (!ecc_add_raw(r, r, n->m, len) && !ecc_ge(r, p->m, len)) {
+		ecc_mod_mul(p, len, t, r, p->rr);
+		ecc_mod_mul(p, len, t, t, acc.z);
+		if (!memcmp(t, acc.x, len * sizeof(ecc_limb)))
+			return 0;
+	}
+
+	return -EPERM;
+}
+
+static int ecdsa_sw_verify(struct udevice *dev,
+			   const struct ecdsa_public_key *pubkey,
+			   const void *hash, size_t hash_len,
+			   const void *signature, size_t sig_len)
+{
+	const struct ecc_curve *c;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(ecc_curves); i++) {
+		c = &ecc_curves[i];
+		if (!strcmp(pubkey->curve_name, c->name))
+			break;
+	}
+	if (i == ARRAY_SIZE(ecc_curves)) {
+		debug("%s: Unsupported curve '%s'\n", __func__,
+		      pubkey->curve_name);
+		return -EOPNOTSUPP;
+	}
+
+	if (sig_len != c->bits / 8 * 2) {
+		debug("%s: Signature is of incorrect length %zu\n", __func__,
+		      sig_len);
+		return -EINVAL;
+	}
+
+	return ecc_verify(c, pubkey, hash, hash_len, signature);
+}
+
+static const struct ecdsa_ops ecdsa_sw_ops = {
+	.verify = ecdsa_sw_verify,
+};
+
+U_BOOT_DRIVER(ecdsa_sw) = {
+	.name	= "ecdsa_sw",
+	.id	= UCLASS_ECDSA,
+	.ops	= &ecdsa_sw_ops,
+	.flags	= DM_FLAG_PRE_RELOC,
+};
+
+U_BOOT_DRVINFO(ecdsa_sw) = {
+	.name = "ecdsa_sw",
+};
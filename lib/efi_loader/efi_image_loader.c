@@ -609,13 +609,13 @@ static bool efi_image_authenticate(void *efi, size_t efi_size)
 	/*
 	 * verify signature using db and dbx
 	 */
-	db = efi_sigstore_parse_sigdb(u"db");
+	db = efi_sigstore_get_sigdb(u"db");
 	if (!db) {
 		log_err("Getting signature database(db) failed\n");
 		goto out;
 	}
 
-	dbx = efi_sigstore_parse_sigdb(u"dbx");
+	dbx = efi_sigstore_get_sigdb(u"dbx");
 	if (!dbx) {
 		log_err("Getting signature database(dbx) failed\n");
 		goto out;
@@ -744,8 +744,6 @@ static bool efi_image_authenticate(void *efi, size_t efi_size)
 		ret = true;
 
 out:
-	efi_sigstore_free(db);
-	efi_sigstore_free(dbx);
 	pkcs7_free_message(msg);
 	free(regs);
 	if (new_efi != efi)
@@ -12,6 +12,7 @@
 #include <image.h>
 #include <hexdump.h>
 #include <malloc.h>
+#include <sort.h>
 #include <crypto/pkcs7.h>
 #include <crypto/pkcs7_parser.h>
 #include <crypto/public_key.h>
@@ -19,6 +20,7 @@
 #include <linux/oid_registry.h>
 #include <u-boot/hash-checksum.h>
 #include <u-boot/rsa.h>
+#include <u-boot/sha256.h>
 
 const efi_guid_t efi_guid_sha256 = EFI_CERT_SHA256_GUID;
 const efi_guid_t efi_guid_cert_rsa2048 = EFI_CERT_RSA2048_GUID;
@@ -184,6 +186,303 @@ static bool hash_algo_supported(const efi_guid_t guid)
 	return true;
 }
 
+/* Digests a certificate may be revoked by in dbx, see guid_to_sha_str() */
+static const char *const efi_revocation_algos[] = {
+	"sha256", "sha384", "sha512",
+};
+
+/**
+ * struct efi_sig_entry - an entry of a signature database lookup table
+ *
+ * @hash:	Digest the entry is looked up by
+ * @len:	Size of @hash
+ * @cert:	Parsed certificate, for EFI_CERT_X509_GUID entries only
+ */
+struct efi_sig_entry {
+	const u8 *hash;
+	int len;
+	struct x509_certificate *cert;
+};
+
+/**
+ * struct efi_sig_table - a lookup table, sorted by digest
+ *
+ * @entries:	Array of entries, all with digests of the same size
+ * @count:	Number of entries
+ */
+struct efi_sig_table {
+	struct efi_sig_entry *entries;
+	size_t count;
+};
+
+/**
+ * struct efi_sig_index - lookup tables for a signature database
+ *
+ * A signature database is sorted into these once when it is parsed, so
+ * that looking up an image digest or a certificate is a binary search
+ * rather than a walk over every entry, parsing each certificate again
+ * on the way.
+ *
+ * @digests:		SHA-256 image digests (EFI_CERT_SHA256_GUID)
+ * @certs:		Certificates (EFI_CERT_X509_GUID), by the SHA-256
+ *			digest of their TBSCertificate
+ * @revoked:		Digests of revoked TBSCertificates, one table for
+ *			each of efi_revocation_algos[]
+ * @cert_hashes:	Buffer holding the digests of @certs
+ * @unsupported_hash:	Database holds image digests of a kind which
+ *			cannot be checked
+ */
+struct efi_sig_index {
+	struct efi_sig_table digests;
+	struct efi_sig_table certs;
+	struct efi_sig_table revoked[ARRAY_SIZE(efi_revocation_algos)];
+	u8 *cert_hashes;
+	bool unsupported_hash;
+};
+
+/**
+ * efi_sig_table_of - find the lookup table an entry belongs in
+ * @index:	Lookup tables
+ * @siglist:	Signature list holding the entry
+ * @sig_data:	Entry
+ * @len:	Set to the size of the entry's digest
+ *
+ * Return:	Lookup table, or NULL if the entry is never looked up
+ */
+static struct efi_sig_table *efi_sig_table_of(struct efi_sig_index *index,
+					      struct efi_signature_store *siglist,
+					      struct efi_sig_data *sig_data,
+					      int *len)
+{
+	const char *hash_algo;
+	int i;
+
+	if (!guidcmp(&siglist->sig_type, &efi_guid_cert_x509)) {
+		*len = SHA256_SUM_LEN;
+		return &index->certs;
+	}
+
+	if (!guidcmp(&siglist->sig_type, &efi_guid_sha256) &&
+	    sig_data->size == SHA256_SUM_LEN) {
+		*len = SHA256_SUM_LEN;
+		return &index->digests;
+	}
+
+	hash_algo = guid_to_sha_str(&siglist->sig_type);
+	if (!hash_algo)
+		return NULL;
+
+	for (i = 0; i < ARRAY_SIZE(efi_revocation_algos); i++) {
+		if (strcmp(hash_algo, efi_revocation_algos[i]))
+			continue;
+
+		/*
+		 * struct efi_cert_x509_sha256 {
+		 *	u8 tbs_hash[256/8];
+		 *	time64_t revocation_time;
+		 * };
+		 */
+		*len = algo_to_len(hash_algo);
+		if (sig_data->size < *len + sizeof(time64_t))
+			return NULL;
+
+		return &index->revoked[i];
+	}
+
+	return NULL;
+}
+
+static int efi_sig_entry_cmp(const void *a, const void *b)
+{
+	const struct efi_sig_entry *ea = a, *eb = b;
+
+	return memcmp(ea->hash, eb->hash, ea->len);
+}
+
+/**
+ * efi_sig_table_find - look up a digest in a lookup table
+ * @table:	Lookup table
+ * @hash:	Digest, of the size held in @table
+ *
+ * Return:	Matching entry, or NULL if not found
+ */
+static struct efi_sig_entry *efi_sig_table_find(struct efi_sig_table *table,
+						const void *hash)
+{
+	size_t lo = 0, hi = table->count;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		struct efi_sig_entry *entry = &table->entries[mid];
+		int ret = memcmp(hash, entry->hash, entry->len);
+
+		if (!ret)
+			return entry;
+		if (ret < 0)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	return NULL;
+}
+
+/**
+ * efi_sig_table_alloc - allocate the entries of a lookup table
+ * @table:	Lookup table, with @count set to the number of entries
+ *
+ * @count is reset to zero, for the entries to be filled in.
+ *
+ * Return:	0 on success, -ENOMEM if out of memory
+ */
+static int efi_sig_table_alloc(struct efi_sig_table *table)
+{
+	size_t count = table->count;
+
+	table->count = 0;
+	if (!count)
+		return 0;
+
+	table->entries = calloc(count, sizeof(*table->entries));
+	if (!table->entries)
+		return -ENOMEM;
+
+	return 0;
+}
+
+static void efi_sig_table_sort(struct efi_sig_table *table)
+{
+	qsort(table->entries, table->count, sizeof(*table->entries),
+	      efi_sig_entry_cmp);
+}
+
+/**
+ * efi_sigstore_free_index - free the lookup tables of a signature store
+ * @index:	Lookup tables, may be NULL
+ */
+static void efi_sigstore_free_index(struct efi_sig_index *index)
+{
+	size_t i;
+
+	if (!index)
+		return;
+
+	for (i = 0; index->certs.entries && i < index->certs.count; i++)
+		x509_free_certificate(index->certs.entries[i].cert);
+	free(index->certs.entries);
+	free(index->digests.entries);
+	for (i = 0; i < ARRAY_SIZE(index->revoked); i++)
+		free(index->revoked[i].entries);
+	free(index->cert_hashes);
+	free(index);
+}
+
+/**
+ * efi_sigstore_build_index - build the lookup tables of a signature store
+ * @sigstore:	Signature store
+ *
+ * Sort the entries of all the signature lists in @sigstore into lookup
+ * tables held in its first entry. The certificates are parsed here, once,
+ * and kept for verifying signers against.
+ *
+ * Return:	0 on success, -ve on error
+ */
+static int efi_sigstore_build_index(struct efi_signature_store *sigstore)
+{
+	struct efi_signature_store *siglist;
+	struct efi_sig_data *sig_data;
+	struct efi_sig_index *index;
+	struct efi_sig_table *table;
+	struct efi_sig_entry *entry;
+	struct x509_certificate *cert;
+	struct image_region reg[1];
+	const char *hash_algo;
+	void *hash;
+	u8 *cert_hash;
+	int i, len;
+
+	index = calloc(1, sizeof(*index));
+	if (!index)
+		return -ENOMEM;
+	sigstore->index = index;
+
+	/* Size the tables */
+	for (siglist = sigstore; siglist; siglist = siglist->next) {
+		if (!hash_algo_supported(siglist->sig_type))
+			index->unsupported_hash = true;
+
+		for (sig_data = siglist->sig_data_list; sig_data;
+		     sig_data = sig_data->next) {
+			table = efi_sig_table_of(index, siglist, sig_data,
+						 &len);
+			if (table)
+				table->count++;
+		}
+	}
+
+	if (index->certs.count) {
+		index->cert_hashes = calloc(index->certs.count,
+					    SHA256_SUM_LEN);
+		if (!index->cert_hashes)
+			return -ENOMEM;
+	}
+	if (efi_sig_table_alloc(&index->digests) ||
+	    efi_sig_table_alloc(&index->certs))
+		return -ENOMEM;
+	for (i = 0; i < ARRAY_SIZE(index->revoked); i++) {
+		if (efi_sig_table_alloc(&index->revoked[i]))
+			return -ENOMEM;
+	}
+
+	/* Fill them in */
+	hash_algo = guid_to_sha_str(&efi_guid_sha256);
+	cert_hash = index->cert_hashes;
+	for (siglist = sigstore; siglist; siglist = siglist->next) {
+		for (sig_data = siglist->sig_data_list; sig_data;
+		     sig_data = sig_data->next) {
+			table = efi_sig_table_of(index, siglist, sig_data,
+						 &len);
+			if (!table)
+				continue;
+
+			entry = &table->entries[table->count];
+			entry->len = len;
+			if (table != &index->certs) {
+				entry->hash = sig_data->data;
+				table->count++;
+				continue;
+			}
+
+			cert = x509_cert_parse(sig_data->data, sig_data->size);
+			if (IS_ERR_OR_NULL(cert)) {
+				EFI_PRINT("Cannot parse x509 certificate\n");
+				continue;
+			}
+
+			/* identify the certificate by its TBSCertificate */
+			reg[0].data = cert->tbs;
+			reg[0].size = cert->tbs_size;
+			hash = cert_hash;
+			if (!efi_hash_regions(reg, 1, &hash, hash_algo, NULL)) {
+				x509_free_certificate(cert);
+				return -EINVAL;
+			}
+
+			entry->hash = cert_hash;
+			entry->cert = cert;
+			cert_hash += SHA256_SUM_LEN;
+			table->count++;
+		}
+	}
+
+	efi_sig_table_sort(&index->digests);
+	efi_sig_table_sort(&index->certs);
+	for (i = 0; i < ARRAY_SIZE(index->revoked); i++)
+		efi_sig_table_sort(&index->revoked[i]);
+
+	return 0;
+}
+
 /**
  * efi_signature_lookup_digest - search for an image's digest in sigdb
  * @regs:	List of regions to be authenticated
@@ -191,8 +490,7 @@ static bool hash_algo_supported(const efi_guid_t guid)
  * @dbx		Caller needs to set this to true if he is searching dbx
  *
  * A message digest of image pointed to by @regs is calculated and
- * its hash value is compared to entries in signature database pointed
- * to by @db.
+ * looked up in the digests of signature database pointed to by @db.
  *
  * Return:	true if found, false if not
  */
@@ -201,67 +499,41 @@ bool efi_signature_lookup_digest(struct efi_image_regions *regs,
 				 bool dbx)
 
 {
-	struct efi_signature_store *siglist;
-	struct efi_sig_data *sig_data;
+	struct efi_sig_index *index;
 	void *hash = NULL;
 	bool found = false;
-	bool hash_done = false;
 
 	EFI_PRINT("%s: Enter, %p, %p\n", __func__, regs, db);
 
-	if (!regs || !db || !db->sig_data_list)
+	if (!regs || !db || !db->index)
 		goto out;
+	index = db->index;
 
-	for (siglist = db; siglist; siglist = siglist->next) {
-		int len = 0;
-		const char *hash_algo = NULL;
-		/*
-		 * if the hash algorithm is unsupported and we get an entry in
-		 * dbx reject the image
-		 */
-		if (dbx && !hash_algo_supported(siglist->sig_type)) {
-			found = true;
-			continue;
-		};
-		/*
-		 * Only support sha256 for now, that's what
-		 * hash-to-efi-sig-list produces
-		 */
-		if (guidcmp(&siglist->sig_type, &efi_guid_sha256))
-			continue;
-
-		hash_algo = guid_to_sha_str(&efi_guid_sha256);
-		/*
-		 * We could check size and hash_algo but efi_hash_regions()
-		 * will do that for us
-		 */
-		if (!hash_done &&
-		    !efi_hash_regions(regs->reg, regs->num, &hash, hash_algo,
-				      &len)) {
-			EFI_PRINT("Digesting an image failed\n");
-			break;
-		}
-		hash_done = true;
+	/*
+	 * if the hash algorithm is unsupported and we get an entry in
+	 * dbx reject the image
+	 */
+	if (dbx && index->unsupported_hash) {
+		found = true;
+		goto out;
+	}
 
-		for (sig_data = siglist->sig_data_list; sig_data;
-		     sig_data = sig_data->next) {
-#ifdef DEBUG
-			EFI_PRINT("Msg digest in database:\n");
-			print_hex_dump("    ", DUMP_PREFIX_OFFSET, 16, 1,
-				       sig_data->data, sig_data->size, false);
-#endif
-			if (sig_data->size == len &&
-			    !memcmp(sig_data->data, hash, len)) {
-				found = true;
-				free(hash);
-				goto out;
-			}
-		}
+	/*
+	 * Only support sha256 for now, that's what
+	 * hash-to-efi-sig-list produces
+	 */
+	if (!index->digests.count)
+		goto out;
 
-		free(hash);
-		hash = NULL;
+	if (!efi_hash_regions(regs->reg, regs->num, &hash,
+			      guid_to_sha_str(&efi_guid_sha256), NULL)) {
+		EFI_PRINT("Digesting an image failed\n");
+		goto out;
 	}
 
+	found = efi_sig_table_find(&index->digests, hash);
+	free(hash);
+
 out:
 	EFI_PRINT("%s: Exit, found: %d\n", __func__, found);
 	return found;
@@ -280,17 +552,13 @@ out:
 static bool efi_lookup_certificate(struct x509_certificate *cert,
 				   struct efi_signature_store *db)
 {
-	struct efi_signature_store *siglist;
-	struct efi_sig_data *sig_data;
 	struct image_region reg[1];
-	void *hash = NULL, *hash_tmp = NULL;
-	int len = 0;
+	void *hash = NULL;
 	bool found = false;
-	const char *hash_algo = NULL;
 
 	EFI_PRINT("%s: Enter, %p, %p\n", __func__, cert, db);
 
-	if (!cert || !db || !db->sig_data_list)
+	if (!cert || !db || !db->index || !db->index->certs.count)
 		goto out;
 
 	/*
@@ -300,47 +568,15 @@ static bool efi_lookup_certificate(struct x509_certificate *cert,
 	/* calculate hash of TBSCertificate */
 	reg[0].data = cert->tbs;
 	reg[0].size = cert->tbs_size;
-
-	/* We just need any sha256 algo to start the matching */
-	hash_algo = guid_to_sha_str(&efi_guid_sha256);
-	if (!efi_hash_regions(reg, 1, &hash, hash_algo, &len))
+	if (!efi_hash_regions(reg, 1, &hash, guid_to_sha_str(&efi_guid_sha256),
+			      NULL))
 		goto out;
 
 	EFI_PRINT("%s: searching for %s\n", __func__, cert->subject);
-	for (siglist = db; siglist; siglist = siglist->next) {
-		/* only with x509 certificate */
-		if (guidcmp(&siglist->sig_type, &efi_guid_cert_x509))
-			continue;
-
-		for (sig_data = siglist->sig_data_list; sig_data;
-		     sig_data = sig_data->next) {
-			struct x509_certificate *cert_tmp;
-
-			cert_tmp = x509_cert_parse(sig_data->data,
-						   sig_data->size);
-			if (IS_ERR_OR_NULL(cert_tmp))
-				continue;
-
-			EFI_PRINT("%s: against %s\n", __func__,
-				  cert_tmp->subject);
-			reg[0].data = cert_tmp->tbs;
-			reg[0].size = cert_tmp->tbs_size;
-			if (!efi_hash_regions(reg, 1, &hash_tmp, hash_algo,
-					      NULL))
-				goto out;
-
-			x509_free_certificate(cert_tmp);
-
-			if (!memcmp(hash, hash_tmp, len)) {
-				found = true;
-				goto out;
-			}
-		}
-	}
-out:
+	found = efi_sig_table_find(&db->index->certs, hash);
 	free(hash);
-	free(hash_tmp);
 
+out:
 	EFI_PRINT("%s: Exit, found: %d\n", __func__, found);
 	return found;
 }
@@ -349,7 +585,7 @@ out:
  * efi_verify_certificate - verify certificate's signature with database
  * @signer:	Certificate
  * @db:		Signature database
- * @root:	Certificate to verify @signer
+ * @root:	Certificate to verify @signer, still owned by @db
  *
  * Determine if certificate pointed to by @signer may be verified
  * by one of certificates in signature database pointed to by @db.
@@ -360,41 +596,26 @@ static bool efi_verify_certificate(struct x509_certificate *signer,
 				   struct efi_signature_store *db,
 				   struct x509_certificate **root)
 {
-	struct efi_signature_store *siglist;
-	struct efi_sig_data *sig_data;
+	struct efi_sig_table *certs;
 	struct x509_certificate *cert;
 	bool verified = false;
+	size_t i;
 	int ret;
 
 	EFI_PRINT("%s: Enter, %p, %p\n", __func__, signer, db);
 
-	if (!signer || !db || !db->sig_data_list)
+	if (!signer || !db || !db->index)
 		goto out;
 
-	for (siglist = db; siglist; siglist = siglist->next) {
-		/* only with x509 certificate */
-		if (guidcmp(&siglist->sig_type, &efi_guid_cert_x509))
-			continue;
-
-		for (sig_data = siglist->sig_data_list; sig_data;
-		     sig_data = sig_data->next) {
-			cert = x509_cert_parse(sig_data->data, sig_data->size);
-			if (IS_ERR_OR_NULL(cert)) {
-				EFI_PRINT("Cannot parse x509 certificate\n");
-				continue;
-			}
-
-			ret = public_key_verify_signature(cert->pub,
-							  signer->sig);
-			if (!ret) {
-				verified = true;
-				if (root)
-					*root = cert;
-				else
-					x509_free_certificate(cert);
-				goto out;
-			}
-			x509_free_certificate(cert);
+	certs = &db->index->certs;
+	for (i = 0; i < certs->count; i++) {
+		cert = certs->entries[i].cert;
+		ret = public_key_verify_signature(cert->pub, signer->sig);
+		if (!ret) {
+			verified = true;
+			if (root)
+				*root = cert;
+			goto out;
 		}
 	}
 
@@ -422,66 +643,48 @@ static bool efi_signature_check_revocation(struct pkcs7_signed_info *sinfo,
 					   struct x509_certificate *cert,
 					   struct efi_signature_store *dbx)
 {
-	struct efi_signature_store *siglist;
-	struct efi_sig_data *sig_data;
+	struct efi_sig_index *index;
+	struct efi_sig_entry *entry;
 	struct image_region reg[1];
 	void *hash = NULL;
-	int len = 0;
 	time64_t revoc_time;
 	bool revoked = false;
-	const char *hash_algo = NULL;
+	int i;
 
 	EFI_PRINT("%s: Enter, %p, %p, %p\n", __func__, sinfo, cert, dbx);
 
-	if (!sinfo || !cert || !dbx || !dbx->sig_data_list)
+	if (!sinfo || !cert || !dbx || !dbx->index)
 		goto out;
+	index = dbx->index;
 
 	EFI_PRINT("Checking revocation against %s\n", cert->subject);
-	for (siglist = dbx; siglist; siglist = siglist->next) {
-		hash_algo = guid_to_sha_str(&siglist->sig_type);
-		if (!hash_algo)
+	reg[0].data = cert->tbs;
+	reg[0].size = cert->tbs_size;
+	for (i = 0; i < ARRAY_SIZE(index->revoked); i++) {
+		if (!index->revoked[i].count)
 			continue;
 
 		/* calculate hash of TBSCertificate */
-		reg[0].data = cert->tbs;
-		reg[0].size = cert->tbs_size;
-		if (!efi_hash_regions(reg, 1, &hash, hash_algo, &len))
+		if (!efi_hash_regions(reg, 1, &hash, efi_revocation_algos[i],
+				      NULL))
 			goto out;
 
-		for (sig_data = siglist->sig_data_list; sig_data;
-		     sig_data = sig_data->next) {
-			/*
-			 * struct efi_cert_x509_sha256 {
-			 *	u8 tbs_hash[256/8];
-			 *	time64_t revocation_time;
-			 * };
-			 */
-#ifdef DEBUG
-			if (sig_data->size >= len) {
-				EFI_PRINT("hash in db:\n");
-				print_hex_dump("    ", DUMP_PREFIX_OFFSET,
-					       16, 1,
-					       sig_data->data, len, false);
-			}
-#endif
-			if ((sig_data->size < len + sizeof(time64_t)) ||
-			    memcmp(sig_data->data, hash, len))
-				continue;
-
-			memcpy(&revoc_time, sig_data->data + len,
-			       sizeof(revoc_time));
-			EFI_PRINT("revocation time: 0x%llx\n", revoc_time);
-			/*
-			 * TODO: compare signing timestamp in sinfo
-			 * with revocation time
-			 */
-
-			revoked = true;
-			free(hash);
-			goto out;
-		}
+		entry = efi_sig_table_find(&index->revoked[i], hash);
 		free(hash);
 		hash = NULL;
+		if (!entry)
+			continue;
+
+		memcpy(&revoc_time, entry->hash + entry->len,
+		       sizeof(revoc_time));
+		EFI_PRINT("revocation time: 0x%llx\n", revoc_time);
+		/*
+		 * TODO: compare signing timestamp in sinfo
+		 * with revocation time
+		 */
+
+		revoked = true;
+		break;
 	}
 out:
 	EFI_PRINT("%s: Exit, revoked: %d\n", __func__, revoked);
@@ -553,12 +756,7 @@ bool efi_signature_verify(struct efi_image_regions *regs,
 				break;
 		if (!signer->self_signed &&
 		    efi_verify_certificate(signer, db, &root)) {
-			bool check;
-
-			check = efi_signature_check_revocation(sinfo, root,
-							       dbx);
-			x509_free_certificate(root);
-			if (check)
+			if (efi_signature_check_revocation(sinfo, root, dbx))
 				break;
 		}
 
@@ -619,6 +817,7 @@ void efi_sigstore_free(struct efi_signature_store *sigstore)
 
 	while (sigstore) {
 		sigstore_next = sigstore->next;
+		efi_sigstore_free_index(sigstore->index);
 
 		sig_data = sigstore->sig_data_list;
 		while (sig_data) {
@@ -786,6 +985,11 @@ struct efi_signature_store *efi_build_signature_store(void *sig_list,
 		size -= esl->signature_list_size;
 		esl = (void *)esl + esl->signature_list_size;
 	}
+
+	if (sigstore && efi_sigstore_build_index(sigstore)) {
+		EFI_PRINT("Indexing of signature database failed\n");
+		goto err;
+	}
 	free(sig_list);
 
 	return sigstore;
@@ -821,3 +1025,59 @@ struct efi_signature_store *efi_sigstore_parse_sigdb(u16 *name)
 
 	return efi_build_signature_store(db, db_size);
 }
+
+/* db and dbx, kept from one image authentication to the next */
+static u16 *const efi_sigdb_names[] = { u"db", u"dbx" };
+static struct efi_signature_store *efi_sigdb_cache[ARRAY_SIZE(efi_sigdb_names)];
+
+/**
+ * efi_sigstore_get_sigdb - get the signature store of db or dbx
+ * @name:	Variable's name, u"db" or u"dbx"
+ *
+ * Parse the signature database variable pointed to by @name on first use
+ * and keep it, with its lookup tables, until the variable is written and
+ * efi_sigstore_invalidate() drops it. The store must not be freed by the
+ * caller.
+ *
+ * Return:	Pointer to signature store on success, NULL on error
+ */
+struct efi_signature_store *efi_sigstore_get_sigdb(u16 *name)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(efi_sigdb_names); i++) {
+		if (u16_strcmp(name, efi_sigdb_names[i]))
+			continue;
+
+		if (!efi_sigdb_cache[i])
+			efi_sigdb_cache[i] = efi_sigstore_parse_sigdb(name);
+
+		return efi_sigdb_cache[i];
+	}
+
+	return NULL;
+}
+
+/**
+ * efi_sigstore_invalidate - drop a kept signature store
+ * @name:	Name of the variable written
+ * @vendor:	Vendor GUID of the variable written
+ *
+ * Called whenever a variable is written, so that a changed db or dbx is
+ * parsed again by the next efi_sigstore_get_sigdb().
+ */
+void efi_sigstore_invalidate(const u16 *name, const efi_guid_t *vendor)
+{
+	int i;
+
+	if (guidcmp(vendor, &efi_guid_image_security_database))
+		return;
+
+	for (i = 0; i < ARRAY_SIZE(efi_sigdb_names); i++) {
+		if (u16_strcmp(name, efi_sigdb_names[i]))
+			continue;
+
+		efi_sigstore_free(efi_sigdb_cache[i]);
+		efi_sigdb_cache[i] = NULL;
+	}
+}
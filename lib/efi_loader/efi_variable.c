@@ -391,6 +391,9 @@ efi_status_t efi_set_variable_int(const u16 *variable_name,
 
 	efi_var_mem_del(var);
 
+	if (IS_ENABLED(CONFIG_EFI_SECURE_BOOT))
+		efi_sigstore_invalidate(variable_name, vendor);
+
 	if (var_type == EFI_AUTH_VAR_PK)
 		ret = efi_init_secure_state();
 	else
@@ -859,6 +859,9 @@ efi_status_t efi_set_variable_int(const u16 *variable_name,
 	if (alt_ret != EFI_SUCCESS)
 		goto out;
 
+	if (IS_ENABLED(CONFIG_EFI_SECURE_BOOT))
+		efi_sigstore_invalidate(variable_name, vendor);
+
 	if (!u16_strcmp(variable_name, pk))
 		alt_ret = efi_init_secure_state();
 out:
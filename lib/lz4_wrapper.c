@@ -5,8 +5,11 @@
 
 #include <compiler.h>
 #include <image.h>
+#include <malloc.h>
+#include <linux/bitops.h>
 #include <linux/kernel.h>
 #include <linux/types.h>
+#include <linux/xxhash.h>
 #include <asm/unaligned.h>
 #include <u-boot/lz4.h>
 
@@ -15,94 +18,559 @@
 
 #define LZ4F_BLOCKUNCOMPRESSED_FLAG 0x80000000U
 
+#define LZ4F_MAGIC_SKIPPABLE		0x184d2a50
+#define LZ4F_MAGIC_SKIPPABLE_MASK	0xfffffff0
+
+/* Frame descriptor: FLG byte */
+#define LZ4F_FLG_VERSION_MASK	GENMASK(7, 6)
+#define LZ4F_FLG_VERSION	(1 << 6)
+#define LZ4F_FLG_INDEP_BLOCKS	BIT(5)
+#define LZ4F_FLG_BLOCK_CSUM	BIT(4)
+#define LZ4F_FLG_CONTENT_SIZE	BIT(3)
+#define LZ4F_FLG_CONTENT_CSUM	BIT(2)
+#define LZ4F_FLG_RESERVED	BIT(1)
+#define LZ4F_FLG_DICT_ID	BIT(0)
+
+/* Frame descriptor: BD byte */
+#define LZ4F_BD_RESERVED	0x8f
+#define LZ4F_BD_BLOCK_MAX(bd)	(1U << (2 * (((bd) >> 4) & 7) + 8))
+
+/* Largest frame descriptor: FLG, BD, content size, dictionary ID and HC */
+#define LZ4F_DESC_MAX		(3 + sizeof(u64) + sizeof(u32))
+
+/**
+ * struct lz4f_frame - Information from an LZ4 frame descriptor
+ *
+ * @flags: FLG byte (LZ4F_FLG_...)
+ * @block_max: Maximum size of a block in bytes
+ * @content_size: Size of the decompressed data, if LZ4F_FLG_CONTENT_SIZE
+ */
+struct lz4f_frame {
+	u8 flags;
+	u32 block_max;
+	u64 content_size;
+};
+
+/* Get the size of a frame descriptor from its first (FLG) byte */
+__rcode static uint lz4f_desc_len(u8 flags)
+{
+	uint len = 3;
+
+	if (flags & LZ4F_FLG_CONTENT_SIZE)
+		len += sizeof(u64);
+	if (flags & LZ4F_FLG_DICT_ID)
+		len += sizeof(u32);
+
+	return len;
+}
+
+/* Check a frame descriptor of lz4f_desc_len() bytes and decode it */
+__rcode static int lz4f_parse_desc(const u8 *desc, struct lz4f_frame *frame)
+{
+	u8 flags = desc[0], bd = desc[1];
+	uint len = lz4f_desc_len(flags);
+
+	if ((flags & LZ4F_FLG_VERSION_MASK) != LZ4F_FLG_VERSION)
+		return -EPROTONOSUPPORT;	/* unknown format */
+	if ((flags & LZ4F_FLG_RESERVED) || (bd & LZ4F_BD_RESERVED))
+		return -EINVAL;	/* reserved bits must be zero */
+	if (flags & LZ4F_FLG_DICT_ID)
+		return -EPROTONOSUPPORT;	/* no way to supply a dictionary */
+	if (((bd >> 4) & 7) < 4)
+		return -EINVAL;	/* invalid block maximum size */
+	if (CONFIG_IS_ENABLED(LZ4_CHECKSUM) &&
+	    desc[len - 1] != ((xxh32(desc, len - 1, 0) >> 8) & 0xff))
+		return -EBADMSG;
+
+	frame->flags = flags;
+	frame->block_max = LZ4F_BD_BLOCK_MAX(bd);
+	frame->content_size = 0;
+	if (flags & LZ4F_FLG_CONTENT_SIZE)
+		frame->content_size = get_unaligned_le64(desc + 2);
+
+	return 0;
+}
+
+/*
+ * Decompress a block to @out, where @prefix is the start of the data that
+ * matches may refer back to. Returns the number of bytes written, or -ve on
+ * error
+ */
+__rcode static int lz4f_decode_block(const void *in, u32 block_header,
+				     void *out, const void *end,
+				     const void *prefix)
+{
+	u32 block_size = block_header & ~LZ4F_BLOCKUNCOMPRESSED_FLAG;
+	int ret;
+
+	if (block_header & LZ4F_BLOCKUNCOMPRESSED_FLAG) {
+		if (block_size > end - out)
+			return -ENOBUFS;	/* output overrun */
+		memcpy(out, in, block_size);
+
+		return block_size;
+	}
+
+	/* constant folding essential, do not touch params! */
+	ret = LZ4_decompress_generic(in, out, block_size, end - out,
+				     endOnInputSize, decode_full_block, noDict,
+				     prefix, NULL, 0);
+	if (ret < 0)
+		return -EPROTO;	/* decompression error */
+
+	return ret;
+}
+
 __rcode int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
 {
 	const void *end = dst + *dstn;
 	const void *in = src;
 	void *out = dst;
-	int has_block_checksum;
+	uint frames;
 	int ret;
+
 	*dstn = 0;
 
-	{ /* With in-place decompression the header may become invalid later. */
+	for (frames = 0;; frames++) {
+		size_t left = srcn - (in - src);
+		struct lz4f_frame frame;
+		void *frame_out = out;
 		u32 magic;
-		u8 flags, version, independent_blocks, has_content_size;
-		u8 block_desc;
-
-		if (srcn < sizeof(u32) + 3*sizeof(u8))
-			return -EINVAL;	/* input overrun */
 
+		/* Once there is one frame, stop at anything that is not */
+		if (left < sizeof(u32)) {
+			ret = frames ? 0 : -EINVAL;	/* input overrun */
+			break;
+		}
 		magic = get_unaligned_le32(in);
-		in += sizeof(u32);
-		flags = *(u8 *)in;
-		in += sizeof(u8);
-		block_desc = *(u8 *)in;
-		in += sizeof(u8);
-
-		version = (flags >> 6) & 0x3;
-		independent_blocks = (flags >> 5) & 0x1;
-		has_block_checksum = (flags >> 4) & 0x1;
-		has_content_size = (flags >> 3) & 0x1;
-
-		/* We assume there's always only a single, standard frame. */
-		if (magic != LZ4F_MAGIC || version != 1)
-			return -EPROTONOSUPPORT;	/* unknown format */
-		if ((flags & 0x03) || (block_desc & 0x8f))
-			return -EINVAL;	/* reserved bits must be zero */
-		if (!independent_blocks)
-			return -EPROTONOSUPPORT; /* we can't support this yet */
-
-		if (has_content_size) {
-			if (srcn < sizeof(u32) + 3*sizeof(u8) + sizeof(u64))
-				return -EINVAL;	/* input overrun */
-			in += sizeof(u64);
+		if ((magic & LZ4F_MAGIC_SKIPPABLE_MASK) ==
+		    LZ4F_MAGIC_SKIPPABLE) {
+			if (left < 2 * sizeof(u32) ||
+			    get_unaligned_le32(in + 4) > left - 2 * sizeof(u32)) {
+				ret = -EINVAL;	/* input overrun */
+				break;
+			}
+			in += 2 * sizeof(u32) + get_unaligned_le32(in + 4);
+			continue;
+		}
+		if (magic != LZ4F_MAGIC) {
+			ret = frames ? 0 : -EPROTONOSUPPORT;
+			break;
 		}
-		/* Header checksum byte */
-		in += sizeof(u8);
-	}
-
-	while (1) {
-		u32 block_header, block_size;
-
-		block_header = get_unaligned_le32(in);
 		in += sizeof(u32);
-		block_size = block_header & ~LZ4F_BLOCKUNCOMPRESSED_FLAG;
+		left -= sizeof(u32);
 
-		if (in - src + block_size > srcn) {
-			ret = -EINVAL;		/* input overrun */
+		/* With in-place decompression the header may become invalid later. */
+		if (left < 3 || left < lz4f_desc_len(*(u8 *)in)) {
+			ret = -EINVAL;	/* input overrun */
 			break;
 		}
-
-		if (!block_size) {
-			ret = 0;	/* decompression successful */
+		ret = lz4f_parse_desc(in, &frame);
+		if (ret)
+			break;
+		in += lz4f_desc_len(frame.flags);
+		if ((frame.flags & LZ4F_FLG_CONTENT_SIZE) &&
+		    frame.content_size > end - out) {
+			ret = -ENOBUFS;	/* output overrun */
 			break;
 		}
 
-		if (block_header & LZ4F_BLOCKUNCOMPRESSED_FLAG) {
-			size_t size = min((ptrdiff_t)block_size, (ptrdiff_t)(end - out));
-			memcpy(out, in, size);
-			out += size;
-			if (size < block_size) {
-				ret = -ENOBUFS;	/* output overrun */
+		while (1) {
+			u32 block_header, block_size;
+			uint csum_size = 0;
+
+			if (frame.flags & LZ4F_FLG_BLOCK_CSUM)
+				csum_size = sizeof(u32);
+			if (in - src + sizeof(u32) > srcn) {
+				ret = -EINVAL;	/* input overrun */
+				break;
+			}
+			block_header = get_unaligned_le32(in);
+			in += sizeof(u32);
+			block_size = block_header & ~LZ4F_BLOCKUNCOMPRESSED_FLAG;
+
+			if (!block_size)
+				break;	/* end of frame */
+
+			if (block_size > frame.block_max ||
+			    in - src + block_size + csum_size > srcn) {
+				ret = -EINVAL;	/* input overrun */
 				break;
 			}
-		} else {
-			/* constant folding essential, do not touch params! */
-			ret = LZ4_decompress_generic(in, out, block_size,
-					end - out, endOnInputSize,
-					decode_full_block, noDict, out, NULL, 0);
-			if (ret < 0) {
-				ret = -EPROTO;	/* decompression error */
+			if (CONFIG_IS_ENABLED(LZ4_CHECKSUM) && csum_size &&
+			    xxh32(in, block_size, 0) !=
+			    get_unaligned_le32(in + block_size)) {
+				ret = -EBADMSG;
 				break;
 			}
+
+			/* linked blocks may refer back to earlier blocks */
+			ret = lz4f_decode_block(in, block_header, out, end,
+						frame.flags & LZ4F_FLG_INDEP_BLOCKS ?
+						out : frame_out);
+			if (ret < 0)
+				break;
 			out += ret;
+			in += block_size + csum_size;
 		}
+		if (ret < 0)
+			break;
 
-		in += block_size;
-		if (has_block_checksum)
+		if (frame.flags & LZ4F_FLG_CONTENT_CSUM) {
+			if (in - src + sizeof(u32) > srcn) {
+				ret = -EINVAL;	/* input overrun */
+				break;
+			}
+			if (CONFIG_IS_ENABLED(LZ4_CHECKSUM) &&
+			    xxh32(frame_out, out - frame_out, 0) !=
+			    get_unaligned_le32(in)) {
+				ret = -EBADMSG;
+				break;
+			}
 			in += sizeof(u32);
+		}
+		if ((frame.flags & LZ4F_FLG_CONTENT_SIZE) &&
+		    out - frame_out != frame.content_size) {
+			ret = -EINVAL;	/* wrong size */
+			break;
+		}
 	}
 
 	*dstn = out - dst;
 	return ret;
 }
+
+int ulz4f_content_size(const void *src, size_t srcn, u64 *sizep)
+{
+	struct lz4f_frame frame;
+	int ret;
+
+	if (srcn < sizeof(u32) + 3)
+		return -EINVAL;
+	if (get_unaligned_le32(src) != LZ4F_MAGIC)
+		return -EPROTONOSUPPORT;
+	src += sizeof(u32);
+	if (srcn - sizeof(u32) < lz4f_desc_len(*(u8 *)src))
+		return -EINVAL;
+	ret = lz4f_parse_desc(src, &frame);
+	if (ret)
+		return ret;
+	if (!(frame.flags & LZ4F_FLG_CONTENT_SIZE))
+		return -ENOENT;
+	*sizep = frame.content_size;
+
+	return 0;
+}
+
+/* States for struct ulz4f_stream, in the order they normally occur */
+enum ulz4f_state {
+	ULZ4F_MAGIC,		/* magic number of the next frame */
+	ULZ4F_DESC,		/* frame descriptor */
+	ULZ4F_BLOCK_HEADER,	/* block size */
+	ULZ4F_BLOCK,		/* block data */
+	ULZ4F_BLOCK_CSUM,	/* block checksum */
+	ULZ4F_CONTENT_CSUM,	/* content checksum, after the end mark */
+	ULZ4F_SKIP_SIZE,	/* size of a skippable frame */
+	ULZ4F_SKIP,		/* data of a skippable frame */
+	ULZ4F_DONE,		/* trailing data, which is ignored */
+};
+
+/**
+ * struct ulz4f_stream - State for decompressing LZ4 frames in pieces
+ *
+ * @dst: Output buffer
+ * @dst_size: Size of output buffer in bytes
+ * @out_len: Number of bytes written to @dst so far
+ * @frame_start: Offset in @dst of the current frame's output, which linked
+ *	blocks may refer back to
+ * @frames: Number of complete frames seen, including skippable frames
+ * @state: Current state (enum ulz4f_state)
+ * @frame: Descriptor of the current frame
+ * @tmp: Holds small fields until they are complete
+ * @tmp_len: Number of bytes in @tmp
+ * @block_header: Header of the current block
+ * @left: Bytes left in the current block or skippable frame
+ * @block: Buffer holding a compressed block which arrives in pieces
+ * @block_alloc: Size of @block in bytes
+ * @block_len: Number of bytes in @block
+ * @block_csum: Checksum of the current block
+ * @content_csum: Checksum of the current frame's output
+ */
+struct ulz4f_stream {
+	void *dst;
+	size_t dst_size;
+	size_t out_len;
+	size_t frame_start;
+	uint frames;
+	enum ulz4f_state state;
+	struct lz4f_frame frame;
+	u8 tmp[LZ4F_DESC_MAX];
+	uint tmp_len;
+	u32 block_header;
+	u32 left;
+	u8 *block;
+	u32 block_alloc;
+	u32 block_len;
+	struct xxh32_state block_csum;
+	struct xxh32_state content_csum;
+};
+
+int ulz4f_stream_new(void *dst, size_t dst_size, struct ulz4f_stream **strmp)
+{
+	struct ulz4f_stream *strm;
+
+	strm = calloc(1, sizeof(*strm));
+	if (!strm)
+		return -ENOMEM;
+	strm->dst = dst;
+	strm->dst_size = dst_size;
+	*strmp = strm;
+
+	return 0;
+}
+
+/*
+ * Collect bytes into strm->tmp until there are @need of them, returning true
+ * once they are all there. The caller must then reset strm->tmp_len
+ */
+static bool ulz4f_gather(struct ulz4f_stream *strm, const u8 **inp,
+			 size_t *lenp, uint need)
+{
+	uint count = min_t(size_t, need - min(need, strm->tmp_len), *lenp);
+
+	memcpy(strm->tmp + strm->tmp_len, *inp, count);
+	strm->tmp_len += count;
+	*inp += count;
+	*lenp -= count;
+
+	return strm->tmp_len >= need;
+}
+
+/*
+ * Decompress a block, or part of an uncompressed block, which is also hashed
+ * if needed
+ */
+static int ulz4f_block(struct ulz4f_stream *strm, const u8 *in,
+		       u32 block_header)
+{
+	u32 size = block_header & ~LZ4F_BLOCKUNCOMPRESSED_FLAG;
+	void *out = strm->dst + strm->out_len;
+	int ret;
+
+	if (CONFIG_IS_ENABLED(LZ4_CHECKSUM) &&
+	    (strm->frame.flags & LZ4F_FLG_BLOCK_CSUM))
+		xxh32_update(&strm->block_csum, in, size);
+
+	ret = lz4f_decode_block(in, block_header, out,
+				strm->dst + strm->dst_size,
+				strm->frame.flags & LZ4F_FLG_INDEP_BLOCKS ?
+				out : strm->dst + strm->frame_start);
+	if (ret < 0) {
+		/* a block can only be too big if there is not room for one */
+		if (strm->dst_size - strm->out_len < strm->frame.block_max)
+			return -ENOSPC;
+		return ret == -ENOBUFS ? -ENOSPC : ret;
+	}
+	if (CONFIG_IS_ENABLED(LZ4_CHECKSUM) &&
+	    (strm->frame.flags & LZ4F_FLG_CONTENT_CSUM))
+		xxh32_update(&strm->content_csum, out, ret);
+	strm->out_len += ret;
+
+	return 0;
+}
+
+/* Handle the data of the current block, returning the number of bytes used */
+static int ulz4f_block_data(struct ulz4f_stream *strm, const u8 *in,
+			    size_t len)
+{
+	u32 count = min_t(size_t, strm->left, len);
+	int ret;
+
+	if (strm->block_header & LZ4F_BLOCKUNCOMPRESSED_FLAG) {
+		/* uncompressed data can go straight to the output */
+		if (count > strm->dst_size - strm->out_len)
+			return -ENOSPC;
+		ret = ulz4f_block(strm, in, count | LZ4F_BLOCKUNCOMPRESSED_FLAG);
+	} else if (!strm->block_len && count == strm->left) {
+		/* the whole block is here, so there is no need to copy it */
+		ret = ulz4f_block(strm, in, strm->block_header);
+	} else {
+		/* at the start of a block, strm->left is its size */
+		if (!strm->block_len && strm->block_alloc < strm->left) {
+			free(strm->block);
+			strm->block_alloc = 0;
+			strm->block = malloc(strm->left);
+			if (!strm->block)
+				return -ENOMEM;
+			strm->block_alloc = strm->left;
+		}
+		memcpy(strm->block + strm->block_len, in, count);
+		strm->block_len += count;
+		ret = 0;
+		if (count == strm->left) {
+			ret = ulz4f_block(strm, strm->block,
+					  strm->block_header);
+			strm->block_len = 0;
+		}
+	}
+	if (ret)
+		return ret;
+	strm->left -= count;
+
+	return count;
+}
+
+static int ulz4f_check_csum(struct xxh32_state *csum, const u8 *expect)
+{
+	if (CONFIG_IS_ENABLED(LZ4_CHECKSUM) &&
+	    xxh32_digest(csum) != get_unaligned_le32(expect))
+		return -EBADMSG;
+
+	return 0;
+}
+
+static int ulz4f_end_frame(struct ulz4f_stream *strm)
+{
+	if ((strm->frame.flags & LZ4F_FLG_CONTENT_SIZE) &&
+	    strm->out_len - strm->frame_start != strm->frame.content_size)
+		return -EINVAL;
+	strm->frames++;
+	strm->state = ULZ4F_MAGIC;
+
+	return 0;
+}
+
+int ulz4f_stream_feed(struct ulz4f_stream *strm, const void *src, size_t srcn,
+		      size_t *dstn)
+{
+	const u8 *in = src;
+	u32 magic, size;
+	int ret = 0;
+
+	while (srcn && !ret) {
+		switch (strm->state) {
+		case ULZ4F_MAGIC:
+			if (!ulz4f_gather(strm, &in, &srcn, sizeof(u32)))
+				break;
+			strm->tmp_len = 0;
+			magic = get_unaligned_le32(strm->tmp);
+			if (magic == LZ4F_MAGIC)
+				strm->state = ULZ4F_DESC;
+			else if ((magic & LZ4F_MAGIC_SKIPPABLE_MASK) ==
+				 LZ4F_MAGIC_SKIPPABLE)
+				strm->state = ULZ4F_SKIP_SIZE;
+			else if (strm->frames)
+				strm->state = ULZ4F_DONE;
+			else
+				ret = -EPROTONOSUPPORT;
+			break;
+		case ULZ4F_DESC:
+			/* the first byte gives the size of the rest */
+			if (!ulz4f_gather(strm, &in, &srcn, 1) ||
+			    !ulz4f_gather(strm, &in, &srcn,
+					  lz4f_desc_len(strm->tmp[0])))
+				break;
+			strm->tmp_len = 0;
+			ret = lz4f_parse_desc(strm->tmp, &strm->frame);
+			if (ret)
+				break;
+			if ((strm->frame.flags & LZ4F_FLG_CONTENT_SIZE) &&
+			    strm->frame.content_size >
+			    strm->dst_size - strm->out_len) {
+				ret = -ENOSPC;
+				break;
+			}
+			strm->frame_start = strm->out_len;
+			xxh32_reset(&strm->content_csum, 0);
+			strm->state = ULZ4F_BLOCK_HEADER;
+			break;
+		case ULZ4F_BLOCK_HEADER:
+			if (!ulz4f_gather(strm, &in, &srcn, sizeof(u32)))
+				break;
+			strm->tmp_len = 0;
+			strm->block_header = get_unaligned_le32(strm->tmp);
+			size = strm->block_header & ~LZ4F_BLOCKUNCOMPRESSED_FLAG;
+			if (!size) {
+				if (strm->frame.flags & LZ4F_FLG_CONTENT_CSUM)
+					strm->state = ULZ4F_CONTENT_CSUM;
+				else
+					ret = ulz4f_end_frame(strm);
+				break;
+			}
+			if (size > strm->frame.block_max) {
+				ret = -EINVAL;
+				break;
+			}
+			strm->left = size;
+			xxh32_reset(&strm->block_csum, 0);
+			strm->state = ULZ4F_BLOCK;
+			break;
+		case ULZ4F_BLOCK:
+			ret = ulz4f_block_data(strm, in, srcn);
+			if (ret < 0)
+				break;
+			in += ret;
+			srcn -= ret;
+			ret = 0;
+			if (strm->left)
+				break;
+			if (strm->frame.flags & LZ4F_FLG_BLOCK_CSUM)
+				strm->state = ULZ4F_BLOCK_CSUM;
+			else
+				strm->state = ULZ4F_BLOCK_HEADER;
+			break;
+		case ULZ4F_BLOCK_CSUM:
+			if (!ulz4f_gather(strm, &in, &srcn, sizeof(u32)))
+				break;
+			strm->tmp_len = 0;
+			ret = ulz4f_check_csum(&strm->block_csum, strm->tmp);
+			strm->state = ULZ4F_BLOCK_HEADER;
+			break;
+		case ULZ4F_CONTENT_CSUM:
+			if (!ulz4f_gather(strm, &in, &srcn, sizeof(u32)))
+				break;
+			strm->tmp_len = 0;
+			ret = ulz4f_check_csum(&strm->content_csum, strm->tmp);
+			if (!ret)
+				ret = ulz4f_end_frame(strm);
+			break;
+		case ULZ4F_SKIP_SIZE:
+			if (!ulz4f_gather(strm, &in, &srcn, sizeof(u32)))
+				break;
+			strm->tmp_len = 0;
+			strm->left = get_unaligned_le32(strm->tmp);
+			strm->state = ULZ4F_SKIP;
+			fallthrough;
+		case ULZ4F_SKIP:
+			size = min_t(size_t, strm->left, srcn);
+			in += size;
+			srcn -= size;
+			strm->left -= size;
+			if (!strm->left) {
+				strm->frames++;
+				strm->state = ULZ4F_MAGIC;
+			}
+			break;
+		case ULZ4F_DONE:
+			srcn = 0;
+			break;
+		}
+	}
+	*dstn = strm->out_len;
+
+	return ret;
+}
+
+bool ulz4f_stream_ended(struct ulz4f_stream *strm)
+{
+	return strm->state == ULZ4F_DONE ||
+		(strm->state == ULZ4F_MAGIC && strm->frames);
+}
+
+void ulz4f_stream_free(struct ulz4f_stream *strm)
+{
+	if (strm) {
+		free(strm->block);
+		free(strm);
+	}
+}
@@ -438,6 +438,10 @@ static int MY_FAST_CALL LzmaDec_DecodeReal(CLzmaDec *p, SizeT limit, const Byte
   return SZ_OK;
 }
 
+#if CONFIG_IS_ENABLED(LZMA_FAST)
+#include "LzmaDecFast.c"
+#endif
+
 static void MY_FAST_CALL LzmaDec_WriteRem(CLzmaDec *p, SizeT limit)
 {
   if (p->remainLen != 0 && p->remainLen < kMatchSpecLenStart)
@@ -475,6 +479,13 @@ static int MY_FAST_CALL LzmaDec_DecodeReal2(CLzmaDec *p, SizeT limit, const Byte
       if (limit - p->dicPos > rem)
         limit2 = p->dicPos + rem;
     }
+#if CONFIG_IS_ENABLED(LZMA_FAST)
+    if (lzma_fast_enable)
+    {
+      RINOK(LzmaDec_DecodeRealFast(p, limit2, bufLimit));
+    }
+    else
+#endif
     RINOK(LzmaDec_DecodeReal(p, limit2, bufLimit));
     if (p->processedPos >= p->prop.dicSize)
       p->checkDicSize = p->prop.dicSize;
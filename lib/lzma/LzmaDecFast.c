@@ -0,0 +1,381 @@
+/* LzmaDecFast.c -- speed-optimised LZMA decoder loop
+   Based on LzmaDec.c 2009-09-20 : Igor Pavlov : Public domain */
+
+/* U-Boot: this is included from LzmaDec.c when CONFIG_LZMA_FAST is set */
+
+/*
+LzmaDec_DecodeRealFast() is LzmaDec_DecodeReal() with the hot paths reworked
+for speed at the cost of code size:
+
+- Literal bits are decoded without branching on the value of the bit, since
+  they are the hardest to predict. The new range and code are selected with
+  a mask and both probability updates reduce to one subtraction (see
+  RC_BIT_NB below).
+
+- The 8-bit literal and matched-literal trees and the 3-bit low and mid
+  length trees are fully unrolled.
+
+- Matches are copied 8 bytes at a time when the distance allows it, and
+  runs of a single byte are filled with memset().
+
+The range coder itself is unchanged, including its byte-wise normalisation,
+so the output is identical to LzmaDec_DecodeReal().
+*/
+
+int lzma_fast_enable = 1;
+
+/*
+Decode a bit without a branch on its value, leaving mask set to all ones for
+a 1 bit and 0 for a 0 bit. For a 0 bit the usual update
+
+  ttt + ((kBitModelTotal - ttt) >> kNumMoveBits)
+
+is equal to
+
+  ttt - ((int)(ttt - kBitModelTotal + (1 << kNumMoveBits) - 1) >> kNumMoveBits)
+
+with an arithmetic shift, so it has the same form as the update for a 1 bit,
+ttt - (ttt >> kNumMoveBits).
+*/
+#define kNbBias (kBitModelTotal - (1 << kNumMoveBits) + 1)
+
+#define RC_BIT_NB(p, mask) \
+  ttt = *(p); NORMALIZE; bound = (range >> kNumBitModelTotalBits) * ttt; \
+  mask = (UInt32)0 - (UInt32)(code >= bound); \
+  range = (bound & ~mask) | ((range - bound) & mask); \
+  code -= bound & mask; \
+  *(p) = (CLzmaProb)(ttt - ((int)(ttt - (kNbBias & ~mask)) >> kNumMoveBits));
+
+#define GET_BIT_NB(p, i) { UInt32 mask; RC_BIT_NB(p, mask); i = (i + i) - mask; }
+
+#define MATCHED_BIT_NB(i) \
+  { UInt32 mask; unsigned bit; CLzmaProb *probLit; \
+  matchByte <<= 1; bit = (matchByte & offs); \
+  probLit = prob + offs + bit + i; \
+  RC_BIT_NB(probLit, mask); \
+  offs &= bit ^ ~mask; i = (i + i) - mask; }
+
+#define TREE_3_DECODE(probs, i) \
+  { i = 1; \
+  TREE_GET_BIT(probs, i); \
+  TREE_GET_BIT(probs, i); \
+  TREE_GET_BIT(probs, i); \
+  i -= 8; }
+
+#define kCopyChunk 8
+
+static int MY_FAST_CALL LzmaDec_DecodeRealFast(CLzmaDec *p, SizeT limit, const Byte *bufLimit)
+{
+  CLzmaProb *probs = p->probs;
+
+  unsigned state = p->state;
+  UInt32 rep0 = p->reps[0], rep1 = p->reps[1], rep2 = p->reps[2], rep3 = p->reps[3];
+  unsigned pbMask = ((unsigned)1 << (p->prop.pb)) - 1;
+  unsigned lpMask = ((unsigned)1 << (p->prop.lp)) - 1;
+  unsigned lc = p->prop.lc;
+
+  Byte *dic = p->dic;
+  SizeT dicBufSize = p->dicBufSize;
+  SizeT dicPos = p->dicPos;
+
+  UInt32 processedPos = p->processedPos;
+  UInt32 checkDicSize = p->checkDicSize;
+  unsigned len = 0;
+
+  const Byte *buf = p->buf;
+  UInt32 range = p->range;
+  UInt32 code = p->code;
+  unsigned int loop = 0;
+
+  do
+  {
+    CLzmaProb *prob;
+    UInt32 bound;
+    unsigned ttt;
+    unsigned posState = processedPos & pbMask;
+
+    if (!(loop++ & 1023))
+	    schedule();
+
+    prob = probs + IsMatch + (state << kNumPosBitsMax) + posState;
+    IF_BIT_0(prob)
+    {
+      unsigned symbol;
+      UPDATE_0(prob);
+      prob = probs + Literal;
+      if (checkDicSize != 0 || processedPos != 0)
+        prob += (LZMA_LIT_SIZE * (((processedPos & lpMask) << lc) +
+        (dic[(dicPos == 0 ? dicBufSize : dicPos) - 1] >> (8 - lc))));
+
+      symbol = 1;
+      if (state < kNumLitStates)
+      {
+        state -= (state < 4) ? state : 3;
+        GET_BIT_NB(prob + symbol, symbol);
+        GET_BIT_NB(prob + symbol, symbol);
+        GET_BIT_NB(prob + symbol, symbol);
+        GET_BIT_NB(prob + symbol, symbol);
+        GET_BIT_NB(prob + symbol, symbol);
+        GET_BIT_NB(prob + symbol, symbol);
+        GET_BIT_NB(prob + symbol, symbol);
+        GET_BIT_NB(prob + symbol, symbol);
+      }
+      else
+      {
+        unsigned matchByte = p->dic[(dicPos - rep0) + ((dicPos < rep0) ? dicBufSize : 0)];
+        unsigned offs = 0x100;
+        state -= (state < 10) ? 3 : 6;
+        MATCHED_BIT_NB(symbol);
+        MATCHED_BIT_NB(symbol);
+        MATCHED_BIT_NB(symbol);
+        MATCHED_BIT_NB(symbol);
+        MATCHED_BIT_NB(symbol);
+        MATCHED_BIT_NB(symbol);
+        MATCHED_BIT_NB(symbol);
+        MATCHED_BIT_NB(symbol);
+      }
+      dic[dicPos++] = (Byte)symbol;
+      processedPos++;
+      continue;
+    }
+    else
+    {
+      UPDATE_1(prob);
+      prob = probs + IsRep + state;
+      IF_BIT_0(prob)
+      {
+        UPDATE_0(prob);
+        state += kNumStates;
+        prob = probs + LenCoder;
+      }
+      else
+      {
+        UPDATE_1(prob);
+        if (checkDicSize == 0 && processedPos == 0)
+          return SZ_ERROR_DATA;
+        prob = probs + IsRepG0 + state;
+        IF_BIT_0(prob)
+        {
+          UPDATE_0(prob);
+          prob = probs + IsRep0Long + (state << kNumPosBitsMax) + posState;
+          IF_BIT_0(prob)
+          {
+            UPDATE_0(prob);
+            dic[dicPos] = dic[(dicPos - rep0) + ((dicPos < rep0) ? dicBufSize : 0)];
+            dicPos++;
+            processedPos++;
+            state = state < kNumLitStates ? 9 : 11;
+            continue;
+          }
+          UPDATE_1(prob);
+        }
+        else
+        {
+          UInt32 distance;
+          UPDATE_1(prob);
+          prob = probs + IsRepG1 + state;
+          IF_BIT_0(prob)
+          {
+            UPDATE_0(prob);
+            distance = rep1;
+          }
+          else
+          {
+            UPDATE_1(prob);
+            prob = probs + IsRepG2 + state;
+            IF_BIT_0(prob)
+            {
+              UPDATE_0(prob);
+              distance = rep2;
+            }
+            else
+            {
+              UPDATE_1(prob);
+              distance = rep3;
+              rep3 = rep2;
+            }
+            rep2 = rep1;
+          }
+          rep1 = rep0;
+          rep0 = distance;
+        }
+        state = state < kNumLitStates ? 8 : 11;
+        prob = probs + RepLenCoder;
+      }
+      {
+        CLzmaProb *probLen = prob + LenChoice;
+        IF_BIT_0(probLen)
+        {
+          UPDATE_0(probLen);
+          probLen = prob + LenLow + (posState << kLenNumLowBits);
+          TREE_3_DECODE(probLen, len);
+        }
+        else
+        {
+          UPDATE_1(probLen);
+          probLen = prob + LenChoice2;
+          IF_BIT_0(probLen)
+          {
+            UPDATE_0(probLen);
+            probLen = prob + LenMid + (posState << kLenNumMidBits);
+            TREE_3_DECODE(probLen, len);
+            len += kLenNumLowSymbols;
+          }
+          else
+          {
+            UPDATE_1(probLen);
+            probLen = prob + LenHigh;
+            TREE_DECODE(probLen, (1 << kLenNumHighBits), len);
+            len += kLenNumLowSymbols + kLenNumMidSymbols;
+          }
+        }
+      }
+
+      if (state >= kNumStates)
+      {
+        UInt32 distance;
+        prob = probs + PosSlot +
+            ((len < kNumLenToPosStates ? len : kNumLenToPosStates - 1) << kNumPosSlotBits);
+        TREE_6_DECODE(prob, distance);
+        if (distance >= kStartPosModelIndex)
+        {
+          unsigned posSlot = (unsigned)distance;
+          int numDirectBits = (int)(((distance >> 1) - 1));
+          distance = (2 | (distance & 1));
+          if (posSlot < kEndPosModelIndex)
+          {
+            distance <<= numDirectBits;
+            prob = probs + SpecPos + distance - posSlot - 1;
+            {
+              UInt32 mask = 1;
+              unsigned i = 1;
+
+              do
+              {
+                GET_BIT2(prob + i, i, ; , distance |= mask);
+                mask <<= 1;
+              }
+              while (--numDirectBits != 0);
+            }
+          }
+          else
+          {
+            numDirectBits -= kNumAlignBits;
+
+            do
+            {
+              NORMALIZE
+              range >>= 1;
+
+              {
+                UInt32 t;
+                code -= range;
+                t = (0 - ((UInt32)code >> 31)); /* (UInt32)((Int32)code >> 31) */
+                distance = (distance << 1) + (t + 1);
+                code += range & t;
+              }
+            }
+            while (--numDirectBits != 0);
+            prob = probs + Align;
+            distance <<= kNumAlignBits;
+            {
+              unsigned i = 1;
+              GET_BIT2(prob + i, i, ; , distance |= 1);
+              GET_BIT2(prob + i, i, ; , distance |= 2);
+              GET_BIT2(prob + i, i, ; , distance |= 4);
+              GET_BIT2(prob + i, i, ; , distance |= 8);
+            }
+            if (distance == (UInt32)0xFFFFFFFF)
+            {
+              len += kMatchSpecLenStart;
+              state -= kNumStates;
+              break;
+            }
+          }
+        }
+        rep3 = rep2;
+        rep2 = rep1;
+        rep1 = rep0;
+        rep0 = distance + 1;
+        if (checkDicSize == 0)
+        {
+          if (distance >= processedPos)
+            return SZ_ERROR_DATA;
+        }
+        else if (distance >= checkDicSize)
+          return SZ_ERROR_DATA;
+        state = (state < kNumStates + kNumLitStates) ? kNumLitStates : kNumLitStates + 3;
+      }
+
+      len += kMatchMinLen;
+
+      if (limit == dicPos)
+        return SZ_ERROR_DATA;
+      {
+        SizeT rem = limit - dicPos;
+        unsigned curLen = ((rem < len) ? (unsigned)rem : len);
+        SizeT pos = (dicPos - rep0) + ((dicPos < rep0) ? dicBufSize : 0);
+
+        processedPos += curLen;
+
+        len -= curLen;
+        if (pos + curLen <= dicBufSize)
+        {
+          Byte *dest = dic + dicPos;
+          ptrdiff_t src = (ptrdiff_t)pos - (ptrdiff_t)dicPos;
+          const Byte *lim = dest + curLen;
+          dicPos += curLen;
+
+          if (src == -1)
+          {
+            memset(dest, dest[-1], curLen);
+            continue;
+          }
+          /* whole chunks never overlap the data they are copied from */
+          if (src <= -kCopyChunk || src >= kCopyChunk)
+          {
+            while (lim - dest >= kCopyChunk)
+            {
+              memcpy(dest, dest + src, kCopyChunk);
+              dest += kCopyChunk;
+            }
+            if (dest == lim)
+              continue;
+          }
+          do
+            *(dest) = (Byte)*(dest + src);
+          while (++dest != lim);
+        }
+        else
+        {
+
+          do
+          {
+            dic[dicPos++] = dic[pos];
+            if (++pos == dicBufSize)
+              pos = 0;
+          }
+          while (--curLen != 0);
+        }
+      }
+    }
+  }
+  while (dicPos < limit && buf < bufLimit);
+
+  schedule();
+
+  NORMALIZE;
+  p->buf = buf;
+  p->range = range;
+  p->code = code;
+  p->remainLen = len;
+  p->dicPos = dicPos;
+  p->processedPos = processedPos;
+  p->reps[0] = rep0;
+  p->reps[1] = rep1;
+  p->reps[2] = rep2;
+  p->reps[3] = rep3;
+  p->state = state;
+
+  return SZ_OK;
+}
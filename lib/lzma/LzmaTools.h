@@ -28,4 +28,7 @@
 int lzmaBuffToBuffDecompress(unsigned char *outStream, SizeT *uncompressedSize,
 			     const unsigned char *inStream, SizeT length);
 
+/* Set to 0 to use the reference decoder loop (CONFIG_LZMA_FAST) */
+extern int lzma_fast_enable;
+
 #endif
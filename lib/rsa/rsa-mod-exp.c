@@ -6,6 +6,8 @@
 #ifndef USE_HOSTCC
 #include <fdtdec.h>
 #include <log.h>
+#include <malloc.h>
+#include <asm/global_data.h>
 #include <asm/types.h>
 #include <asm/byteorder.h>
 #include <linux/errno.h>
@@ -19,6 +21,10 @@
 #include <u-boot/rsa.h>
 #include <u-boot/rsa-mod-exp.h>
 
+#ifndef USE_HOSTCC
+DECLARE_GLOBAL_DATA_PTR;
+#endif
+
 #define UINT64_MULT32(v, multby)  (((uint64_t)(v)) * ((uint32_t)(multby)))
 
 #define get_unaligned_be32(a) fdt32_to_cpu(*(uint32_t *)a)
@@ -35,33 +41,79 @@ static inline uint64_t fdt64_to_cpup(const void *p)
 /* Default public exponent for backward compatibility */
 #define RSA_DEFAULT_PUBEXP	65537
 
+/*
+ * The software modular exponentiation works on native machine words. Where
+ * the compiler has a 128-bit type (64-bit targets, where the product is a
+ * mul/umulh pair on arm64) each Montgomery multiplication needs a quarter of
+ * the multiplies of the 32-bit version.
+ */
+#ifdef __SIZEOF_INT128__
+typedef uint64_t bn_limb;
+typedef unsigned __int128 bn_dlimb;
+#else
+typedef uint32_t bn_limb;
+typedef uint64_t bn_dlimb;
+#endif
+
+#define BN_LIMB_BITS	(sizeof(bn_limb) * 8)
+#define BN_MAX_LIMBS	(RSA_MAX_KEY_BITS / BN_LIMB_BITS)
+
+/* Number of keys kept in prepared form, for reuse by later verifications */
+#define RSA_KEY_CACHE_SIZE	4
+
+/* Largest window used for exponentiation, which bounds the stack use */
+#define RSA_MAX_WINDOW_BITS	4
+
 /**
- * subtract_modulus() - subtract modulus from the given value
+ * struct rsa_mont_key - RSA public key prepared for Montgomery arithmetic
+ *
+ * @num_bits:	Key length in bits
+ * @len:	Length of @modulus and @rr in limbs
+ * @n0inv:	-1 / modulus[0] mod 2^BN_LIMB_BITS
+ * @modulus:	Modulus as little endian limb array
+ * @rr:		R^2 mod modulus as little endian limb array, where R is
+ *		2^(len * BN_LIMB_BITS)
+ * @raw:	Modulus as given in the key, to match the key on later use
+ */
+struct rsa_mont_key {
+	uint num_bits;
+	uint len;
+	bn_limb n0inv;
+	bn_limb modulus[BN_MAX_LIMBS];
+	bn_limb rr[BN_MAX_LIMBS];
+	uint8_t raw[RSA_MAX_KEY_BITS / 8];
+};
+
+static struct rsa_mont_key *rsa_key_cache[RSA_KEY_CACHE_SIZE];
+static uint rsa_key_cache_next;
+
+/**
+ * bn_sub_modulus() - subtract modulus from the given value
  *
  * @key:	Key containing modulus to subtract
- * @num:	Number to subtract modulus from, as little endian word array
+ * @num:	Number to subtract modulus from, as little endian limb array
  */
-static void subtract_modulus(const struct rsa_public_key *key, uint32_t num[])
+static void bn_sub_modulus(const struct rsa_mont_key *key, bn_limb num[])
 {
-	int64_t acc = 0;
+	bn_limb borrow = 0;
 	uint i;
 
 	for (i = 0; i < key->len; i++) {
-		acc += (uint64_t)num[i] - key->modulus[i];
-		num[i] = (uint32_t)acc;
-		acc >>= 32;
+		bn_dlimb acc = (bn_dlimb)num[i] - key->modulus[i] - borrow;
+
+		num[i] = (bn_limb)acc;
+		borrow = (bn_limb)(acc >> BN_LIMB_BITS) & 1;
 	}
 }
 
 /**
- * greater_equal_modulus() - check if a value is >= modulus
+ * bn_ge_modulus() - check if a value is >= modulus
  *
  * @key:	Key containing modulus to check
- * @num:	Number to check against modulus, as little endian word array
+ * @num:	Number to check against modulus, as little endian limb array
  * Return: 0 if num < modulus, 1 if num >= modulus
  */
-static int greater_equal_modulus(const struct rsa_public_key *key,
-				 uint32_t num[])
+static int bn_ge_modulus(const struct rsa_mont_key *key, const bn_limb num[])
 {
 	int i;
 
@@ -76,239 +128,511 @@ static int greater_equal_modulus(const struct rsa_public_key *key,
 }
 
 /**
- * montgomery_mul_add_step() - Perform montgomery multiply-add step
+ * bn_mont_mul_add_step() - Perform montgomery multiply-add step
  *
- * Operation: montgomery result[] += a * b[] / n0inv % modulus
+ * Operation: montgomery result[] += a * b[] / R % modulus
  *
- * @key:	RSA key
- * @result:	Place to put result, as little endian word array
+ * @key:	Prepared RSA key
+ * @result:	Place to put result, as little endian limb array
  * @a:		Multiplier
- * @b:		Multiplicand, as little endian word array
+ * @b:		Multiplicand, as little endian limb array
  */
-static void montgomery_mul_add_step(const struct rsa_public_key *key,
-		uint32_t result[], const uint32_t a, const uint32_t b[])
+static void bn_mont_mul_add_step(const struct rsa_mont_key *key,
+				 bn_limb result[], bn_limb a, const bn_limb b[])
 {
-	uint64_t acc_a, acc_b;
-	uint32_t d0;
+	bn_dlimb acc_a, acc_b;
+	bn_limb d0;
 	uint i;
 
-	acc_a = (uint64_t)a * b[0] + result[0];
-	d0 = (uint32_t)acc_a * key->n0inv;
-	acc_b = (uint64_t)d0 * key->modulus[0] + (uint32_t)acc_a;
+	acc_a = (bn_dlimb)a * b[0] + result[0];
+	d0 = (bn_limb)acc_a * key->n0inv;
+	acc_b = (bn_dlimb)d0 * key->modulus[0] + (bn_limb)acc_a;
 	for (i = 1; i < key->len; i++) {
-		acc_a = (acc_a >> 32) + (uint64_t)a * b[i] + result[i];
-		acc_b = (acc_b >> 32) + (uint64_t)d0 * key->modulus[i] +
-				(uint32_t)acc_a;
-		result[i - 1] = (uint32_t)acc_b;
+		acc_a = (acc_a >> BN_LIMB_BITS) + (bn_dlimb)a * b[i] +
+			result[i];
+		acc_b = (acc_b >> BN_LIMB_BITS) +
+			(bn_dlimb)d0 * key->modulus[i] + (bn_limb)acc_a;
+		result[i - 1] = (bn_limb)acc_b;
 	}
 
-	acc_a = (acc_a >> 32) + (acc_b >> 32);
+	acc_a = (acc_a >> BN_LIMB_BITS) + (acc_b >> BN_LIMB_BITS);
 
-	result[i - 1] = (uint32_t)acc_a;
+	result[i - 1] = (bn_limb)acc_a;
 
-	if (acc_a >> 32)
-		subtract_modulus(key, result);
+	if (acc_a >> BN_LIMB_BITS)
+		bn_sub_modulus(key, result);
 }
 
 /**
- * montgomery_mul() - Perform montgomery mutitply
+ * bn_mont_mul() - Perform montgomery multiply
  *
- * Operation: montgomery result[] = a[] * b[] / n0inv % modulus
+ * Operation: montgomery result[] = a[] * b[] / R % modulus
  *
- * @key:	RSA key
- * @result:	Place to put result, as little endian word array
- * @a:		Multiplier, as little endian word array
- * @b:		Multiplicand, as little endian word array
+ * @key:	Prepared RSA key
+ * @result:	Place to put result, as little endian limb array, which must
+ *		not overlap @a or @b
+ * @a:		Multiplier, as little endian limb array
+ * @b:		Multiplicand, as little endian limb array
  */
-static void montgomery_mul(const struct rsa_public_key *key,
-		uint32_t result[], uint32_t a[], const uint32_t b[])
+static void bn_mont_mul(const struct rsa_mont_key *key, bn_limb result[],
+			const bn_limb a[], const bn_limb b[])
 {
 	uint i;
 
 	for (i = 0; i < key->len; ++i)
 		result[i] = 0;
 	for (i = 0; i < key->len; ++i)
-		montgomery_mul_add_step(key, result, a[i], b);
+		bn_mont_mul_add_step(key, result, a[i], b);
 }
 
 /**
- * num_pub_exponent_bits() - Number of bits in the public exponent
+ * bn_mod_double() - double a value modulo the modulus
  *
- * @key:	RSA key
- * @num_bits:	Storage for the number of public exponent bits
+ * @key:	Prepared RSA key
+ * @num:	Number to double, as little endian limb array, < modulus
  */
-static int num_public_exponent_bits(const struct rsa_public_key *key,
-		int *num_bits)
+static void bn_mod_double(const struct rsa_mont_key *key, bn_limb num[])
 {
-	uint64_t exponent;
-	int exponent_bits;
-	const uint max_bits = (sizeof(exponent) * 8);
-
-	exponent = key->exponent;
-	exponent_bits = 0;
+	bn_limb carry = 0, top;
+	uint i;
 
-	if (!exponent) {
-		*num_bits = exponent_bits;
-		return 0;
+	for (i = 0; i < key->len; i++) {
+		top = num[i] >> (BN_LIMB_BITS - 1);
+		num[i] = num[i] << 1 | carry;
+		carry = top;
 	}
+	if (carry || bn_ge_modulus(key, num))
+		bn_sub_modulus(key, num);
+}
 
-	for (exponent_bits = 1; exponent_bits < max_bits + 1; ++exponent_bits)
-		if (!(exponent >>= 1)) {
-			*num_bits = exponent_bits;
-			return 0;
-		}
+/**
+ * bn_from_be() - convert a big endian byte array to a limb array
+ *
+ * @dst:	Place to put the little endian limb array
+ * @len:	Length of @dst in limbs
+ * @src:	Big endian byte array
+ * @size:	Length of @src in bytes, at most @len limbs
+ */
+static void bn_from_be(bn_limb dst[], uint len, const uint8_t *src, uint size)
+{
+	uint i;
 
-	return -EINVAL;
+	memset(dst, '\0', len * sizeof(bn_limb));
+	for (i = 0; i < size; i++)
+		dst[i / sizeof(bn_limb)] |= (bn_limb)src[size - 1 - i] <<
+					    (i % sizeof(bn_limb) * 8);
 }
 
 /**
- * is_public_exponent_bit_set() - Check if a bit in the public exponent is set
+ * bn_to_be() - convert a limb array to a big endian byte array
  *
- * @key:	RSA key
- * @pos:	The bit position to check
+ * @dst:	Place to put the big endian byte array
+ * @size:	Length of @dst in bytes
+ * @src:	Little endian limb array, at least @size bytes long
  */
-static int is_public_exponent_bit_set(const struct rsa_public_key *key,
-		int pos)
+static void bn_to_be(uint8_t *dst, uint size, const bn_limb src[])
 {
-	return key->exponent & (1ULL << pos);
+	uint i;
+
+	for (i = 0; i < size; i++)
+		dst[size - 1 - i] = src[i / sizeof(bn_limb)] >>
+				    (i % sizeof(bn_limb) * 8);
 }
 
 /**
- * pow_mod() - in-place public exponentiation
+ * rsa_mont_prepare() - set up a key for Montgomery arithmetic
  *
- * @key:	RSA key
- * @inout:	Big-endian word array containing value and result
+ * @key:	Place to put the prepared key
+ * @prop:	Key properties, which have been checked by the caller
+ * Return: 0 if OK, -EINVAL if the modulus is not odd
  */
-static int pow_mod(const struct rsa_public_key *key, uint32_t *inout)
+static int rsa_mont_prepare(struct rsa_mont_key *key,
+			    const struct key_prop *prop)
 {
-	uint32_t *result, *ptr;
-	uint i;
-	int j, k;
+	uint size = prop->num_bits / 8;
+	bn_limb inv;
+	int i;
 
-	/* Sanity check for stack size - key->len is in 32-bit words */
-	if (key->len > RSA_MAX_KEY_BITS / 32) {
-		debug("RSA key words %u exceeds maximum %d\n", key->len,
-		      RSA_MAX_KEY_BITS / 32);
+	key->num_bits = prop->num_bits;
+	key->len = (prop->num_bits + BN_LIMB_BITS - 1) / BN_LIMB_BITS;
+	memcpy(key->raw, prop->modulus, size);
+	bn_from_be(key->modulus, key->len, prop->modulus, size);
+	if (!(key->modulus[0] & 1)) {
+		debug("RSA modulus must be odd\n");
 		return -EINVAL;
 	}
 
-	uint32_t val[key->len], acc[key->len], tmp[key->len];
-	uint32_t a_scaled[key->len];
-	result = tmp;  /* Re-use location. */
+	/*
+	 * Any odd m is its own inverse mod 8 and each Newton step doubles the
+	 * number of correct bits, so this is exact for 32- and 64-bit limbs
+	 */
+	inv = key->modulus[0];
+	for (i = 0; i < 5; i++)
+		inv *= 2 - key->modulus[0] * inv;
+	key->n0inv = -inv;
 
-	/* Convert from big endian byte array to little endian word array. */
-	for (i = 0, ptr = inout + key->len - 1; i < key->len; i++, ptr--)
-		val[i] = get_unaligned_be32(ptr);
+	/* The key holds R^2 for R = 2^num_bits; scale it up to our R */
+	bn_from_be(key->rr, key->len, prop->rr, size);
+	for (i = 2 * (key->len * BN_LIMB_BITS - key->num_bits); i > 0; i--)
+		bn_mod_double(key, key->rr);
 
-	if (0 != num_public_exponent_bits(key, &k))
-		return -EINVAL;
+	return 0;
+}
+
+static bool rsa_key_cache_usable(void)
+{
+#if defined(USE_HOSTCC) || defined(CONFIG_XPL_BUILD)
+	return true;
+#else
+	/* BSS is not available before relocation */
+	return gd->flags & GD_FLG_RELOC;
+#endif
+}
+
+/**
+ * rsa_key_cache_find() - look for a key which has already been prepared
+ *
+ * @prop:	Key properties
+ * Return: prepared key, or NULL if none
+ */
+static struct rsa_mont_key *rsa_key_cache_find(const struct key_prop *prop)
+{
+	struct rsa_mont_key *key;
+	int i;
+
+	for (i = 0; i < RSA_KEY_CACHE_SIZE; i++) {
+		key = rsa_key_cache[i];
+		if (key && key->num_bits == prop->num_bits &&
+		    !memcmp(key->raw, prop->modulus, key->num_bits / 8))
+			return key;
+	}
+
+	return NULL;
+}
+
+/**
+ * rsa_key_cache_new() - get a cache entry for a new key
+ *
+ * This reuses the least recently added entry once the cache is full.
+ *
+ * Return: cache entry, or NULL if out of memory
+ */
+static struct rsa_mont_key *rsa_key_cache_new(void)
+{
+	struct rsa_mont_key *key = rsa_key_cache[rsa_key_cache_next];
+
+	if (!key) {
+		key = malloc(sizeof(*key));
+		if (!key)
+			return NULL;
+		rsa_key_cache[rsa_key_cache_next] = key;
+	}
+	rsa_key_cache_next = (rsa_key_cache_next + 1) % RSA_KEY_CACHE_SIZE;
+	key->num_bits = 0;
+
+	return key;
+}
+
+/**
+ * num_exponent_bits() - Number of bits in the public exponent
+ *
+ * @exp:	Exponent as big endian byte array
+ * @exp_len:	Length of @exp in bytes
+ * Return: number of bits, 0 if the exponent is zero
+ */
+static uint num_exponent_bits(const uint8_t *exp, uint exp_len)
+{
+	uint i, bits;
+
+	for (i = 0; i < exp_len; i++) {
+		if (exp[i]) {
+			for (bits = 8; !(exp[i] >> (bits - 1)); bits--)
+				;
+			return (exp_len - i - 1) * 8 + bits;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * exponent_bit() - Get a bit of the public exponent
+ *
+ * @exp:	Exponent as big endian byte array
+ * @exp_len:	Length of @exp in bytes
+ * @pos:	The bit position to check
+ */
+static uint exponent_bit(const uint8_t *exp, uint exp_len, uint pos)
+{
+	return exp[exp_len - 1 - pos / 8] >> (pos % 8) & 1;
+}
 
+/**
+ * exponent_window_bits() - Choose the window size for an exponent
+ *
+ * A window of w bits needs 2^(w - 1) precomputed odd powers, which only pays
+ * for itself on long exponents. Small exponents such as 65537 use w = 1,
+ * i.e. plain square-and-multiply.
+ *
+ * @bits:	Number of bits in the exponent
+ */
+static uint exponent_window_bits(uint bits)
+{
+	if (bits > 79)
+		return RSA_MAX_WINDOW_BITS;
+
+	return bits > 23 ? 3 : 1;
+}
+
+/**
+ * pow_mod() - in-place exponentiation, using a sliding window
+ *
+ * @key:	Prepared RSA key
+ * @exp:	Exponent as big endian byte array
+ * @exp_len:	Length of @exp in bytes
+ * @in:		Value as big endian byte array
+ * @out:	Place to put the result as big endian byte array
+ * @size:	Length of @in and @out in bytes
+ * Return: 0 if OK, -EINVAL if the exponent is not valid
+ */
+static int pow_mod(const struct rsa_mont_key *key, const uint8_t *exp,
+		   uint exp_len, const uint8_t *in, uint8_t *out, uint size)
+{
+	bn_limb *acc, *tmp, *swap;
+	bool started = false;
+	uint len = key->len;
+	uint k, w, val;
+	int i, j, l;
+
+	k = num_exponent_bits(exp, exp_len);
 	if (k < 2) {
 		debug("Public exponent is too short (%d bits, minimum 2)\n",
 		      k);
 		return -EINVAL;
 	}
 
-	if (!is_public_exponent_bit_set(key, 0)) {
+	if (!exponent_bit(exp, exp_len, 0)) {
 		debug("LSB of RSA public exponent must be set.\n");
 		return -EINVAL;
 	}
 
-	/* the bit at e[k-1] is 1 by definition, so start with: C := M */
-	montgomery_mul(key, acc, val, key->rr); /* acc = a * RR / R mod n */
-	/* retain scaled version for intermediate use */
-	memcpy(a_scaled, acc, key->len * sizeof(a_scaled[0]));
+	w = exponent_window_bits(k);
+	bn_limb table[1 << (w - 1)][len], buf1[len], buf2[len];
+
+	/* table[i] = in^(2 * i + 1) * R mod n */
+	bn_from_be(buf2, len, in, size);
+	bn_mont_mul(key, table[0], buf2, key->rr);
+	if (w > 1) {
+		bn_mont_mul(key, buf1, table[0], table[0]);
+		for (i = 1; i < 1 << (w - 1); i++)
+			bn_mont_mul(key, table[i], table[i - 1], buf1);
+	}
 
-	for (j = k - 2; j > 0; --j) {
-		montgomery_mul(key, tmp, acc, acc); /* tmp = acc^2 / R mod n */
+	acc = buf1;
+	tmp = buf2;
+	for (i = k - 1; i >= 0; i = j - 1) {
+		if (!exponent_bit(exp, exp_len, i)) {
+			bn_mont_mul(key, tmp, acc, acc);
+			swap = acc, acc = tmp, tmp = swap;
+			j = i;
+			continue;
+		}
 
-		if (is_public_exponent_bit_set(key, j)) {
-			/* acc = tmp * val / R mod n */
-			montgomery_mul(key, acc, tmp, a_scaled);
-		} else {
-			/* e[j] == 0, copy tmp back to acc for next operation */
-			memcpy(acc, tmp, key->len * sizeof(acc[0]));
+		/* take the longest run of up to w bits which ends in a 1 */
+		j = i - (int)w + 1 > 0 ? i - (int)w + 1 : 0;
+		while (!exponent_bit(exp, exp_len, j))
+			j++;
+		for (val = 0, l = i; l >= j; l--)
+			val = val << 1 | exponent_bit(exp, exp_len, l);
+
+		if (!started) {
+			/* the top bit of the exponent is always 1 */
+			memcpy(acc, table[val >> 1], len * sizeof(bn_limb));
+			started = true;
+			continue;
 		}
+		for (l = i; l >= j; l--) {
+			bn_mont_mul(key, tmp, acc, acc);
+			swap = acc, acc = tmp, tmp = swap;
+		}
+		bn_mont_mul(key, tmp, acc, table[val >> 1]);
+		swap = acc, acc = tmp, tmp = swap;
 	}
 
-	/* the bit at e[0] is always 1 */
-	montgomery_mul(key, tmp, acc, acc); /* tmp = acc^2 / R mod n */
-	montgomery_mul(key, acc, tmp, val); /* acc = tmp * a / R mod M */
-	memcpy(result, acc, key->len * sizeof(result[0]));
+	/* take the result out of Montgomery form: acc / R mod n */
+	memset(tmp, '\0', len * sizeof(bn_limb));
+	tmp[0] = 1;
+	bn_mont_mul(key, table[0], acc, tmp);
 
 	/* Make sure result < mod; result is at most 1x mod too large. */
-	if (greater_equal_modulus(key, result))
-		subtract_modulus(key, result);
+	if (bn_ge_modulus(key, table[0]))
+		bn_sub_modulus(key, table[0]);
+	bn_to_be(out, size, table[0]);
 
-	/* Convert to bigendian byte array */
-	for (i = key->len - 1, ptr = inout; (int)i >= 0; i--, ptr++)
-		put_unaligned_be32(result[i], ptr);
 	return 0;
 }
 
-static void rsa_convert_big_endian(uint32_t *dst, const uint32_t *src, int len)
-{
-	int i;
-
-	for (i = 0; i < len; i++)
-		dst[i] = fdt32_to_cpu(src[len - 1 - i]);
-}
-
 int rsa_mod_exp_sw(const uint8_t *sig, uint32_t sig_len,
 		struct key_prop *prop, uint8_t *out)
 {
-	struct rsa_public_key key;
+	fdt64_t default_exp = cpu_to_fdt64(RSA_DEFAULT_PUBEXP);
+	struct rsa_mont_key *key;
+	const uint8_t *exp;
+	uint exp_len;
+	bool cached;
 	int ret;
 
 	if (!prop) {
 		debug("%s: Skipping invalid prop", __func__);
 		return -EBADF;
 	}
-	key.n0inv = prop->n0inv;
-	key.len = prop->num_bits;
 
-	if (!prop->public_exponent)
-		key.exponent = RSA_DEFAULT_PUBEXP;
-	else
-		key.exponent = fdt64_to_cpup(prop->public_exponent);
+	if (!prop->public_exponent) {
+		exp = (const uint8_t *)&default_exp;
+		exp_len = sizeof(default_exp);
+	} else {
+		exp = prop->public_exponent;
+		exp_len = prop->exp_len ? prop->exp_len : sizeof(uint64_t);
+	}
 
-	if (!key.len || !prop->modulus || !prop->rr) {
+	if (!prop->num_bits || !prop->modulus || !prop->rr) {
 		debug("%s: Missing RSA key info", __func__);
 		return -EFAULT;
 	}
 
 	/* Sanity check for stack size */
-	if (key.len > RSA_MAX_KEY_BITS || key.len < RSA_MIN_KEY_BITS) {
+	if (prop->num_bits > RSA_MAX_KEY_BITS ||
+	    prop->num_bits < RSA_MIN_KEY_BITS) {
 		debug("RSA key bits %u outside allowed range %d..%d\n",
-		      key.len, RSA_MIN_KEY_BITS, RSA_MAX_KEY_BITS);
+		      prop->num_bits, RSA_MIN_KEY_BITS, RSA_MAX_KEY_BITS);
 		return -EFAULT;
 	}
-	key.len /= sizeof(uint32_t) * 8;
-	uint32_t key1[key.len], key2[key.len];
-
-	key.modulus = key1;
-	key.rr = key2;
-	rsa_convert_big_endian(key.modulus, (uint32_t *)prop->modulus, key.len);
-	rsa_convert_big_endian(key.rr, (uint32_t *)prop->rr, key.len);
-	if (!key.modulus || !key.rr) {
-		debug("%s: Out of memory", __func__);
-		return -ENOMEM;
+
+	if (sig_len > prop->num_bits / 8) {
+		debug("RSA signature length %u exceeds key size\n", sig_len);
+		return -EINVAL;
 	}
 
-	uint32_t buf[sig_len / sizeof(uint32_t)];
+	cached = rsa_key_cache_usable();
+	key = cached ? rsa_key_cache_find(prop) : NULL;
+	if (!key) {
+		key = cached ? rsa_key_cache_new() : malloc(sizeof(*key));
+		if (!key) {
+			debug("%s: Out of memory", __func__);
+			return -ENOMEM;
+		}
+		ret = rsa_mont_prepare(key, prop);
+		if (ret) {
+			key->num_bits = 0;
+			goto out;
+		}
+	}
 
-	memcpy(buf, sig, sig_len);
+	ret = pow_mod(key, exp, exp_len, sig, out, sig_len);
+out:
+	if (!cached)
+		free(key);
 
-	ret = pow_mod(&key, buf);
-	if (ret)
-		return ret;
+	return ret;
+}
 
-	memcpy(out, buf, sig_len);
+#if defined(CONFIG_CMD_ZYNQ_RSA)
+/**
+ * subtract_modulus() - subtract modulus from the given value
+ *
+ * @key:	Key containing modulus to subtract
+ * @num:	Number to subtract modulus from, as little endian word array
+ */
+static void subtract_modulus(const struct rsa_public_key *key, uint32_t num[])
+{
+	int64_t acc = 0;
+	uint i;
 
-	return 0;
+	for (i = 0; i < key->len; i++) {
+		acc += (uint64_t)num[i] - key->modulus[i];
+		num[i] = (uint32_t)acc;
+		acc >>= 32;
+	}
+}
+
+/**
+ * greater_equal_modulus() - check if a value is >= modulus
+ *
+ * @key:	Key containing modulus to check
+ * @num:	Number to check against modulus, as little endian word array
+ * Return: 0 if num < modulus, 1 if num >= modulus
+ */
+static int greater_equal_modulus(const struct rsa_public_key *key,
+				 uint32_t num[])
+{
+	int i;
+
+	for (i = (int)key->len - 1; i >= 0; i--) {
+		if (num[i] < key->modulus[i])
+			return 0;
+		if (num[i] > key->modulus[i])
+			return 1;
+	}
+
+	return 1;  /* equal */
+}
+
+/**
+ * montgomery_mul_add_step() - Perform montgomery multiply-add step
+ *
+ * Operation: montgomery result[] += a * b[] / n0inv % modulus
+ *
+ * @key:	RSA key
+ * @result:	Place to put result, as little endian word array
+ * @a:		Multiplier
+ * @b:		Multiplicand, as little endian word array
+ */
+static void montgomery_mul_add_step(const struct rsa_public_key *key,
+		uint32_t result[], const uint32_t a, const uint32_t b[])
+{
+	uint64_t acc_a, acc_b;
+	uint32_t d0;
+	uint i;
+
+	acc_a = (uint64_t)a * b[0] + result[0];
+	d0 = (uint32_t)acc_a * key->n0inv;
+	acc_b = (uint64_t)d0 * key->modulus[0] + (uint32_t)acc_a;
+	for (i = 1; i < key->len; i++) {
+		acc_a = (acc_a >> 32) + (uint64_t)a * b[i] + result[i];
+		acc_b = (acc_b >> 32) + (uint64_t)d0 * key->modulus[i] +
+				(uint32_t)acc_a;
+		result[i - 1] = (uint32_t)acc_b;
+	}
+
+	acc_a = (acc_a >> 32) + (acc_b >> 32);
+
+	result[i - 1] = (uint32_t)acc_a;
+
+	if (acc_a >> 32)
+		subtract_modulus(key, result);
+}
+
+/**
+ * montgomery_mul() - Perform montgomery mutitply
+ *
+ * Operation: montgomery result[] = a[] * b[] / n0inv % modulus
+ *
+ * @key:	RSA key
+ * @result:	Place to put result, as little endian word array
+ * @a:		Multiplier, as little endian word array
+ * @b:		Multiplicand, as little endian word array
+ */
+static void montgomery_mul(const struct rsa_public_key *key,
+		uint32_t result[], uint32_t a[], const uint32_t b[])
+{
+	uint i;
+
+	for (i = 0; i < key->len; ++i)
+		result[i] = 0;
+	for (i = 0; i < key->len; ++i)
+		montgomery_mul_add_step(key, result, a[i], b);
 }
 
-#if defined(CONFIG_CMD_ZYNQ_RSA)
 /**
  * zynq_pow_mod - in-place public exponentiation
  *
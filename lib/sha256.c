@@ -185,8 +185,8 @@ static void sha256_process_one(sha256_context *ctx, const uint8_t data[64])
 	ctx->state[7] += H;
 }
 
-__weak void sha256_process(sha256_context *ctx, const unsigned char *data,
-			   unsigned int blocks)
+void sha256_process_generic(sha256_context *ctx, const unsigned char *data,
+			    unsigned int blocks)
 {
 	if (!blocks)
 		return;
@@ -197,6 +197,12 @@ __weak void sha256_process(sha256_context *ctx, const unsigned char *data,
 	}
 }
 
+__weak void sha256_process(sha256_context *ctx, const unsigned char *data,
+			   unsigned int blocks)
+{
+	sha256_process_generic(ctx, data, blocks);
+}
+
 void sha256_update(sha256_context *ctx, const uint8_t *input, uint32_t length)
 {
 	uint32_t left, fill;
@@ -5,13 +5,11 @@
 
 #include <dm.h>
 #include <dm/of_access.h>
+#include <hash.h>
 #include <tpm_api.h>
 #include <tpm-common.h>
 #include <tpm-v2.h>
 #include <tpm_tcg2.h>
-#include <u-boot/sha1.h>
-#include <u-boot/sha256.h>
-#include <u-boot/sha512.h>
 #include <version_string.h>
 #include <asm/io.h>
 #include <linux/bitops.h>
@@ -95,67 +93,39 @@ int tcg2_create_digest(struct udevice *dev, const u8 *input, u32 length,
 		       struct tpml_digest_values *digest_list)
 {
 	struct tpm_chip_priv *priv = dev_get_uclass_priv(dev);
-	u8 final[sizeof(union tpmu_ha)];
-#if IS_ENABLED(CONFIG_SHA256)
-	sha256_context ctx_256;
-#endif
-#if IS_ENABLED(CONFIG_SHA512)
-	sha512_context ctx_512;
-#endif
-#if IS_ENABLED(CONFIG_SHA1)
-	sha1_context ctx;
-#endif
+	const char *names[HASH_MULTI_MAX];
+	uint8_t *outputs[HASH_MULTI_MAX];
+	struct hash_algo *algo;
+	int count = 0;
 	size_t i;
-	u32 len;
+	int rc;
 
 	digest_list->count = 0;
 	for (i = 0; i < priv->active_bank_count; i++) {
+		u16 hash_alg = priv->active_banks[i];
+		const char *name = tpm2_algorithm_name(hash_alg);
 
-		switch (priv->active_banks[i]) {
-#if IS_ENABLED(CONFIG_SHA1)
-		case TPM2_ALG_SHA1:
-			sha1_starts(&ctx);
-			sha1_update(&ctx, input, length);
-			sha1_finish(&ctx, final);
-			len = TPM2_SHA1_DIGEST_SIZE;
-			break;
-#endif
-#if IS_ENABLED(CONFIG_SHA256)
-		case TPM2_ALG_SHA256:
-			sha256_starts(&ctx_256);
-			sha256_update(&ctx_256, input, length);
-			sha256_finish(&ctx_256, final);
-			len = TPM2_SHA256_DIGEST_SIZE;
-			break;
-#endif
-#if IS_ENABLED(CONFIG_SHA384)
-		case TPM2_ALG_SHA384:
-			sha384_starts(&ctx_512);
-			sha384_update(&ctx_512, input, length);
-			sha384_finish(&ctx_512, final);
-			len = TPM2_SHA384_DIGEST_SIZE;
-			break;
-#endif
-#if IS_ENABLED(CONFIG_SHA512)
-		case TPM2_ALG_SHA512:
-			sha512_starts(&ctx_512);
-			sha512_update(&ctx_512, input, length);
-			sha512_finish(&ctx_512, final);
-			len = TPM2_SHA512_DIGEST_SIZE;
-			break;
-#endif
-		default:
+		if (!tpm2_algorithm_supported(hash_alg) ||
+		    hash_progressive_lookup_algo(name, &algo) ||
+		    count == HASH_MULTI_MAX) {
 			printf("%s: unsupported algorithm %x\n", __func__,
-			       priv->active_banks[i]);
+			       hash_alg);
 			continue;
 		}
 
-		digest_list->digests[digest_list->count].hash_alg =
-			priv->active_banks[i];
-		memcpy(&digest_list->digests[digest_list->count].digest, final,
-		       len);
-		digest_list->count++;
+		names[count] = name;
+		outputs[count] = (uint8_t *)&digest_list->digests[count].digest;
+		digest_list->digests[count].hash_alg = hash_alg;
+		count++;
 	}
+	if (!count)
+		return 0;
+
+	/* Hash the data once for all the banks rather than once per bank */
+	rc = hash_multi_block(names, count, input, length, outputs);
+	if (rc)
+		return rc;
+	digest_list->count = count;
 
 	return 0;
 }
@@ -8,12 +8,34 @@
  * - xxHash source repository: https://github.com/Cyan4973/xxHash
  */
 
+#ifdef USE_HOSTCC
+#include <errno.h>
+#include <string.h>
+
+#define EXPORT_SYMBOL(sym)
+
+static inline uint32_t get_unaligned_le32(const void *p)
+{
+	const uint8_t *b = p;
+
+	return b[0] | b[1] << 8 | b[2] << 16 | (uint32_t)b[3] << 24;
+}
+
+static inline uint64_t get_unaligned_le64(const void *p)
+{
+	const uint8_t *b = p;
+
+	return (uint64_t)get_unaligned_le32(b + 4) << 32 |
+	       get_unaligned_le32(b);
+}
+#else
 #include <asm/unaligned.h>
 #include <linux/errno.h>
 #include <linux/compiler.h>
 #include <linux/kernel.h>
 #include <linux/compat.h>
 #include <linux/string.h>
+#endif
 #include <linux/xxhash.h>
 
 /*-*************************************
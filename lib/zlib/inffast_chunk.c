@@ -0,0 +1,330 @@
+/* inffast_chunk.c -- fast decoding using wide loads and stores
+ * Copyright (C) 1995-2017 Mark Adler
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/* U-Boot: we already included these
+#include "zutil.h"
+#include "inftrees.h"
+#include "inflate.h"
+#include "inffast_chunk.h"
+*/
+
+/*
+   This is a variant of inflate_fast() along the lines of the Chromium and
+   zlib-ng fast paths:
+
+   - The bit accumulator is 64 bits wide and is refilled with a single
+     unaligned 8-byte load, so one refill covers a length/distance pair.
+
+   - Up to three literals are decoded per refill before falling into the
+     length/distance path.
+
+   - Matches are copied INFLATE_CHUNK_SIZE bytes at a time, including short
+     overlapping distances, which are widened to a multiple of the distance
+     that is at least one chunk long.
+
+   Entry assumptions:
+
+        state->mode == LEN
+        strm->avail_in >= INFLATE_FAST_CHUNK_MIN_INPUT
+        strm->avail_out >= INFLATE_FAST_CHUNK_MIN_OUTPUT
+        start >= strm->avail_out
+        state->bits < 8
+
+   On return, state->mode is one of:
+
+        LEN -- ran out of enough output space or enough available input
+        TYPE -- reached end of block code, inflate() to interpret next block
+        BAD -- error in block data
+
+   Notes:
+
+    - After a refill there are at least 56 bits in the accumulator. Three
+      literals of at most 9 bits each (root table size) plus a 15-bit length
+      code and 5 extra bits use at most 47, so the only refill needed after
+      the one at the top of the loop is before the distance code (15 bits
+      plus 13 extra bits). Each refill advances the input by at most seven
+      bytes and reads eight, so sixteen bytes of input are enough for one
+      iteration.
+
+    - One iteration writes at most two literals and a 258-byte match, and
+      chunked copies may run INFLATE_CHUNK_SIZE - 1 bytes past the end of
+      the match. The data written there is overwritten later on.
+ */
+
+int inflate_chunk_enable = 1;
+
+typedef u64 inflate_chunk_t;
+
+#define REFILL() do { \
+        hold |= get_unaligned_le64(in) << bits; \
+        in += (63 ^ bits) >> 3; \
+        bits |= 56; \
+    } while (0)
+
+local inline void storechunk(unsigned char FAR *out,
+                             const unsigned char FAR *from)
+{
+    put_unaligned(get_unaligned((const inflate_chunk_t *)from),
+                  (inflate_chunk_t *)out);
+}
+
+/* Copy len bytes from a buffer that does not overlap the output, exactly */
+local inline unsigned char FAR *chunkcopy(unsigned char FAR *out,
+                                          const unsigned char FAR *from,
+                                          unsigned len)
+{
+    while (len >= INFLATE_CHUNK_SIZE) {
+        storechunk(out, from);
+        out += INFLATE_CHUNK_SIZE;
+        from += INFLATE_CHUNK_SIZE;
+        len -= INFLATE_CHUNK_SIZE;
+    }
+    while (len--)
+        *out++ = *from++;
+
+    return out;
+}
+
+/*
+   Copy len bytes from dist bytes back in the output. This may write up to
+   INFLATE_CHUNK_SIZE - 1 bytes beyond the end of the copy.
+ */
+local inline unsigned char FAR *chunkcopy_lapped(unsigned char FAR *out,
+                                                 unsigned dist, unsigned len)
+{
+    const unsigned char FAR *from = out - dist;
+    unsigned char FAR *end = out + len;
+
+    if (dist == 1) {
+        inflate_chunk_t pat;
+
+        pat = (inflate_chunk_t)*from * 0x0101010101010101ULL;
+        do {
+            put_unaligned(pat, (inflate_chunk_t *)out);
+            out += INFLATE_CHUNK_SIZE;
+        } while (out < end);
+
+        return end;
+    }
+    if (dist < INFLATE_CHUNK_SIZE) {
+        unsigned step, pre;
+
+        /*
+           The output is periodic with period dist, so once step - dist
+           bytes have been written the data step bytes back is the same
+           as the data dist bytes back, and step is at least a chunk.
+         */
+        step = dist * ((INFLATE_CHUNK_SIZE - 1) / dist + 1);
+        pre = step - dist;
+        if (pre >= len) {
+            while (len--)
+                *out++ = *from++;
+            return out;
+        }
+        while (pre--)
+            *out++ = *from++;
+        from = out - step;
+    }
+    do {
+        storechunk(out, from);
+        out += INFLATE_CHUNK_SIZE;
+        from += INFLATE_CHUNK_SIZE;
+    } while (out < end);
+
+    return end;
+}
+
+void ZLIB_INTERNAL inflate_fast_chunk(z_streamp strm, unsigned start)
+{
+    struct inflate_state FAR *state;
+    z_const unsigned char FAR *in;      /* local strm->next_in */
+    z_const unsigned char FAR *last;    /* have enough input while in < last */
+    z_const unsigned char FAR *in_end;  /* end of available input */
+    unsigned char FAR *out;     /* local strm->next_out */
+    unsigned char FAR *beg;     /* inflate()'s initial strm->next_out */
+    unsigned char FAR *end;     /* while out < end, enough space available */
+    unsigned char FAR *out_end; /* end of available output */
+#ifdef INFLATE_STRICT
+    unsigned dmax;              /* maximum distance from zlib header */
+#endif
+    unsigned wsize;             /* window size or zero if not using window */
+    unsigned whave;             /* valid bytes in the window */
+    unsigned wnext;             /* window write index */
+    unsigned char FAR *window;  /* allocated sliding window, if wsize != 0 */
+    u64 hold;                   /* local strm->hold, widened */
+    unsigned bits;              /* local strm->bits */
+    code const FAR *lcode;      /* local strm->lencode */
+    code const FAR *dcode;      /* local strm->distcode */
+    unsigned lmask;             /* mask for first level of length codes */
+    unsigned dmask;             /* mask for first level of distance codes */
+    code here;                  /* retrieved table entry */
+    unsigned op;                /* code bits, operation, extra bits, or */
+                                /*  window position, window bytes to copy */
+    unsigned len;               /* match length, unused bytes */
+    unsigned dist;              /* match distance */
+    unsigned char FAR *from;    /* where to copy match from */
+
+    /* copy state to local variables */
+    state = (struct inflate_state FAR *)strm->state;
+    in = strm->next_in;
+    in_end = in + strm->avail_in;
+    last = in_end - (INFLATE_FAST_CHUNK_MIN_INPUT - 1);
+    out = strm->next_out;
+    beg = out - (start - strm->avail_out);
+    out_end = out + strm->avail_out;
+    end = out_end - (INFLATE_FAST_CHUNK_MIN_OUTPUT - 1);
+#ifdef INFLATE_STRICT
+    dmax = state->dmax;
+#endif
+    wsize = state->wsize;
+    whave = state->whave;
+    wnext = state->wnext;
+    window = state->window;
+    hold = state->hold;
+    bits = state->bits;
+    lcode = state->lencode;
+    dcode = state->distcode;
+    lmask = (1U << state->lenbits) - 1;
+    dmask = (1U << state->distbits) - 1;
+
+    /* decode literals and length/distances until end-of-block or not enough
+       input data or output space */
+    do {
+        REFILL();
+        here = lcode[hold & lmask];
+        if (here.op == 0) {
+            Tracevv((stderr, "inflate:         literal 0x%02x\n", here.val));
+            *out++ = (unsigned char)(here.val);
+            hold >>= here.bits;
+            bits -= here.bits;
+            here = lcode[hold & lmask];
+            if (here.op == 0) {
+                Tracevv((stderr, "inflate:         literal 0x%02x\n",
+                        here.val));
+                *out++ = (unsigned char)(here.val);
+                hold >>= here.bits;
+                bits -= here.bits;
+                here = lcode[hold & lmask];
+            }
+        }
+      dolen:
+        op = (unsigned)(here.bits);
+        hold >>= op;
+        bits -= op;
+        op = (unsigned)(here.op);
+        if (op == 0) {                          /* literal */
+            Tracevv((stderr, "inflate:         literal 0x%02x\n", here.val));
+            *out++ = (unsigned char)(here.val);
+        }
+        else if (op & 16) {                     /* length base */
+            len = (unsigned)(here.val);
+            op &= 15;                           /* number of extra bits */
+            if (op) {
+                len += (unsigned)hold & ((1U << op) - 1);
+                hold >>= op;
+                bits -= op;
+            }
+            Tracevv((stderr, "inflate:         length %u\n", len));
+            if (bits < 28)
+                REFILL();
+            here = dcode[hold & dmask];
+          dodist:
+            op = (unsigned)(here.bits);
+            hold >>= op;
+            bits -= op;
+            op = (unsigned)(here.op);
+            if (op & 16) {                      /* distance base */
+                dist = (unsigned)(here.val);
+                op &= 15;                       /* number of extra bits */
+                dist += (unsigned)hold & ((1U << op) - 1);
+#ifdef INFLATE_STRICT
+                if (dist > dmax) {
+                    strm->msg = (char *)"invalid distance too far back";
+                    state->mode = BAD;
+                    break;
+                }
+#endif
+                hold >>= op;
+                bits -= op;
+                Tracevv((stderr, "inflate:         distance %u\n", dist));
+                op = (unsigned)(out - beg);     /* max distance in output */
+                if (dist > op) {                /* see if copy from window */
+                    op = dist - op;             /* distance back in window */
+                    if (op > whave) {
+                        strm->msg =
+                            (char *)"invalid distance too far back";
+                        state->mode = BAD;
+                        break;
+                    }
+                    from = window;
+                    if (wnext == 0) {           /* very common case */
+                        from += wsize - op;
+                    }
+                    else if (wnext < op) {      /* wrap around window */
+                        from += wsize + wnext - op;
+                        op -= wnext;
+                        if (op < len) {         /* some from end of window */
+                            len -= op;
+                            out = chunkcopy(out, from, op);
+                            from = window;
+                            op = wnext;
+                        }
+                    }
+                    else {                      /* contiguous in window */
+                        from += wnext - op;
+                    }
+                    if (op < len) {             /* some from window */
+                        len -= op;
+                        out = chunkcopy(out, from, op);
+                        out = chunkcopy_lapped(out, dist, len);
+                    }
+                    else {
+                        out = chunkcopy(out, from, len);
+                    }
+                }
+                else {
+                    out = chunkcopy_lapped(out, dist, len);
+                }
+            }
+            else if ((op & 64) == 0) {          /* 2nd level distance code */
+                here = dcode[here.val + (hold & ((1U << op) - 1))];
+                goto dodist;
+            }
+            else {
+                strm->msg = (char *)"invalid distance code";
+                state->mode = BAD;
+                break;
+            }
+        }
+        else if ((op & 64) == 0) {              /* 2nd level length code */
+            here = lcode[here.val + (hold & ((1U << op) - 1))];
+            goto dolen;
+        }
+        else if (op & 32) {                     /* end-of-block */
+            Tracevv((stderr, "inflate:         end of block\n"));
+            state->mode = TYPE;
+            break;
+        }
+        else {
+            strm->msg = (char *)"invalid literal/length code";
+            state->mode = BAD;
+            break;
+        }
+    } while (in < last && out < end);
+
+    /* return unused bytes (on entry, bits < 8, so in won't go too far back) */
+    len = bits >> 3;
+    in -= len;
+    bits -= len << 3;
+    hold &= (1U << bits) - 1;
+
+    /* update state and return */
+    strm->next_in = in;
+    strm->next_out = out;
+    strm->avail_in = (unsigned)(in_end - in);
+    strm->avail_out = (unsigned)(out_end - out);
+    state->hold = (unsigned long)hold;
+    state->bits = bits;
+}
@@ -0,0 +1,23 @@
+/* inffast_chunk.h -- header to use inffast_chunk.c
+ * Copyright (C) 1995-2003, 2010 Mark Adler
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/* WARNING: this file should *not* be used by applications. It is
+   part of the implementation of the compression library and is
+   subject to change. Applications should only use zlib.h.
+ */
+
+/* Width of a single load/store used for match and window copies */
+#define INFLATE_CHUNK_SIZE 8
+
+/*
+   inflate_fast_chunk() refills its 64-bit bit buffer up to twice per
+   iteration and may write up to INFLATE_CHUNK_SIZE - 1 bytes past the end
+   of a match, so it needs more slack than inflate_fast(). inflate() falls
+   back to inflate_fast() when less than this is available.
+ */
+#define INFLATE_FAST_CHUNK_MIN_INPUT 16
+#define INFLATE_FAST_CHUNK_MIN_OUTPUT (260 + INFLATE_CHUNK_SIZE)
+
+void inflate_fast_chunk OF((z_streamp strm, unsigned start));
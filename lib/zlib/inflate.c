@@ -736,6 +736,16 @@ __rcode int ZEXPORT inflate(z_streamp strm, int flush)
             fallthrough;
         case LEN:
 	    schedule();
+#if CONFIG_IS_ENABLED(ZLIB_INFLATE_CHUNK)
+            if (inflate_chunk_enable &&
+                have >= INFLATE_FAST_CHUNK_MIN_INPUT &&
+                left >= INFLATE_FAST_CHUNK_MIN_OUTPUT) {
+                RESTORE();
+                inflate_fast_chunk(strm, out);
+                LOAD();
+                break;
+            }
+#endif
             if (have >= 6 && left >= 258) {
                 RESTORE();
                 inflate_fast(strm, out);
@@ -26,6 +26,10 @@
 #include "inffast.h"
 #include "inffixed.h"
 #include "inffast.c"
+#if CONFIG_IS_ENABLED(ZLIB_INFLATE_CHUNK)
+#include "inffast_chunk.h"
+#include "inffast_chunk.c"
+#endif
 #include "inftrees.c"
 #include "inflate.c"
 #include "zutil.c"
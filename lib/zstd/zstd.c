@@ -8,14 +8,58 @@
 #include <abuf.h>
 #include <log.h>
 #include <malloc.h>
+#include <asm/unaligned.h>
+#include <linux/bitops.h>
 #include <linux/errno.h>
+#include <linux/kernel.h>
+#include <linux/string.h>
 #include <linux/zstd.h>
 
+/* Seek table at the end of a file in the zstd seekable format */
+#define ZSTD_SEEKABLE_MAGIC		0x8f92eab1
+#define ZSTD_SEEKABLE_SKIPPABLE_MAGIC	(ZSTD_MAGIC_SKIPPABLE_START | 0xe)
+#define ZSTD_SEEKABLE_FOOTER_SIZE	9
+#define ZSTD_SEEKABLE_CHECKSUM		BIT(7)
+#define ZSTD_SEEKABLE_RESERVED		GENMASK(6, 2)
+
+/**
+ * struct zstd_seek_table - Seek table of a file in the zstd seekable format
+ *
+ * @entries: First entry, each holding the compressed size, decompressed size
+ *	and optionally a checksum of a frame, as little-endian 32-bit values
+ * @entry_size: Size of each entry in bytes
+ * @num_frames: Number of entries
+ * @data_size: Size of the frames before the seek table, in bytes
+ */
+struct zstd_seek_table {
+	const u8 *entries;
+	uint entry_size;
+	uint num_frames;
+	size_t data_size;
+};
+
+static int zstd_errno(size_t ret)
+{
+	switch (zstd_get_error_code(ret)) {
+	case ZSTD_error_frameParameter_windowTooLarge:
+	case ZSTD_error_memory_allocation:
+		return -E2BIG;
+	case ZSTD_error_dstSize_tooSmall:
+		return -ENOSPC;
+	default:
+		return -EINVAL;
+	}
+}
+
 int zstd_decompress(struct abuf *in, struct abuf *out)
 {
+	const u8 *src = abuf_data(in);
+	size_t remain = abuf_size(in);
+	size_t pos = 0;
 	zstd_dctx *ctx;
-	size_t wsize, len;
+	size_t wsize, len, dlen;
 	void *workspace;
+	uint frames;
 	int ret;
 
 	wsize = zstd_dctx_workspace_bound();
@@ -33,29 +77,275 @@ int zstd_decompress(struct abuf *in, struct abuf *out)
 		goto do_free;
 	}
 
+	for (frames = 0; remain; frames++) {
+		/*
+		 * Find out how large the frame actually is, there may be junk
+		 * at the end of the data that zstd_decompress_dctx() can't
+		 * handle. Once one frame has been decoded, stop at anything
+		 * that does not look like another frame.
+		 */
+		if (frames && !ZSTD_isFrame(src, remain))
+			break;
+		len = zstd_find_frame_compressed_size(src, remain);
+		if (zstd_is_error(len)) {
+			log_err("%s: failed to detect compressed size: %d\n",
+				__func__, zstd_get_error_code(len));
+			ret = -EINVAL;
+			goto do_free;
+		}
+
+		dlen = zstd_decompress_dctx(ctx, abuf_data(out) + pos,
+					    abuf_size(out) - pos, src, len);
+		if (zstd_is_error(dlen)) {
+			log_err("%s: failed to decompress: %d\n", __func__,
+				zstd_get_error_code(dlen));
+			ret = -EINVAL;
+			goto do_free;
+		}
+		pos += dlen;
+		src += len;
+		remain -= len;
+	}
+
+	ret = pos;
+do_free:
+	free(workspace);
+	return ret;
+}
+
+int zstd_stream_init(struct zstd_stream *zs, size_t max_window, bool flat)
+{
+	size_t wsize, ret;
+
+	memset(zs, '\0', sizeof(*zs));
+
 	/*
-	 * Find out how large the frame actually is, there may be junk at
-	 * the end of the frame that zstd_decompress_dctx() can't handle.
+	 * With a flat output buffer the decoder only needs to buffer one
+	 * block of input, since the window is the output buffer itself
 	 */
-	len = zstd_find_frame_compressed_size(abuf_data(in), abuf_size(in));
-	if (zstd_is_error(len)) {
-		log_err("%s: failed to detect compressed size: %d\n", __func__,
-			zstd_get_error_code(len));
-		ret = -EINVAL;
-		goto do_free;
+	if (flat)
+		wsize = zstd_dctx_workspace_bound() + ZSTD_BLOCKSIZE_MAX;
+	else
+		wsize = zstd_dstream_workspace_bound(max_window);
+	zs->workspace = malloc(wsize);
+	if (!zs->workspace) {
+		log_debug("cannot allocate workspace of size %zu\n", wsize);
+		return -ENOMEM;
 	}
 
-	len = zstd_decompress_dctx(ctx, abuf_data(out), abuf_size(out),
-				   abuf_data(in), len);
-	if (zstd_is_error(len)) {
-		log_err("%s: failed to decompress: %d\n", __func__,
-			zstd_get_error_code(len));
-		ret = -EINVAL;
-		goto do_free;
+	zs->dstream = zstd_init_dstream(max_window, zs->workspace, wsize);
+	if (!zs->dstream) {
+		log_err("%s: zstd_init_dstream() failed\n", __func__);
+		free(zs->workspace);
+		return -EPERM;
+	}
+	if (flat) {
+		ret = ZSTD_DCtx_setParameter(zs->dstream, ZSTD_d_stableOutBuffer,
+					     1);
+		if (zstd_is_error(ret)) {
+			free(zs->workspace);
+			return -EPERM;
+		}
 	}
 
-	ret = len;
-do_free:
-	free(workspace);
+	return 0;
+}
+
+int zstd_stream_feed(struct zstd_stream *zs, zstd_in_buffer *in,
+		     zstd_out_buffer *out)
+{
+	size_t in_pos, out_pos, ret;
+
+	while (in->pos < in->size) {
+		if (zs->done) {
+			in->pos = in->size;
+			break;
+		}
+		in_pos = in->pos;
+		out_pos = out->pos;
+		ret = zstd_decompress_stream(zs->dstream, out, in);
+		if (zstd_is_error(ret)) {
+			if (zs->frame_end && zstd_get_error_code(ret) ==
+			    ZSTD_error_prefix_unknown) {
+				log_debug("ignoring padding after %u frames\n",
+					  zs->frames);
+				zs->done = true;
+				continue;
+			}
+			log_debug("failed to decompress: %d\n",
+				  zstd_get_error_code(ret));
+			return zstd_errno(ret);
+		}
+		if (!ret) {
+			zs->frames++;
+			zs->frame_end = true;
+			zs->tail = 0;
+		} else if (zs->frame_end) {
+			/*
+			 * The decoder checks the magic number once it has
+			 * enough bytes to find the header size. After that,
+			 * another frame has definitely started.
+			 */
+			zs->tail += in->pos - in_pos;
+			if (zs->tail >= ZSTD_FRAMEHEADERSIZE_PREFIX(ZSTD_f_zstd1))
+				zs->frame_end = false;
+		}
+
+		/* the output buffer is full */
+		if (in->pos == in_pos && out->pos == out_pos)
+			break;
+	}
+
+	return 0;
+}
+
+int zstd_stream_finish(struct zstd_stream *zs)
+{
+	bool ended = zs->done || zs->frame_end;
+
+	zstd_stream_free(zs);
+	if (!ended)
+		return log_msg_ret("end", -EINVAL);
+
+	return 0;
+}
+
+void zstd_stream_free(struct zstd_stream *zs)
+{
+	free(zs->workspace);
+	zs->workspace = NULL;
+	zs->dstream = NULL;
+}
+
+static int zstd_find_seek_table(const u8 *data, size_t size,
+				struct zstd_seek_table *st)
+{
+	const u8 *footer, *hdr;
+	size_t table_size;
+	u8 desc;
+
+	if (size < ZSTD_SKIPPABLEHEADERSIZE + ZSTD_SEEKABLE_FOOTER_SIZE)
+		return -ENOENT;
+	footer = data + size - ZSTD_SEEKABLE_FOOTER_SIZE;
+	if (get_unaligned_le32(footer + 5) != ZSTD_SEEKABLE_MAGIC)
+		return -ENOENT;
+	desc = footer[4];
+	if (desc & ZSTD_SEEKABLE_RESERVED)
+		return log_msg_ret("desc", -EINVAL);
+
+	st->num_frames = get_unaligned_le32(footer);
+	st->entry_size = desc & ZSTD_SEEKABLE_CHECKSUM ? 12 : 8;
+	table_size = (u64)st->num_frames * st->entry_size +
+		ZSTD_SEEKABLE_FOOTER_SIZE;
+	if (table_size > size - ZSTD_SKIPPABLEHEADERSIZE)
+		return log_msg_ret("size", -EINVAL);
+
+	hdr = data + size - table_size - ZSTD_SKIPPABLEHEADERSIZE;
+	if (get_unaligned_le32(hdr) != ZSTD_SEEKABLE_SKIPPABLE_MAGIC ||
+	    get_unaligned_le32(hdr + 4) != table_size)
+		return log_msg_ret("hdr", -EINVAL);
+	st->entries = hdr + ZSTD_SKIPPABLEHEADERSIZE;
+	st->data_size = hdr - data;
+
+	return 0;
+}
+
+/*
+ * Work out the window needed to stream a frame. A frame never needs more
+ * than its content size, but the input buffer is sized by the window.
+ */
+static size_t zstd_frame_window(const u8 *src, size_t len)
+{
+	zstd_frame_header fh;
+	size_t window;
+
+	if (zstd_get_frame_header(&fh, src, len) ||
+	    fh.frameType == ZSTD_skippableFrame)
+		return 0;
+	window = fh.windowSize;
+	if (fh.frameContentSize != ZSTD_CONTENTSIZE_UNKNOWN)
+		window = min_t(u64, window, fh.frameContentSize);
+
+	return max_t(size_t, window, min_t(u64, fh.windowSize,
+					     ZSTD_BLOCKSIZE_MAX));
+}
+
+int zstd_seekable_read(struct abuf *in, ulong offset, struct abuf *out)
+{
+	const u8 *data = abuf_data(in);
+	ulong end = offset + abuf_size(out);
+	size_t c_start, c_end, d_start, d_end, window, skip;
+	struct zstd_seek_table st;
+	zstd_out_buffer zout;
+	zstd_in_buffer zin;
+	struct zstd_stream zs;
+	const u8 *entry;
+	bool found;
+	uint i;
+	int ret;
+
+	ret = zstd_find_seek_table(data, abuf_size(in), &st);
+	if (ret)
+		return ret;
+
+	/* find the frames which cover the range, and the largest window */
+	c_start = 0;
+	c_end = 0;
+	d_start = 0;
+	d_end = 0;
+	window = 0;
+	found = false;
+	for (i = 0, entry = st.entries; i < st.num_frames && d_end < end;
+	     i++, entry += st.entry_size) {
+		size_t csize = get_unaligned_le32(entry);
+		size_t dsize = get_unaligned_le32(entry + 4);
+
+		if (csize > st.data_size - c_end)
+			return log_msg_ret("ent", -EINVAL);
+		if (!found && offset >= d_end + dsize) {
+			c_start += csize;
+			d_start += dsize;
+		} else {
+			found = true;
+			window = max(window, zstd_frame_window(data + c_end,
+							       csize));
+		}
+		c_end += csize;
+		d_end += dsize;
+	}
+	if (!found || !abuf_size(out))
+		return 0;
+
+	ret = zstd_stream_init(&zs, window, false);
+	if (ret)
+		return log_msg_ret("init", ret);
+	zin.src = data + c_start;
+	zin.size = c_end - c_start;
+	zin.pos = 0;
+
+	/* decompress and discard the start of the first frame */
+	for (skip = offset - d_start; skip; skip -= zout.pos) {
+		zout.dst = abuf_data(out);
+		zout.size = min_t(size_t, skip, abuf_size(out));
+		zout.pos = 0;
+		ret = zstd_stream_feed(&zs, &zin, &zout);
+		if (ret)
+			goto err;
+		if (!zout.pos) {
+			ret = log_msg_ret("skip", -EINVAL);
+			goto err;
+		}
+	}
+
+	zout.dst = abuf_data(out);
+	zout.size = abuf_size(out);
+	zout.pos = 0;
+	ret = zstd_stream_feed(&zs, &zin, &zout);
+	if (ret)
+		goto err;
+	ret = zout.pos;
+
+err:
+	zstd_stream_free(&zs);
 	return ret;
 }
@@ -146,6 +146,11 @@ void tcp_stream_restart_rx_timer(struct tcp_stream *tcp)
 	tcp->time_last_rx = get_timer(0);
 }
 
+void tcp_stream_set_rcv_wnd(struct tcp_stream *tcp, ulong size)
+{
+	tcp->rcv_wnd = clamp_t(ulong, size, TCP_MSS, CONFIG_TCP_RCV_WND_MAX);
+}
+
 static void tcp_stream_init(struct tcp_stream *tcp,
 			    struct in_addr rhost, u16 rport, u16 lport)
 {
@@ -485,6 +490,9 @@ u16 tcp_set_pseudo_header(uchar *pkt, struct in_addr src, struct in_addr dest,
  */
 int net_set_ack_options(struct tcp_stream *tcp, union tcp_build_pkt *b)
 {
+	u8 sack_len;
+	int i, cnt;
+
 	b->sack.hdr.tcp_hlen = SHIFT_TO_TCPHDRLEN_FIELD(LEN_B_TO_DW(TCP_HDR_SIZE));
 
 	b->sack.t_opt.kind = TCP_O_TS;
@@ -495,31 +503,36 @@ int net_set_ack_options(struct tcp_stream *tcp, union tcp_build_pkt *b)
 	b->sack.sack_v.len = 0;
 
 	if (IS_ENABLED(CONFIG_PROT_TCP_SACK)) {
-		if (tcp->lost.len > TCP_OPT_LEN_2) {
+		/* report the lowest hills, as many as fit in the header */
+		sack_len = min_t(u8, tcp->lost.len,
+				 TCP_OPT_LEN_2 + TCP_SACK_BLOCKS * TCP_OPT_LEN_8);
+		if (sack_len > TCP_OPT_LEN_2) {
 			debug_cond(DEBUG_DEV_PKT, "TCP ack opt lost.len %x\n",
 				   tcp->lost.len);
-			b->sack.sack_v.len = tcp->lost.len;
+			b->sack.sack_v.len = sack_len;
 			b->sack.sack_v.kind = TCP_V_SACK;
-			b->sack.sack_v.hill[0].l = htonl(tcp->lost.hill[0].l);
-			b->sack.sack_v.hill[0].r = htonl(tcp->lost.hill[0].r);
 
 			/*
-			 * These SACK structures are initialized with NOPs to
-			 * provide TCP header alignment padding. There are 4
-			 * SACK structures used for both header padding and
-			 * internally.
+			 * The unused SACK structures are filled with NOPs to
+			 * provide TCP header alignment padding.
 			 */
-			b->sack.sack_v.hill[1].l = htonl(tcp->lost.hill[1].l);
-			b->sack.sack_v.hill[1].r = htonl(tcp->lost.hill[1].r);
-			b->sack.sack_v.hill[2].l = htonl(tcp->lost.hill[2].l);
-			b->sack.sack_v.hill[2].r = htonl(tcp->lost.hill[2].r);
-			b->sack.sack_v.hill[3].l = TCP_O_NOP;
-			b->sack.sack_v.hill[3].r = TCP_O_NOP;
+			cnt = (sack_len - TCP_OPT_LEN_2) / TCP_OPT_LEN_8;
+			for (i = 0; i < TCP_SACK_HILLS; i++) {
+				if (i < cnt) {
+					b->sack.sack_v.hill[i].l =
+						htonl(tcp->lost.hill[i].l);
+					b->sack.sack_v.hill[i].r =
+						htonl(tcp->lost.hill[i].r);
+				} else {
+					b->sack.sack_v.hill[i].l = TCP_O_NOP;
+					b->sack.sack_v.hill[i].r = TCP_O_NOP;
+				}
+			}
 		}
 
 		b->sack.hdr.tcp_hlen = SHIFT_TO_TCPHDRLEN_FIELD(ROUND_TCPHDR_LEN(TCP_HDR_SIZE +
 										 TCP_TSOPT_SIZE +
-										 tcp->lost.len));
+										 sack_len));
 	} else {
 		b->sack.sack_v.kind = 0;
 		b->sack.hdr.tcp_hlen = SHIFT_TO_TCPHDRLEN_FIELD(ROUND_TCPHDR_LEN(TCP_HDR_SIZE +
@@ -533,6 +546,22 @@ int net_set_ack_options(struct tcp_stream *tcp, union tcp_build_pkt *b)
 	return GET_TCP_HDR_LEN_IN_BYTES(b->sack.hdr.tcp_hlen);
 }
 
+/**
+ * tcp_wnd_scale() - get the window scale needed for a receive window
+ * @wnd: receive window in bytes
+ *
+ * Return: the smallest shift that brings @wnd into the 16-bit window field
+ */
+static u8 tcp_wnd_scale(u32 wnd)
+{
+	u8 scale = 0;
+
+	while (scale < TCP_MAX_SCALE && (wnd >> scale) > U16_MAX)
+		scale++;
+
+	return scale;
+}
+
 /**
  * net_set_syn_options() - set TCP options in SYN packets
  * @tcp: tcp stream
@@ -549,7 +578,8 @@ void net_set_syn_options(struct tcp_stream *tcp, union tcp_build_pkt *b)
 	b->ip.mss.len = TCP_OPT_LEN_4;
 	b->ip.mss.mss = htons(TCP_MSS);
 	b->ip.scale.kind = TCP_O_SCL;
-	b->ip.scale.scale = TCP_SCALE;
+	tcp->rcv_wnd_scale = tcp_wnd_scale(tcp->rcv_wnd);
+	b->ip.scale.scale = tcp->rcv_wnd_scale;
 	b->ip.scale.len = TCP_OPT_LEN_3;
 	if (IS_ENABLED(CONFIG_PROT_TCP_SACK)) {
 		b->ip.sack_p.kind = TCP_P_SACK;
@@ -656,7 +686,13 @@ int tcp_set_tcp_header(struct tcp_stream *tcp, uchar *pkt, int payload_len,
 	 * it is, then the u-boot tftp or nfs kernel netboot should be
 	 * considered.
 	 */
-	b->ip.hdr.tcp_win = htons(tcp->rcv_wnd >> TCP_SCALE);
+	/* the window in a SYN segment is never scaled (RFC 7323) */
+	if (action & TCP_SYN)
+		b->ip.hdr.tcp_win = htons(min_t(u32, tcp->rcv_wnd, U16_MAX));
+	else
+		b->ip.hdr.tcp_win = htons(min_t(u32,
+						tcp->rcv_wnd >> tcp->rcv_wnd_scale,
+						U16_MAX));
 
 	b->ip.hdr.tcp_xsum = 0;
 	b->ip.hdr.tcp_ugr = 0;
@@ -676,11 +712,11 @@ static void tcp_update_rcv_nxt(struct tcp_stream *tcp)
 		tcp->rcv_nxt = tcp->lost.hill[0].r;
 
 		memmove(&tcp->lost.hill[0], &tcp->lost.hill[1],
-			(TCP_SACK_HILLS - 1) * sizeof(struct sack_edges));
+			(TCP_RX_HILLS - 1) * sizeof(struct sack_edges));
 
 		tcp->lost.len -= TCP_OPT_LEN_8;
-		tcp->lost.hill[TCP_SACK_HILLS - 1].l = TCP_O_NOP;
-		tcp->lost.hill[TCP_SACK_HILLS - 1].r = TCP_O_NOP;
+		tcp->lost.hill[TCP_RX_HILLS - 1].l = TCP_O_NOP;
+		tcp->lost.hill[TCP_RX_HILLS - 1].r = TCP_O_NOP;
 	}
 }
 
@@ -731,7 +767,7 @@ void tcp_hole(struct tcp_stream *tcp, u32 tcp_seq_num, u32 len)
 
 			cnt -= cnt_move;
 			tcp->lost.len = TCP_OPT_LEN_2 + cnt * TCP_OPT_LEN_8;
-			for (j = cnt; j < TCP_SACK_HILLS; j++) {
+			for (j = cnt; j < TCP_RX_HILLS; j++) {
 				tcp->lost.hill[j].l = TCP_O_NOP;
 				tcp->lost.hill[j].r = TCP_O_NOP;
 			}
@@ -741,17 +777,18 @@ void tcp_hole(struct tcp_stream *tcp, u32 tcp_seq_num, u32 len)
 		return;
 	}
 
-	if (i == TCP_SACK_HILLS) {
+	if (i == TCP_RX_HILLS) {
 		tcp_update_rcv_nxt(tcp);
 		return;
 	}
 
-	if (cnt < TCP_SACK_HILLS) {
+	/* with all hills in use, the highest one is forgotten */
+	if (cnt < TCP_RX_HILLS) {
 		cnt_move = cnt - i;
 		cnt++;
 	} else {
-		cnt = TCP_SACK_HILLS;
-		cnt_move = TCP_SACK_HILLS - i;
+		cnt = TCP_RX_HILLS;
+		cnt_move = TCP_RX_HILLS - i - 1;
 	}
 
 	if (cnt_move > 0)
@@ -794,8 +831,16 @@ void tcp_parse_options(struct tcp_stream *tcp, uchar *o, int o_len)
 		case TCP_V_SACK:
 			break;
 		case TCP_O_SCL:
+			/*
+			 * Only a SYN may carry the option, and only an
+			 * active open sends one of its own
+			 */
+			if (tcp->state != TCP_SYN_SENT)
+				break;
 			wsopt = (struct tcp_scale *)p;
-			tcp->rmt_win_scale = wsopt->scale;
+			tcp->rmt_win_scale = min_t(u8, wsopt->scale,
+						   TCP_MAX_SCALE);
+			tcp->win_scale_ok = 1;
 			break;
 		case TCP_O_TS:
 			tsopt = (struct tcp_t_opt *)p;
@@ -984,10 +1029,12 @@ void tcp_rx_state_machine(struct tcp_stream *tcp,
 	 */
 	tcp_seq_num = ntohl(b->ip.hdr.tcp_seq);
 	tcp_ack_num = ntohl(b->ip.hdr.tcp_ack);
-	tcp_win_size = ntohs(b->ip.hdr.tcp_win) << tcp->rmt_win_scale;
-
 	tcp_flags = b->ip.hdr.tcp_flags;
 
+	tcp_win_size = ntohs(b->ip.hdr.tcp_win);
+	if (!(tcp_flags & TCP_SYN))
+		tcp_win_size <<= tcp->rmt_win_scale;
+
 //	printf("pkt: seq=%d, ack=%d, flags=%x, len=%d\n",
 //		tcp_seq_num - tcp->irs, tcp_ack_num - tcp->iss, tcp_flags, pkt_len);
 //	printf("tcp: rcv_nxt=%d, snd_una=%d, snd_nxt=%d\n\n",
@@ -1008,6 +1055,8 @@ void tcp_rx_state_machine(struct tcp_stream *tcp,
 
 		tcp->irs = tcp_seq_num;
 		tcp->rcv_nxt = tcp->irs + 1;
+		/* no window scaling, the SYN-ACK does not offer it */
+		tcp->rcv_wnd = min_t(u32, tcp->rcv_wnd, U16_MAX);
 
 		tcp->iss = tcp_get_start_seq();
 		tcp->snd_una = tcp->iss;
@@ -1044,6 +1093,11 @@ void tcp_rx_state_machine(struct tcp_stream *tcp,
 		/* stop retransmit of SYN */
 		tcp_stream_set_time_handler(tcp, 0, NULL);
 
+		if (!tcp->win_scale_ok) {
+			tcp->rcv_wnd_scale = 0;
+			tcp->rcv_wnd = min_t(u32, tcp->rcv_wnd, U16_MAX);
+		}
+
 		tcp->irs = tcp_seq_num;
 		tcp->rcv_nxt = tcp->irs + 1;
 		tcp->snd_una = tcp_ack_num;
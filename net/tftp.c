@@ -28,6 +28,10 @@ DECLARE_GLOBAL_DATA_PTR;
 #define TIMEOUT		5000UL
 /* Number of "loading" hashes per line (for checking the image size) */
 #define HASHES_PER_LINE	65
+/* Blocks beyond a lost one which can be kept until it is sent again */
+#define TFTP_EARLY_BLOCKS	256
+/* Lower limit on the retransmit timeout worked out from round trips */
+#define TFTP_RTO_MIN		100UL
 
 /*
  *	TFTP operations.
@@ -95,6 +99,40 @@ static ushort	tftp_windowsize;
 static ushort	tftp_next_ack;
 /* Last nack block we send */
 static ushort	tftp_last_nack;
+/* Window size to ask for, adapted to the loss seen so far */
+static ushort	tftp_window_adapt;
+/* Blocks received in order since the last loss */
+static ushort	tftp_window_clean;
+/* Blocks which overtook a lost one, by number counted from the start */
+static u8	tftp_early_map[TFTP_EARLY_BLOCKS / 8];
+/* Number of the short final block, if it overtook a lost one */
+static ulong	tftp_final_block;
+/* Smoothed round trip time in 1/8 ms, and its variation in 1/4 ms */
+static ulong	tftp_srtt;
+static ulong	tftp_rttvar;
+/* 1 once there is a round trip time sample */
+static int	tftp_rtt_valid;
+/* 1 while timing the round trip from the ACK of tftp_rtt_block */
+static int	tftp_rtt_timing;
+static ushort	tftp_rtt_block;
+static ulong	tftp_rtt_start;
+/* Time to wait for a block before sending the ACK again */
+static ulong	tftp_rto_ms;
+
+/**
+ * struct tftp_stats - statistics of a transfer, printed at the end
+ *
+ * @blocks:	Blocks received
+ * @early:	Blocks received ahead of a lost one, and kept
+ * @dups:	Blocks received again
+ * @reacks:	ACKs sent again, for lost blocks
+ */
+static struct tftp_stats {
+	ulong blocks;
+	ulong early;
+	ulong dups;
+	ulong reacks;
+} tftp_stats;
 #ifdef CONFIG_CMD_TFTPPUT
 /* 1 if writing, else 0 */
 static int	tftp_put_active;
@@ -150,10 +188,13 @@ static unsigned short tftp_block_size = TFTP_BLOCK_SIZE;
 static unsigned short tftp_block_size_option = CONFIG_TFTP_BLOCKSIZE;
 static unsigned short tftp_window_size_option = TFTP_WINDOWSIZE;
 
-static inline int store_block(int block, uchar *src, unsigned int len)
+/*
+ * Store a block at its place in memory. @block counts from the start of the
+ * transfer, without wrapping
+ */
+static inline int store_block(ulong block, uchar *src, unsigned int len)
 {
-	ulong offset = block * tftp_block_size + tftp_block_wrap_offset -
-			tftp_block_size;
+	ulong offset = (block - 1) * tftp_block_size;
 	ulong newsize = offset + len;
 	ulong store_addr = tftp_load_addr + offset;
 	void *ptr;
@@ -183,6 +224,8 @@ static void new_transfer(void)
 	tftp_prev_block = 0;
 	tftp_block_wrap = 0;
 	tftp_block_wrap_offset = 0;
+	memset(tftp_early_map, 0, sizeof(tftp_early_map));
+	tftp_final_block = 0;
 #ifdef CONFIG_CMD_TFTPPUT
 	tftp_put_final_block_sent = 0;
 #endif
@@ -277,6 +320,113 @@ static void update_block_number(void)
 	show_block_marker();
 }
 
+/* Number of the current block counted from the start, without wrapping */
+static ulong tftp_abs_block(void)
+{
+	return tftp_block_wrap * TFTP_SEQUENCE_SIZE + tftp_cur_block;
+}
+
+static bool tftp_early_test_clear(ulong block)
+{
+	u8 *p = &tftp_early_map[block % TFTP_EARLY_BLOCKS / 8];
+	u8 bit = BIT(block % 8);
+
+	if (!(*p & bit))
+		return false;
+	*p &= ~bit;
+
+	return true;
+}
+
+/**
+ * tftp_store_early() - keep a block which overtook a lost one
+ *
+ * The block is stored in place so that once the lost block is sent again,
+ * the ones after it need not be. Blocks too far ahead are dropped.
+ *
+ * @block:	Block number from the packet, ahead of the next one expected
+ * @src:	Block data
+ * @len:	Size of block data
+ * Return: 0 if OK, -1 on error
+ */
+static int tftp_store_early(ushort block, uchar *src, unsigned int len)
+{
+	ushort ahead = block - (ushort)tftp_cur_block;
+	ulong abs = tftp_abs_block() + ahead;
+	u8 *p = &tftp_early_map[abs % TFTP_EARLY_BLOCKS / 8];
+	u8 bit = BIT(abs % 8);
+
+	if (ahead > TFTP_EARLY_BLOCKS)
+		return 0;
+
+	if (*p & bit) {
+		tftp_stats.dups++;
+		return 0;
+	}
+
+	if (store_block(abs, src, len))
+		return -1;
+
+	*p |= bit;
+	tftp_stats.early++;
+	if (len < tftp_block_size)
+		tftp_final_block = abs;
+
+	return 0;
+}
+
+/*
+ * The window size is fixed once the server has agreed to it, so the window
+ * asked for by the next request is adapted instead: halved on each loss and
+ * grown by one block for each window received without loss, up to the
+ * configured size.
+ */
+static void tftp_window_loss(void)
+{
+	tftp_window_adapt = max(tftp_window_adapt / 2, 1);
+	tftp_window_clean = 0;
+}
+
+static void tftp_window_grow(void)
+{
+	if (++tftp_window_clean < tftp_window_adapt)
+		return;
+
+	tftp_window_clean = 0;
+	if (tftp_window_adapt < tftp_window_size_option)
+		tftp_window_adapt++;
+}
+
+/*
+ * Time the round trip from an ACK to the block following it, and work out
+ * the retransmit timeout from the smoothed time and its variation as TCP
+ * does (RFC 6298)
+ */
+static void tftp_rtt_update(ushort block)
+{
+	long rtt, err;
+
+	if (tftp_rtt_timing && block == (ushort)(tftp_rtt_block + 1)) {
+		tftp_rtt_timing = 0;
+		rtt = get_timer(tftp_rtt_start);
+		if (!tftp_rtt_valid) {
+			tftp_srtt = rtt << 3;
+			tftp_rttvar = rtt << 1;
+			tftp_rtt_valid = 1;
+		} else {
+			err = rtt - (tftp_srtt >> 3);
+			tftp_srtt += err;
+			if (err < 0)
+				err = -err;
+			tftp_rttvar += err - (tftp_rttvar >> 2);
+		}
+	}
+
+	if (tftp_rtt_valid)
+		tftp_rto_ms = clamp((tftp_srtt >> 3) + tftp_rttvar,
+				    TFTP_RTO_MIN, timeout_ms);
+}
+
 /* The TFTP get or put is complete */
 static void tftp_complete(void)
 {
@@ -295,6 +445,10 @@ static void tftp_complete(void)
 		print_size(net_boot_file_size /
 			time_start * 1000, "/s");
 	}
+	if (!tftp_put_active)
+		printf("\n\t %lu blocks, %lu out of order, %lu duplicate, %lu re-ACKed, window %d",
+		       tftp_stats.blocks, tftp_stats.early, tftp_stats.dups,
+		       tftp_stats.reacks, tftp_windowsize);
 	puts("\ndone\n");
 
 	led_activity_off();
@@ -357,9 +511,9 @@ static void tftp_send(void)
 		 * Implemented only for tftp get.
 		 * Don't bother sending if it's 1
 		 */
-		if (tftp_state == STATE_SEND_RRQ && tftp_window_size_option > 1)
+		if (tftp_state == STATE_SEND_RRQ && tftp_window_adapt > 1)
 			pkt += sprintf((char *)pkt, "windowsize%c%d%c",
-					0, tftp_window_size_option, 0);
+					0, tftp_window_adapt, 0);
 		len = pkt - xp;
 		break;
 
@@ -382,6 +536,11 @@ static void tftp_send(void)
 			tftp_put_final_block_sent = (loaded < toload);
 		}
 #endif
+		if (!tftp_put_active) {
+			tftp_rtt_block = tftp_cur_block;
+			tftp_rtt_start = get_timer(0);
+			tftp_rtt_timing = 1;
+		}
 		len = pkt - xp;
 		break;
 
@@ -456,6 +615,8 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 	__be16 *s;
 	int i;
 	u16 timeout_val_rcvd;
+	ushort block;
+	bool early;
 
 	if (dest != tftp_our_port) {
 			return;
@@ -592,18 +753,26 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			return;
 		len -= 2;
 
-		if (ntohs(*(__be16 *)pkt) != (ushort)(tftp_cur_block + 1)) {
+		block = ntohs(*(__be16 *)pkt);
+		if (block != (ushort)(tftp_cur_block + 1)) {
 			debug("Received unexpected block: %d, expected: %d\n",
-			      ntohs(*(__be16 *)pkt),
-			      (ushort)(tftp_cur_block + 1));
+			      block, (ushort)(tftp_cur_block + 1));
 			/*
 			 * Only ACK if the block count received is greater than
 			 * the expected block count, otherwise skip ACK.
 			 * (required to properly handle the server retransmitting
 			 *  the window)
 			 */
-			if ((ushort)(tftp_cur_block + 1) - (short)(ntohs(*(__be16 *)pkt)) > 0)
+			if ((ushort)(tftp_cur_block + 1) - (short)block > 0) {
+				tftp_stats.dups++;
 				break;
+			}
+			if (tftp_state == STATE_DATA &&
+			    tftp_store_early(block, pkt + 2, len)) {
+				eth_halt_state_only();
+				net_set_state(NETLOOP_FAIL);
+				break;
+			}
 			/*
 			 * If one packet is dropped most likely
 			 * all other buffers in the window
@@ -612,6 +781,9 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			 */
 			if (tftp_last_nack != tftp_cur_block) {
 				tftp_send();
+				tftp_rtt_timing = 0;
+				tftp_stats.reacks++;
+				tftp_window_loss();
 				tftp_last_nack = tftp_cur_block;
 				tftp_next_ack = (ushort)(tftp_cur_block +
 							 tftp_windowsize);
@@ -619,6 +791,7 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			break;
 		}
 
+		tftp_rtt_update(block);
 		tftp_cur_block++;
 		tftp_cur_block %= TFTP_SEQUENCE_SIZE;
 
@@ -652,16 +825,31 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 		update_block_number();
 		tftp_prev_block = tftp_cur_block;
 		timeout_count_max = tftp_timeout_count_max;
-		net_set_timeout_handler(timeout_ms, tftp_timeout_handler);
+		net_set_timeout_handler(tftp_rto_ms, tftp_timeout_handler);
 
-		if (store_block(tftp_cur_block, pkt + 2, len)) {
+		if (store_block(tftp_abs_block(), pkt + 2, len)) {
 			eth_halt_state_only();
 			net_set_state(NETLOOP_FAIL);
 			break;
 		}
 		timeout_count = 0;
+		tftp_stats.blocks++;
+		tftp_window_grow();
+
+		/* Move past the blocks which overtook this one */
+		early = false;
+		while (len == tftp_block_size &&
+		       tftp_early_test_clear(tftp_abs_block() + 1)) {
+			tftp_cur_block = (tftp_cur_block + 1) % TFTP_SEQUENCE_SIZE;
+			update_block_number();
+			tftp_prev_block = tftp_cur_block;
+			tftp_stats.blocks++;
+			tftp_window_grow();
+			early = true;
+		}
 
-		if (len < tftp_block_size) {
+		if (len < tftp_block_size ||
+		    tftp_abs_block() == tftp_final_block) {
 			tftp_send();
 			tftp_complete();
 			break;
@@ -669,11 +857,14 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 
 		/*
 		 *	Acknowledge the block just received, which will prompt
-		 *	the remote for the next one.
+		 *	the remote for the next one. Do so straight away after
+		 *	moving past blocks which came early, so that the remote
+		 *	does not send them again.
 		 */
-		if (tftp_cur_block == tftp_next_ack) {
+		if (early || tftp_cur_block == tftp_next_ack) {
 			tftp_send();
-			tftp_next_ack += tftp_windowsize;
+			tftp_next_ack = (ushort)(tftp_cur_block +
+						 tftp_windowsize);
 		}
 		break;
 
@@ -704,6 +895,22 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 
 static void tftp_timeout_handler(void)
 {
+	/*
+	 * A block lost at the end of a window leaves both ends waiting, so
+	 * ACK again once the round trip time says the next block is overdue,
+	 * backing off towards the full timeout which counts as a retry
+	 */
+	if (tftp_state == STATE_DATA && !tftp_put_active &&
+	    tftp_rto_ms < timeout_ms) {
+		tftp_rto_ms = min(tftp_rto_ms * 2, timeout_ms);
+		net_set_timeout_handler(tftp_rto_ms, tftp_timeout_handler);
+		tftp_send();
+		tftp_rtt_timing = 0;
+		tftp_stats.reacks++;
+		tftp_window_loss();
+		return;
+	}
+
 	if (++timeout_count > timeout_count_max) {
 		restart("Retry count exceeded");
 	} else {
@@ -936,6 +1143,14 @@ void tftp_start(enum proto_t protocol)
 	tftp_cur_block = 0;
 	tftp_windowsize = 1;
 	tftp_last_nack = 0;
+	if (!tftp_window_adapt ||
+	    tftp_window_adapt > tftp_window_size_option)
+		tftp_window_adapt = tftp_window_size_option;
+	tftp_window_clean = 0;
+	tftp_rtt_valid = 0;
+	tftp_rtt_timing = 0;
+	tftp_rto_ms = timeout_ms;
+	memset(&tftp_stats, 0, sizeof(tftp_stats));
 	/* zero out server ether in case the server ip has changed */
 	memset(net_server_ethaddr, 0, 6);
 	/* Revert tftp_block_size to dflt */
@@ -976,6 +1191,10 @@ void tftp_start_server(void)
 	tftp_our_port = WELL_KNOWN_PORT;
 	tftp_windowsize = 1;
 	tftp_next_ack = tftp_windowsize;
+	tftp_rtt_valid = 0;
+	tftp_rtt_timing = 0;
+	tftp_rto_ms = timeout_ms;
+	memset(&tftp_stats, 0, sizeof(tftp_stats));
 
 #ifdef CONFIG_TFTP_TSIZE
 	tftp_tsize = 0;
@@ -236,6 +236,15 @@ end:
 
 static int tcp_stream_rx(struct tcp_stream *tcp, u32 rx_offs, void *buf, int len)
 {
+	/*
+	 * Until the end of the HTTP header is known, data is stored as it
+	 * comes in the stream and moved down afterwards. Keep that to the
+	 * part that can hold the header; later segments are left for the
+	 * server to send again.
+	 */
+	if (!http_hdr_size && rx_offs >= HTTP_MAX_HDR_LEN)
+		return 0;
+
 	if ((max_rx_pos == (u32)(-1)) || (max_rx_pos < rx_offs + len - 1))
 		max_rx_pos = rx_offs + len - 1;
 
@@ -270,6 +279,27 @@ static int tcp_stream_tx(struct tcp_stream *tcp, u32 tx_offs, void *buf, int max
 	return ret;
 }
 
+/**
+ * wget_rcv_wnd() - work out the TCP receive window
+ *
+ * Every segment is copied to its final place in the destination, whatever
+ * order it arrives in, so the window can cover all of the room left there
+ * plus the HTTP header in front of the data.
+ *
+ * Return: receive window in bytes
+ */
+static ulong wget_rcv_wnd(void)
+{
+	ulong room = wget_info->buffer_size;
+
+	if (!room && CONFIG_IS_ENABLED(LMB))
+		room = lmb_get_free_size(image_load_addr);
+	if (!room)
+		return ULONG_MAX;
+
+	return room + HTTP_MAX_HDR_LEN;
+}
+
 static int tcp_stream_on_create(struct tcp_stream *tcp)
 {
 	if (tcp->rhost.s_addr != web_server_ip.s_addr ||
@@ -282,6 +312,7 @@ static int tcp_stream_on_create(struct tcp_stream *tcp)
 	tcp->on_rcv_nxt_update = tcp_stream_on_rcv_nxt_update;
 	tcp->rx = tcp_stream_rx;
 	tcp->tx = tcp_stream_tx;
+	tcp_stream_set_rcv_wnd(tcp, wget_rcv_wnd());
 
 	return 1;
 }
@@ -0,0 +1,300 @@
+/* host harness: simulated HTTP server with loss/reorder driving tcp.c + wget.c */
+#include <net.h>
+#include <net/tcp.h>
+#include <net/wget.h>
+#include <lmb.h>
+#include <linux/unaligned/be_byteshift.h>
+#define LEN_B_TO_DW(x) ((x) >> 2)
+#define SHIFT_TO_TCPHDRLEN_FIELD(x) ((x) << 4)
+
+extern void *mmap(void *, unsigned long, int, int, int, long);
+extern long strtol(const char *, char **, int);
+extern char *getenv(const char *);
+extern void exit(int);
+
+ulong now;
+uchar txb[2048]; uchar *net_tx_packet = txb;
+u32 net_boot_file_size; ulong image_load_addr; u32 net_boot_file_expected_size_in_blocks;
+char net_boot_file_name[1024]; struct in_addr net_ip, net_server_ip, net_gateway, net_netmask;
+enum net_loop_state net_state; u8 net_server_ethaddr[6]; char *net_dns_resolve, *net_dns_env_var;
+struct wget_http_info default_wget_info, *wget_info;
+static int quiet = 1, verbose;
+
+ulong get_timer(ulong base) { return now - base; }
+unsigned long long get_ticks(void) { return now; }
+int net_eth_hdr_size(void) { return 14; }
+unsigned compute_ip_checksum(const void *a, unsigned l) { return 0; }
+void net_set_ip_header(uchar *pkt, struct in_addr d, struct in_addr s, u16 l, u8 p) {}
+void *map_physmem(phys_addr_t paddr, unsigned long len, unsigned long flags) { return (void *)(ulong)paddr; }
+void unmap_physmem(const void *v, unsigned long flags) {}
+int lmb_alloc_mem(enum lmb_mem_type type, u64 align, phys_addr_t *addr, phys_size_t size, u32 flags) { return 0; }
+phys_size_t lmb_get_free_size(phys_addr_t a) { return 0; }
+char *env_get(const char *n) { return NULL; }
+ulong env_get_ulong(const char *n, int b, ulong d) { return d; }
+int env_set_hex(const char *n, ulong v) { return 0; }
+void efi_set_bootdev(const char *a, const char *b, const char *c, void *d, size_t e) {}
+struct in_addr string_to_ip(const char *s) { struct in_addr a = { 0x0100000a }; return a; }
+void print_size(u64 s, const char *x) {}
+void putc(const char c) { if (!quiet) printf("%c", c); }
+void puts(const char *s) { if (!quiet) printf("%s", s); }
+int net_loop(enum proto_t p) { return 0; }
+char *sandbox_strdup(const char *s) { return 0; }
+void dlfree(void *p) {}
+int _log(enum log_category_t c, enum log_level_t l, const char *f, int n, const char *fn, const char *fmt, ...) { return 0; }
+
+/* ---- simulated server ---- */
+#define SMSS 1448
+static uchar *stream; static long T;		/* header + body */
+static long hdrlen;
+static int R = 80;				/* RTT ticks; 1 tick = 1 frame time */
+static int loss_pm, reorder_pm, server_ws = 7;
+static unsigned rnd = 1;
+static unsigned rr(void) { rnd = rnd * 1103515245 + 12345; return (rnd >> 8) & 0xffff; }
+
+struct q { ulong t; long seq; int kind; long off; int len; };	/* kind 0 data, 1 synack, 2 fin, 3 ack */
+static struct q qs[1 << 20]; static int qn; static long qseq;
+static ulong link_free;
+
+static u32 s_iss = 0x7ffff000;	/* make the seq numbers wrap */
+static u32 c_nxt;			/* client seq next */
+static int got_get, c_ws = -1, c_syn_wnd;
+static long una, nxt, fin_sent, max_inflight, rtx, sent_total, maxwnd;
+static ulong last_progress;
+static unsigned char *sacked; static ulong *rtx_at;
+static long rwnd;
+
+static void enq(int kind, long off, int len)
+{
+	struct q *p;
+	ulong t;
+
+	if (kind != 3 && (int)(rr() % 1000) < loss_pm)
+		return;
+	t = (link_free > now ? link_free : now);
+	if (kind == 0)
+		link_free = t + 1;
+	t += R / 2;
+	if (kind == 0 && (int)(rr() % 1000) < reorder_pm)
+		t += 1 + rr() % 20;
+	p = &qs[qn++];
+	p->t = t; p->seq = qseq++; p->kind = kind; p->off = off; p->len = len;
+}
+
+static void send_seg(long off)
+{
+	int len = T - off < SMSS ? T - off : SMSS;
+
+	enq(0, off, len);
+	sent_total++;
+}
+
+static void server_push(void)
+{
+	long i, end, hi;
+
+	if (!got_get)
+		return;
+	/* fast retransmit: unsacked segments below the highest sacked one */
+	for (hi = (nxt + SMSS - 1) / SMSS - 1; hi >= 0 && !sacked[hi]; hi--)
+		;
+	for (i = una / SMSS; i < hi; i++) {
+		if (sacked[i] || (rtx_at[i] && now - rtx_at[i] < 2 * R))
+			continue;
+		rtx_at[i] = now;
+		rtx++;
+		send_seg(i * SMSS);
+	}
+	end = una + rwnd;
+	while (nxt < T && nxt < end) {
+		rtx_at[nxt / SMSS] = now;
+		send_seg(nxt);
+		nxt += SMSS;
+		if (nxt > T)
+			nxt = T;
+	}
+	if (nxt - una > max_inflight)
+		max_inflight = nxt - una;
+	if (nxt == T && !fin_sent) {
+		fin_sent = 1;
+		enq(2, T, 0);
+	}
+}
+
+int net_send_tcp_packet(int payload_len, struct in_addr dhost, int dport,
+			int sport, u8 action, u32 seq, u32 ack)
+{
+	struct tcp_stream *tcp = tcp_stream_get(0, dhost, dport, sport);
+	uchar *pkt = net_tx_packet + 14;
+	union tcp_build_pkt *b = (void *)pkt;
+	int hdr = tcp_set_tcp_header(tcp, pkt, payload_len, action, seq, ack);
+	uchar *o = pkt + IP_TCP_HDR_SIZE, *oe = pkt + hdr;
+	long a, i, l, r;
+	u32 w = ntohs(b->ip.hdr.tcp_win);
+
+	if (action & TCP_SYN) {
+		for (; o < oe && *o; o += (*o == 1) ? 1 : o[1])
+			if (*o == TCP_O_SCL)
+				c_ws = o[2];
+		c_syn_wnd = w;
+		{ extern u16 harness_lport; harness_lport = sport; }
+		c_nxt = seq + 1;
+		enq(1, 0, 0);
+		return 0;
+	}
+	if (action & TCP_RST) {
+		printf("client RST\n");
+		return 0;
+	}
+	rwnd = (long)w << (server_ws >= 0 && c_ws >= 0 ? c_ws : 0);
+	if (rwnd > maxwnd)
+		maxwnd = rwnd;
+	if (payload_len) {
+		got_get = 1;
+		c_nxt = seq + payload_len;
+	}
+	if (action & TCP_FIN) {
+		c_nxt = seq + payload_len + 1;
+		enq(3, 0, 0);
+	}
+	a = (long)(u32)(ack - s_iss - 1);
+	if (a > T)
+		a = T;		/* fin */
+	if (a > una) {
+		una = a;
+		last_progress = now;
+	}
+	for (; o < oe && *o; o += (*o == 1) ? 1 : o[1]) {
+		if (*o != TCP_V_SACK)
+			continue;
+		for (i = 0; i < (o[1] - 2) / 8; i++) {
+			l = (u32)(get_unaligned_be32(o + 2 + 8 * i) - s_iss - 1);
+			r = (u32)(get_unaligned_be32(o + 6 + 8 * i) - s_iss - 1);
+			for (a = (l + SMSS - 1) / SMSS; (a + 1) * SMSS <= r ||
+			     (a * SMSS < r && r == T); a++)
+				sacked[a] = 1;
+		}
+	}
+	server_push();
+	return 0;
+}
+
+static void deliver(struct q *p)
+{
+	static union tcp_build_pkt b;
+	int opt = 0;
+
+	memset(&b, 0, 64);
+	b.ip.hdr.ip_src.s_addr = 0x0100000a;
+	b.ip.hdr.ip_p = IPPROTO_TCP;
+	b.ip.hdr.tcp_src = htons(80);
+	b.ip.hdr.tcp_ack = htonl(c_nxt);
+	b.ip.hdr.tcp_win = htons(65535);
+	switch (p->kind) {
+	case 1:
+		b.ip.hdr.tcp_seq = htonl(s_iss);
+		b.ip.hdr.tcp_flags = TCP_SYN | TCP_ACK;
+		if (server_ws >= 0) {
+			uchar *o = (uchar *)&b + IP_TCP_HDR_SIZE;
+			o[0] = 1; o[1] = 3; o[2] = 3; o[3] = server_ws;
+			opt = 4;
+		}
+		break;
+	case 0:
+		b.ip.hdr.tcp_seq = htonl(s_iss + 1 + p->off);
+		b.ip.hdr.tcp_flags = TCP_ACK | TCP_PUSH;
+		memcpy((uchar *)&b + IP_TCP_HDR_SIZE, stream + p->off, p->len);
+		break;
+	case 2:
+		b.ip.hdr.tcp_seq = htonl(s_iss + 1 + T);
+		b.ip.hdr.tcp_flags = TCP_ACK | TCP_FIN;
+		break;
+	case 3:
+		b.ip.hdr.tcp_seq = htonl(s_iss + 2 + T);
+		b.ip.hdr.tcp_flags = TCP_ACK;
+		break;
+	}
+	b.ip.hdr.tcp_hlen = SHIFT_TO_TCPHDRLEN_FIELD(LEN_B_TO_DW(TCP_HDR_SIZE + opt));
+	extern u16 harness_lport;
+	b.ip.hdr.tcp_dst = htons(harness_lport);
+	rxhand_tcp_f(&b, IP_TCP_HDR_SIZE + opt + p->len);
+}
+
+u16 harness_lport;
+extern struct tcp_stream *tcp_stream_get(int, struct in_addr, u16, u16);
+
+int main(int argc, char **argv)
+{
+	long flen = strtol(argv[1], 0, 0), i, buf;
+	uchar *mem;
+	char *h;
+	int best;
+
+	loss_pm = strtol(argv[2], 0, 0);
+	reorder_pm = strtol(argv[3], 0, 0);
+	server_ws = strtol(argv[4], 0, 0);
+	buf = strtol(argv[5], 0, 0);
+	rnd = strtol(argv[6], 0, 0);
+	verbose = argc > 7;
+
+	mem = mmap((void *)0x10000000, 0x20000000, 3, 0x22, -1, 0);
+	stream = mem + 0x10000000;
+	h = (char *)stream;
+	hdrlen = snprintf(h, 200, "HTTP/1.1 200 OK\r\nContent-Length: %ld\r\n\r\n", flen);
+	for (i = 0; i < flen; i++)
+		stream[hdrlen + i] = rr() ^ i;
+	T = hdrlen + flen;
+	sacked = mem + 0x18000000;
+	rtx_at = (void *)(mem + 0x19000000);
+	image_load_addr = (ulong)mem;
+	memset(mem, 0xaa, flen + 8192);
+	wget_info = &default_wget_info;
+	wget_info->buffer_size = buf;
+	wget_info->silent = 1;
+	strcpy(net_boot_file_name, "10.0.0.1:/f");
+	net_ip.s_addr = 0x0200000a;
+	net_state = NETLOOP_CONTINUE;
+	tcp_init();
+	wget_start();
+	{
+		extern struct tcp_stream *tcp_stream_get(int, struct in_addr, u16, u16);
+	}
+	for (;;) {
+		struct q tmp;
+
+		if (net_state != NETLOOP_CONTINUE)
+			break;
+		if (!qn) {
+			if (now - last_progress > 4 * R && una < T && got_get) {
+				/* RTO */
+				memset(rtx_at, 0, sizeof(ulong) * (T / SMSS + 2));
+				nxt = una;
+				fin_sent = 0;
+				last_progress = now;
+				server_push();
+				continue;
+			}
+			now++;
+			tcp_streams_poll();
+			if (now > 100000000) {
+				printf("stuck una=%ld T=%ld\n", una, T);
+				return 1;
+			}
+			continue;
+		}
+		best = 0;
+		for (i = 1; i < qn; i++)
+			if (qs[i].t < qs[best].t ||
+			    (qs[i].t == qs[best].t && qs[i].seq < qs[best].seq))
+				best = i;
+		if (qs[best].t > now)
+			now = qs[best].t;
+		tmp = qs[best];
+		qs[best] = qs[--qn];
+		deliver(&tmp);
+	}
+	printf("state=%d size=%u ticks=%lu c_ws=%d syn_wnd=%d maxwnd=%ld maxinflight=%ld sent=%ld rtx=%ld goodput=%.3f %s\n",
+	       net_state, net_boot_file_size, now, c_ws, c_syn_wnd, maxwnd,
+	       max_inflight, sent_total, rtx, (double)flen / SMSS / now,
+	       memcmp(mem, stream + hdrlen, flen) ? "CORRUPT" : "ok");
+	return 0;
+}
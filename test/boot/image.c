@@ -7,6 +7,7 @@
  */
 
 #include <image.h>
+#include <malloc.h>
 #include <test/ut.h>
 #include "bootstd_common.h"
 
@@ -32,3 +33,218 @@ static int test_image_phase(struct unit_test_state *uts)
 	return 0;
 }
 BOOTSTD_TEST(test_image_phase, 0);
+
+/*
+ * Create a FIT with one image, with a hash node for each of @algos. If
+ * @chunk_size is not 0, the hashes are chunked, as mkimage does when the hash
+ * node has a chunk-size property.
+ */
+static int create_hash_fit(struct unit_test_state *uts, void *fit, int size,
+			   const void *data, int len, const char *const *algos,
+			   int count, ulong chunk_size, bool sig)
+{
+	u8 value[FIT_MAX_HASH_LEN], table[16 * FIT_MAX_HASH_LEN];
+	struct hash_algo *algo;
+	int table_len = 0;
+	char name[16];
+	int i, pos;
+
+	ut_assertok(fdt_create(fit, size));
+	ut_assertok(fdt_finish_reservemap(fit));
+	ut_assertok(fdt_begin_node(fit, ""));
+	ut_assertok(fdt_begin_node(fit, "images"));
+	ut_assertok(fdt_begin_node(fit, "kernel-1"));
+	ut_assertok(fdt_property(fit, FIT_DATA_PROP, data, len));
+	for (i = 0; i < count; i++) {
+		ut_assertok(hash_lookup_algo(algos[i], &algo));
+		if (chunk_size) {
+			for (pos = 0, table_len = 0; pos < len;
+			     pos += chunk_size, table_len += algo->digest_size) {
+				ut_assert(table_len < sizeof(table));
+				algo->hash_func_ws(data + pos,
+						   min_t(ulong, chunk_size,
+							 len - pos),
+						   table + table_len,
+						   algo->chunk_size);
+			}
+			algo->hash_func_ws(table, table_len, value,
+					   algo->chunk_size);
+		} else {
+			algo->hash_func_ws(data, len, value, algo->chunk_size);
+		}
+		snprintf(name, sizeof(name), "%s-%d", FIT_HASH_NODENAME, i + 1);
+		ut_assertok(fdt_begin_node(fit, name));
+		ut_assertok(fdt_property_string(fit, FIT_ALGO_PROP, algos[i]));
+		if (chunk_size) {
+			ut_assertok(fdt_property_u32(fit, FIT_CHUNK_SIZE_PROP,
+						     chunk_size));
+			ut_assertok(fdt_property(fit, FIT_CHUNK_VALUE_PROP,
+						 table, table_len));
+		}
+		ut_assertok(fdt_property(fit, FIT_VALUE_PROP, value,
+					 algo->digest_size));
+		ut_assertok(fdt_end_node(fit));
+	}
+	if (sig) {
+		ut_assertok(fdt_begin_node(fit, FIT_SIG_NODENAME "-1"));
+		ut_assertok(fdt_property_string(fit, FIT_ALGO_PROP,
+						"sha256,rsa2048"));
+		ut_assertok(fdt_end_node(fit));
+	}
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_end_node(fit));
+	ut_assertok(fdt_finish(fit));
+
+	return 0;
+}
+
+/* Test checking the hashes of an image in pieces */
+static int test_image_hash_stream(struct unit_test_state *uts)
+{
+	static const char *const algos[] = { "sha256", "crc32", "sha1" };
+	static const char *const md5[] = { "md5" };
+	struct fit_hash_stream hs;
+	char fit[0x2000], keys[0x100];
+	const int len = 3000;
+	ulong pos, size, count;
+	u8 *data;
+	int node;
+	int i;
+
+	if (!IS_ENABLED(CONFIG_FIT_HASH_STREAM))
+		return -EAGAIN;
+
+	/* an empty key blob, so that no signatures are required */
+	ut_assertok(fdt_create_empty_tree(keys, sizeof(keys)));
+
+	data = malloc(len);
+	ut_assertnonnull(data);
+	for (i = 0; i < len; i++)
+		data[i] = i * 7 + (i >> 8);
+
+	ut_assertok(create_hash_fit(uts, fit, sizeof(fit), data, len, algos,
+				    ARRAY_SIZE(algos), 0, false));
+	node = fdt_path_offset(fit, FIT_IMAGES_PATH "/kernel-1");
+	ut_assert(node >= 0);
+
+	/* feed the data in uneven pieces */
+	ut_assertok(fit_image_hash_stream_init(&hs, fit, node, keys));
+	ut_asserteq(ARRAY_SIZE(algos), hs.count);
+	for (pos = 0, size = 1; pos < len; pos += count, size = size * 3 + 1) {
+		count = min(size, len - pos);
+		ut_assertok(fit_image_hash_stream_update(&hs, data + pos,
+							 count));
+	}
+	ut_assertok(fit_image_hash_stream_finish(&hs));
+
+	/* a change in the data must be caught */
+	data[len - 1] ^= 1;
+	ut_assertok(fit_image_hash_stream_init(&hs, fit, node, keys));
+	ut_assertok(fit_image_hash_stream_update(&hs, data, len));
+	ut_asserteq(-EBADMSG, fit_image_hash_stream_finish(&hs));
+	data[len - 1] ^= 1;
+
+	/* nothing is checked if the stream is aborted */
+	ut_assertok(fit_image_hash_stream_init(&hs, fit, node, keys));
+	fit_image_hash_stream_abort(&hs);
+	ut_asserteq(0, hs.count);
+
+	/* md5 has no progressive support, so needs the full check */
+	ut_assertok(create_hash_fit(uts, fit, sizeof(fit), data, len, md5, 1,
+				    0, false));
+	node = fdt_path_offset(fit, FIT_IMAGES_PATH "/kernel-1");
+	ut_asserteq(-EPROTONOSUPPORT,
+		    fit_image_hash_stream_init(&hs, fit, node, keys));
+
+	/* so does a signed image */
+	if (CONFIG_IS_ENABLED(FIT_SIGNATURE)) {
+		ut_assertok(create_hash_fit(uts, fit, sizeof(fit), data, len,
+					    algos, 1, 0, true));
+		node = fdt_path_offset(fit, FIT_IMAGES_PATH "/kernel-1");
+		ut_asserteq(-EPROTONOSUPPORT,
+			    fit_image_hash_stream_init(&hs, fit, node, keys));
+	}
+	free(data);
+
+	return 0;
+}
+BOOTSTD_TEST(test_image_hash_stream, 0);
+
+/* Test checking an image against a table of chunk hashes */
+static int test_image_hash_chunks(struct unit_test_state *uts)
+{
+	static const char *const algos[] = { "sha256", "crc32" };
+	struct fit_hash_stream hs;
+	char fit[0x2000], keys[0x100];
+	const int len = 3000, chunk = 256;
+	const u8 *table;
+	ulong chunk_size;
+	int table_len;
+	u8 *data;
+	int node;
+	int i;
+
+	ut_assertok(fdt_create_empty_tree(keys, sizeof(keys)));
+	data = malloc(len);
+	ut_assertnonnull(data);
+	for (i = 0; i < len; i++)
+		data[i] = i * 13 + (i >> 8);
+
+	ut_assertok(create_hash_fit(uts, fit, sizeof(fit), data, len, algos,
+				    ARRAY_SIZE(algos), chunk, false));
+	node = fdt_path_offset(fit, FIT_IMAGES_PATH "/kernel-1");
+	ut_assert(node >= 0);
+	ut_assertok(fit_image_hash_get_chunks(fit, fdt_subnode_offset(fit, node,
+								       "hash-1"),
+					      &chunk_size, &table, &table_len));
+	ut_asserteq(chunk, chunk_size);
+	ut_asserteq(12 * 32, table_len);
+
+	/* the full check covers the table and each chunk */
+	ut_asserteq(1, fit_image_verify_with_data(fit, node, keys, data, len));
+	ut_asserteq(0, fit_image_verify_with_data(fit, node, keys, data,
+						  len - 1));
+	data[1000] ^= 0x40;
+	ut_asserteq(0, fit_image_verify_with_data(fit, node, keys, data, len));
+	data[1000] ^= 0x40;
+
+	if (!IS_ENABLED(CONFIG_FIT_HASH_STREAM))
+		return 0;
+
+	ut_assertok(fit_image_hash_stream_init(&hs, fit, node, keys));
+	ut_assertok(fit_image_hash_stream_update(&hs, data, 1000));
+	ut_assertok(fit_image_hash_stream_update(&hs, data + 1000, len - 1000));
+	ut_assertok(fit_image_hash_stream_finish(&hs));
+
+	/* a bad chunk is reported as soon as it is complete */
+	data[1000] ^= 0x40;
+	ut_assertok(fit_image_hash_stream_init(&hs, fit, node, keys));
+	ut_assertok(fit_image_hash_stream_update(&hs, data, 1023));
+	ut_asserteq(-EBADMSG, fit_image_hash_stream_update(&hs, data + 1023,
+							    1));
+	data[1000] ^= 0x40;
+
+	/* the image must have exactly the right length */
+	ut_assertok(fit_image_hash_stream_init(&hs, fit, node, keys));
+	ut_assertok(fit_image_hash_stream_update(&hs, data, len - 1));
+	ut_asserteq(-EBADMSG, fit_image_hash_stream_finish(&hs));
+
+	ut_assertok(fit_image_hash_stream_init(&hs, fit, node, keys));
+	ut_assertok(fit_image_hash_stream_update(&hs, data, len));
+	ut_assertok(fit_image_hash_stream_update(&hs, data, 1));
+	ut_asserteq(-EBADMSG, fit_image_hash_stream_finish(&hs));
+
+	/* a bad table is left for the full check to report */
+	ut_assertok(fdt_setprop_inplace_u32(fit,
+					    fdt_subnode_offset(fit, node,
+							       "hash-1"),
+					    FIT_CHUNK_SIZE_PROP, 0));
+	ut_asserteq(-EPROTONOSUPPORT,
+		    fit_image_hash_stream_init(&hs, fit, node, keys));
+	ut_asserteq(0, fit_image_verify_with_data(fit, node, keys, data, len));
+	free(data);
+
+	return 0;
+}
+BOOTSTD_TEST(test_image_hash_chunks, 0);
@@ -0,0 +1,26 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for aes command
+ */
+
+#include <command.h>
+#include <dm/test.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+static int dm_test_cmd_aes_bench(struct unit_test_state *uts)
+{
+	ut_assertok(run_command("aes.256 bench 1000", 0));
+	ut_assert_nextlinen("aes-256 cbc encrypt ");
+	ut_assert(strstr(uts->actual_str, " MiB/s"));
+	ut_assert_nextlinen("aes-256 cbc decrypt ");
+	ut_assert_nextlinen("aes-256 ctr ");
+	ut_assert_nextlinen("aes-256 gcm encrypt ");
+	ut_assert_console_end();
+
+	/* less than one block */
+	ut_assert(run_command("aes bench f", 0));
+
+	return 0;
+}
+DM_TEST(dm_test_cmd_aes_bench, UTF_CONSOLE);
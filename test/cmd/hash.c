@@ -103,3 +103,58 @@ static int dm_test_cmd_hash_sha256(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_cmd_hash_sha256, UTF_CONSOLE);
+
+static int dm_test_cmd_hash_multi(struct unit_test_state *uts)
+{
+	if (!CONFIG_IS_ENABLED(MD5) || !CONFIG_IS_ENABLED(SHA256))
+		return -EAGAIN;
+
+	ut_assertok(run_command("hash md5,sha256 $loadaddr 0", 0));
+	console_record_readline(uts->actual_str, sizeof(uts->actual_str));
+	ut_asserteq_ptr(uts->actual_str,
+			strstr(uts->actual_str, "md5 for "));
+	ut_assert(strstr(uts->actual_str,
+			 "d41d8cd98f00b204e9800998ecf8427e"));
+	console_record_readline(uts->actual_str, sizeof(uts->actual_str));
+	ut_asserteq_ptr(uts->actual_str,
+			strstr(uts->actual_str, "sha256 for "));
+	ut_assert(strstr(uts->actual_str,
+			 "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"));
+	ut_assert_console_end();
+
+	/* several digests cannot be stored */
+	ut_assert(run_command("hash md5,sha256 $loadaddr 0 foo", 0));
+	ut_assertok(ut_check_console_line(uts,
+					  "hash - compute hash message digest"));
+	console_record_reset_enable();
+
+	ut_assert(run_command("hash md5,bogus $loadaddr 0", 0));
+	ut_assert_nextlinen("Cannot hash with 'md5,bogus'");
+	ut_assert_console_end();
+
+	return 0;
+}
+DM_TEST(dm_test_cmd_hash_multi, UTF_CONSOLE);
+
+static int dm_test_cmd_hash_bench(struct unit_test_state *uts)
+{
+	ut_assertok(run_command("hash bench 1000", 0));
+	if (CONFIG_IS_ENABLED(MD5))
+		ut_assert_nextlinen("md5 ");
+	if (CONFIG_IS_ENABLED(SHA1))
+		ut_assert_nextlinen("sha1 ");
+	if (CONFIG_IS_ENABLED(SHA256))
+		ut_assert_nextlinen("sha256 ");
+	if (CONFIG_IS_ENABLED(SHA384))
+		ut_assert_nextlinen("sha384 ");
+	if (CONFIG_IS_ENABLED(SHA512))
+		ut_assert_nextlinen("sha512 ");
+	ut_assert_skip_to_linen("crc32 ");
+	ut_assert(strstr(uts->actual_str, " MiB/s"));
+	ut_assert_console_end();
+
+	ut_assert(run_command("hash bench 0", 0));
+
+	return 0;
+}
+DM_TEST(dm_test_cmd_hash_bench, UTF_CONSOLE);
@@ -2,37 +2,202 @@
 
 #include <crypto/ecdsa-uclass.h>
 #include <dm.h>
+#include <time.h>
 #include <dm/test.h>
 #include <test/ut.h>
 #include <u-boot/ecdsa.h>
 
 /*
- * Basic test of the ECDSA uclass and ecdsa_verify()
+ * Test vectors made with:
  *
- * ECDSA implementations in u-boot are hardware-dependent. Until we have a
- * software implementation that can be compiled into the sandbox, all we can
- * test is the uclass support.
+ * openssl ecparam -name prime256v1 -genkey -noout -out key.pem
+ * openssl dgst -sha256 -sign key.pem -out data.sig data
  *
- * The uclass_get() test is redundant since ecdsa_verify() would also fail. We
- * run both functions in order to isolate the cause more clearly. i.e. is
- * ecdsa_verify() failing because the UCLASS is absent/broken?
+ * and likewise with secp384r1 and sha384. The data is the string
+ * "U-Boot ECDSA test data for <curve>" followed by a newline.
  */
-static int dm_test_ecdsa_verify(struct unit_test_state *uts)
-{
-	struct uclass *ucp;
+static const u8 p256_x[] = {
+	0x46, 0x35, 0x8f, 0x08, 0xb7, 0x2f, 0xeb, 0x5c, 0xb5, 0x2a, 0xb6, 0x07,
+	0x4d, 0x32, 0xd4, 0x7e, 0x22, 0x80, 0xd7, 0x41, 0x7e, 0x5e, 0xd3, 0xb7,
+	0xc1, 0x76, 0x95, 0x0a, 0xc6, 0x91, 0x1a, 0x0e,
+};
 
-	struct checksum_algo algo = {
-		.checksum_len = 256,
-	};
+static const u8 p256_y[] = {
+	0x7e, 0x1c, 0x6d, 0xba, 0x34, 0x6d, 0x1f, 0x25, 0xf9, 0x1f, 0x89, 0xa2,
+	0x2a, 0x6b, 0x5b, 0x15, 0x9b, 0xfe, 0xd4, 0x02, 0x3c, 0x69, 0xb5, 0x05,
+	0x17, 0xf4, 0x31, 0x32, 0xa6, 0x33, 0x22, 0x2f,
+};
+
+static const u8 p256_hash[] = {
+	0x7d, 0x91, 0xdf, 0x7d, 0xc9, 0x20, 0xc2, 0x94, 0x06, 0xda, 0x0f, 0x3e,
+	0x79, 0xd3, 0xc0, 0x6a, 0x07, 0x5a, 0x39, 0xd3, 0x47, 0x7a, 0x0f, 0x3e,
+	0x10, 0xd5, 0x89, 0x5a, 0x68, 0xdb, 0xf8, 0xd7,
+};
+
+static const u8 p256_sig[] = {
+	0x1a, 0x17, 0x9c, 0x22, 0x54, 0x57, 0xda, 0x5f, 0x8c, 0x53, 0x1a, 0xa5,
+	0x09, 0x7d, 0x9a, 0x7e, 0x14, 0x3c, 0xcd, 0xd0, 0x6c, 0x09, 0x55, 0x62,
+	0x51, 0xb0, 0xab, 0x12, 0xd2, 0x66, 0x4d, 0xe3, 0x34, 0x72, 0x6d, 0x13,
+	0xdf, 0x91, 0x49, 0x44, 0x37, 0x08, 0xc5, 0xd9, 0xae, 0xc8, 0x90, 0xee,
+	0xf1, 0xc4, 0xda, 0xab, 0x5e, 0x14, 0x81, 0xbc, 0x8b, 0xb5, 0x66, 0x7d,
+	0x49, 0xa1, 0x5e, 0x42,
+};
+
+static const u8 p384_x[] = {
+	0x53, 0xa5, 0xbc, 0xcc, 0x73, 0xb3, 0x7f, 0x30, 0xa7, 0x9a, 0xd6, 0xa2,
+	0x9f, 0x56, 0x64, 0x83, 0xa2, 0x73, 0x57, 0xc3, 0x82, 0x42, 0x77, 0x18,
+	0x4c, 0xa4, 0x79, 0x61, 0xa6, 0x57, 0x58, 0x2d, 0xe9, 0x9a, 0xc3, 0xcb,
+	0x26, 0x98, 0x0d, 0x3a, 0xc9, 0xed, 0xda, 0x70, 0xb5, 0xfe, 0xca, 0x1c,
+};
+
+static const u8 p384_y[] = {
+	0xb8, 0x31, 0x30, 0xd0, 0x19, 0x99, 0x42, 0x29, 0x31, 0xcf, 0xba, 0x85,
+	0xdc, 0x84, 0xf8, 0x68, 0x0c, 0xca, 0x65, 0xd2, 0x0a, 0x22, 0x13, 0xbf,
+	0x8b, 0xf1, 0x8b, 0xf7, 0x43, 0x46, 0x6d, 0x4e, 0xa5, 0x8c, 0xd7, 0xc7,
+	0xb3, 0x12, 0x68, 0x48, 0x62, 0xf1, 0xb1, 0x20, 0xc0, 0x58, 0x34, 0xc4,
+};
+
+static const u8 p384_hash[] = {
+	0xc4, 0x51, 0xeb, 0xa9, 0x7b, 0xea, 0x77, 0x5e, 0x6e, 0x5e, 0x26, 0x70,
+	0x6b, 0x28, 0xbd, 0x7b, 0x12, 0xb9, 0x3d, 0x8f, 0x39, 0x56, 0x62, 0xd7,
+	0x1a, 0x68, 0xe7, 0x20, 0x8e, 0x62, 0x36, 0x66, 0xb1, 0xf4, 0x0f, 0xd3,
+	0xe4, 0xd6, 0x74, 0x4f, 0x5d, 0x66, 0x46, 0x43, 0x57, 0x8f, 0x23, 0x91,
+};
 
-	struct image_sign_info info = {
-		.checksum = &algo,
+static const u8 p384_sig[] = {
+	0x1c, 0x30, 0x25, 0xce, 0xa6, 0x35, 0xa3, 0x03, 0xf1, 0x30, 0x23, 0xdb,
+	0xb8, 0x4e, 0x5f, 0x8b, 0x66, 0x2d, 0xbb, 0x84, 0xba, 0x92, 0x95, 0xe1,
+	0xcc, 0x2f, 0x6d, 0x79, 0x92, 0x6b, 0x47, 0x1f, 0x34, 0x5c, 0xa4, 0x61,
+	0x75, 0xd6, 0x12, 0xd7, 0x38, 0x06, 0x4f, 0x28, 0x7a, 0xc1, 0x73, 0x5c,
+	0xd7, 0xa5, 0x12, 0xfc, 0x5a, 0x0a, 0x10, 0xf1, 0xc3, 0x21, 0xd3, 0x6a,
+	0x6b, 0xe6, 0x83, 0xeb, 0x0e, 0xbd, 0x38, 0xac, 0xed, 0xb7, 0xc7, 0x53,
+	0x0a, 0xdb, 0xc3, 0x1a, 0xb3, 0xed, 0x9e, 0x44, 0x63, 0xaf, 0xd0, 0xa0,
+	0xc4, 0x6b, 0x20, 0xf7, 0x9f, 0xbd, 0xed, 0x71, 0xff, 0xe6, 0xd1, 0x27,
+};
+
+struct ecdsa_test_vector {
+	const char *curve;
+	const u8 *x;
+	const u8 *y;
+	const u8 *hash;
+	const u8 *sig;
+	uint size;
+};
+
+static const struct ecdsa_test_vector ecdsa_vectors[] = {
+	{ "prime256v1", p256_x, p256_y, p256_hash, p256_sig, 32 },
+	{ "secp384r1", p384_x, p384_y, p384_hash, p384_sig, 48 },
+};
+
+static int ecdsa_test_verify(struct udevice *dev,
+			     const struct ecdsa_test_vector *vec,
+			     const u8 *x, const u8 *y, const u8 *hash,
+			     const u8 *sig)
+{
+	const struct ecdsa_ops *ops = device_get_ops(dev);
+	struct ecdsa_public_key key = {
+		.curve_name = vec->curve,
+		.x = x,
+		.y = y,
+		.size_bits = vec->size * 8,
 	};
 
+	return ops->verify(dev, &key, hash, vec->size, sig, vec->size * 2);
+}
+
+/*
+ * Basic test of the ECDSA uclass and the software ECDSA driver
+ *
+ * The uclass_get() test is redundant since the driver lookup would also
+ * fail. We run both functions in order to isolate the cause more clearly.
+ * i.e. is verification failing because the UCLASS is absent/broken?
+ */
+static int dm_test_ecdsa_verify(struct unit_test_state *uts)
+{
+	const struct ecdsa_test_vector *vec;
+	struct ecdsa_public_key key;
+	const struct ecdsa_ops *ops;
+	u8 buf[ECDSA384_BYTES * 2];
+	struct udevice *dev;
+	struct uclass *ucp;
+	int i;
+
 	ut_assertok(uclass_get(UCLASS_ECDSA, &ucp));
 	ut_assertnonnull(ucp);
-	ut_asserteq(-ENODEV, ecdsa_verify(&info, NULL, 0, NULL, 0));
+	ut_assertok(uclass_first_device_err(UCLASS_ECDSA, &dev));
+	ops = device_get_ops(dev);
+
+	for (i = 0; i < ARRAY_SIZE(ecdsa_vectors); i++) {
+		vec = &ecdsa_vectors[i];
+		ut_assertok(ecdsa_test_verify(dev, vec, vec->x, vec->y,
+					      vec->hash, vec->sig));
+
+		/* corrupt s */
+		memcpy(buf, vec->sig, vec->size * 2);
+		buf[vec->size + 3] ^= 0x10;
+		ut_asserteq(-EPERM, ecdsa_test_verify(dev, vec, vec->x, vec->y,
+						      vec->hash, buf));
+
+		/* wrong hash */
+		memcpy(buf, vec->hash, vec->size);
+		buf[0] ^= 0x80;
+		ut_asserteq(-EPERM, ecdsa_test_verify(dev, vec, vec->x, vec->y,
+						      buf, vec->sig));
+
+		/* public key which is not on the curve */
+		memcpy(buf, vec->y, vec->size);
+		buf[vec->size - 1] ^= 1;
+		ut_asserteq(-EINVAL, ecdsa_test_verify(dev, vec, vec->x, buf,
+						       vec->hash, vec->sig));
+
+		/* r = 0 */
+		memset(buf, '\0', vec->size);
+		memcpy(buf + vec->size, vec->sig + vec->size, vec->size);
+		ut_asserteq(-EPERM, ecdsa_test_verify(dev, vec, vec->x, vec->y,
+						      vec->hash, buf));
+	}
+
+	/* unknown curve and bad signature length */
+	key.curve_name = "secp521r1";
+	key.x = p256_x;
+	key.y = p256_y;
+	key.size_bits = 521;
+	ut_asserteq(-EOPNOTSUPP, ops->verify(dev, &key, p256_hash,
+					     sizeof(p256_hash), p256_sig,
+					     sizeof(p256_sig)));
+	key.curve_name = "prime256v1";
+	key.size_bits = 256;
+	ut_asserteq(-EINVAL, ops->verify(dev, &key, p256_hash,
+					 sizeof(p256_hash), p256_sig,
+					 sizeof(p256_sig) - 1));
 
 	return 0;
 }
 DM_TEST(dm_test_ecdsa_verify, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
+/* Report the speed of ECDSA verification */
+static int dm_test_ecdsa_bench(struct unit_test_state *uts)
+{
+	const struct ecdsa_test_vector *vec;
+	ulong start, us, count;
+	struct udevice *dev;
+	int i;
+
+	ut_assertok(uclass_first_device_err(UCLASS_ECDSA, &dev));
+	for (i = 0; i < ARRAY_SIZE(ecdsa_vectors); i++) {
+		vec = &ecdsa_vectors[i];
+		start = timer_get_us();
+		count = 0;
+		do {
+			ut_assertok(ecdsa_test_verify(dev, vec, vec->x, vec->y,
+						      vec->hash, vec->sig));
+			count++;
+			us = timer_get_us() - start;
+		} while (us < 500000);
+		printf("%s: %lu verifications/s\n", vec->curve,
+		       count * 1000000 / us);
+	}
+
+	return 0;
+}
+DM_TEST(dm_test_ecdsa_bench, UTF_SCAN_PDATA | UTF_SCAN_FDT);
@@ -6,12 +6,16 @@
 #include <abuf.h>
 #include <bootm.h>
 #include <command.h>
+#include <decomp_stream.h>
 #include <gzip.h>
+#include <hash.h>
 #include <image.h>
 #include <log.h>
 #include <malloc.h>
 #include <mapmem.h>
+#include <time.h>
 #include <asm/io.h>
+#include <asm/unaligned.h>
 
 #include <u-boot/lz4.h>
 #include <u-boot/zlib.h>
@@ -21,7 +25,9 @@
 #include <lzma/LzmaDec.h>
 #include <lzma/LzmaTools.h>
 
+#include <linux/log2.h>
 #include <linux/lzo.h>
+#include <linux/sizes.h>
 #include <linux/zstd.h>
 #include <test/lib.h>
 #include <test/ut.h>
@@ -121,6 +127,53 @@ static const char lz4_compressed[] =
 	"\x9d\x12\x8c\x9d";
 static const unsigned long lz4_compressed_size = sizeof(lz4_compressed) - 1;
 
+/*
+ * 200 copies of plain as an LZ4 frame with 64KB linked blocks, block and
+ * content checksums and the content size, as from:
+ * lz4 -B4 -BD -BX --content-size
+ */
+#define LZ4_LINKED_COPIES	200
+static const char lz4_linked[] =
+	"\x04\x22\x4d\x18\x5c\x40\x70\x11\x01\x00\x00\x00\x00\x00\xe3\x11"
+	"\x02\x00\x00\xff\x19\x49\x20\x61\x6d\x20\x61\x20\x68\x69\x67\x68"
+	"\x6c\x79\x20\x63\x6f\x6d\x70\x72\x65\x73\x73\x61\x62\x6c\x65\x20"
+	"\x62\x69\x74\x20\x6f\x66\x20\x74\x65\x78\x74\x2e\x0a\x28\x00\x3d"
+	"\xf1\x25\x54\x68\x65\x72\x65\x20\x61\x72\x65\x20\x6d\x61\x6e\x79"
+	"\x20\x6c\x69\x6b\x65\x20\x6d\x65\x2c\x20\x62\x75\x74\x20\x74\x68"
+	"\x69\x73\x20\x6f\x6e\x65\x20\x69\x73\x20\x6d\x69\x6e\x65\x2e\x0a"
+	"\x49\x66\x20\x49\x20\x77\x32\x00\xd1\x6e\x79\x20\x73\x68\x6f\x72"
+	"\x74\x65\x72\x2c\x20\x74\x45\x00\xf4\x0b\x77\x6f\x75\x6c\x64\x6e"
+	"\x27\x74\x20\x62\x65\x20\x6d\x75\x63\x68\x20\x73\x65\x6e\x73\x65"
+	"\x20\x69\x6e\x0a\xcf\x00\xf5\x45\x69\x6e\x67\x20\x6d\x65\x20\x69"
+	"\x6e\x20\x74\x68\x65\x20\x66\x69\x72\x73\x74\x20\x70\x6c\x61\x63"
+	"\x65\x2e\x20\x41\x74\x20\x6c\x65\x61\x73\x74\x20\x77\x69\x74\x68"
+	"\x20\x6c\x7a\x6f\x2c\x20\x61\x6e\x79\x77\x61\x79\x2c\x0a\x77\x68"
+	"\x69\x63\x68\x20\x61\x70\x70\x65\x61\x72\x73\x20\x74\x6f\x20\x62"
+	"\x65\x68\x61\x76\x65\x20\x70\x6f\x6f\x72\x6c\x79\x4e\x00\x62\x61"
+	"\x63\x65\x20\x6f\x66\x95\x00\x01\x2d\x01\x9f\x0a\x6d\x65\x73\x73"
+	"\x61\x67\x65\x73\x36\x01\x3f\x0f\x86\x01\x15\x0f\x5e\x01\xff\xff"
+	"\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff"
+	"\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff"
+	"\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff"
+	"\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff"
+	"\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff"
+	"\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff"
+	"\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff"
+	"\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff"
+	"\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff"
+	"\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff"
+	"\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff"
+	"\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff"
+	"\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff"
+	"\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff"
+	"\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff"
+	"\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\x11\x50\x20"
+	"\x61\x6d\x20\x61\x92\x11\x38\xba\x1f\x00\x00\x00\x0f\xfa\xff\x0f"
+	"\x0f\x4c\xfe\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff"
+	"\xff\xff\xff\xff\x47\x50\x67\x65\x73\x2e\x0a\xe0\x59\x07\x6a\x00"
+	"\x00\x00\x00\x8a\x80\xc2\x98";
+static const unsigned long lz4_linked_size = sizeof(lz4_linked) - 1;
+
 /* zstd -19 -c /tmp/plain.txt > /tmp/plain.zst */
 static const char zstd_compressed[] =
 	"\x28\xb5\x2f\xfd\x64\x5e\x00\xbd\x05\x00\x02\x0e\x26\x1a\x70\x17"
@@ -498,6 +551,73 @@ static int compression_test_lz4(struct unit_test_state *uts)
 }
 LIB_TEST(compression_test_lz4, 0);
 
+static int compression_test_lz4_frames(struct unit_test_state *uts)
+{
+	static const char skip[] = "\x55\x2a\x4d\x18\x03\x00\x00\x00" "abc";
+	ulong plain_size = strlen(plain);
+	ulong size = plain_size * LZ4_LINKED_COPIES;
+	char comp[TEST_BUFFER_SIZE * 2];
+	size_t out_size;
+	char *out;
+	u64 val;
+	int i;
+
+	out = malloc(size + 1);
+	ut_assertnonnull(out);
+
+	/* linked blocks, which refer back across the 64KB block boundary */
+	out_size = size + 1;
+	ut_assertok(ulz4fn(lz4_linked, lz4_linked_size, out, &out_size));
+	ut_asserteq(size, out_size);
+	for (i = 0; i < LZ4_LINKED_COPIES; i++)
+		ut_asserteq_mem(plain, out + i * plain_size, plain_size);
+	ut_assertok(ulz4f_content_size(lz4_linked, lz4_linked_size, &val));
+	ut_asserteq(size, val);
+	ut_asserteq(-ENOENT, ulz4f_content_size(lz4_compressed,
+						lz4_compressed_size, &val));
+
+	/* the content size is checked before decompressing */
+	out_size = size - 1;
+	ut_asserteq(-ENOBUFS, ulz4fn(lz4_linked, lz4_linked_size, out,
+				     &out_size));
+	ut_asserteq(0, out_size);
+
+	if (CONFIG_IS_ENABLED(LZ4_CHECKSUM)) {
+		/* bad block checksum */
+		memcpy(comp, lz4_linked, lz4_linked_size);
+		comp[40] ^= 1;
+		out_size = size;
+		ut_asserteq(-EBADMSG, ulz4fn(comp, lz4_linked_size, out,
+					     &out_size));
+
+		/* bad content checksum */
+		memcpy(comp, lz4_linked, lz4_linked_size);
+		comp[lz4_linked_size - 1] ^= 1;
+		out_size = size;
+		ut_asserteq(-EBADMSG, ulz4fn(comp, lz4_linked_size, out,
+					     &out_size));
+	}
+
+	/* two frames with a skippable frame between, then padding */
+	memcpy(comp, lz4_compressed, lz4_compressed_size);
+	size = lz4_compressed_size;
+	memcpy(comp + size, skip, sizeof(skip) - 1);
+	size += sizeof(skip) - 1;
+	memcpy(comp + size, lz4_compressed, lz4_compressed_size);
+	size += lz4_compressed_size;
+	memset(comp + size, '\0', 16);
+	size += 16;
+	out_size = plain_size * 2;
+	ut_assertok(ulz4fn(comp, size, out, &out_size));
+	ut_asserteq(plain_size * 2, out_size);
+	ut_asserteq_mem(plain, out, plain_size);
+	ut_asserteq_mem(plain, out + plain_size, plain_size);
+	free(out);
+
+	return 0;
+}
+LIB_TEST(compression_test_lz4_frames, 0);
+
 static int compression_test_zstd(struct unit_test_state *uts)
 {
 	return run_test(uts, "zstd", compress_using_zstd,
@@ -505,6 +625,677 @@ static int compression_test_zstd(struct unit_test_state *uts)
 }
 LIB_TEST(compression_test_zstd, 0);
 
+/* Append a frame holding @plain, returning the new size */
+static ulong zstd_add_frame(char *buf, ulong size)
+{
+	memcpy(buf + size, zstd_compressed, zstd_compressed_size);
+
+	return size + zstd_compressed_size;
+}
+
+static int compression_test_zstd_frames(struct unit_test_state *uts)
+{
+	static const char skip[] = "\x53\x2a\x4d\x18\x03\x00\x00\x00" "abc";
+	ulong plain_size = strlen(plain);
+	struct abuf in, out;
+	char comp[TEST_BUFFER_SIZE];
+	char buf[TEST_BUFFER_SIZE * 2];
+	zstd_out_buffer zout;
+	zstd_in_buffer zin;
+	struct zstd_stream zs;
+	ulong size, pos;
+
+	/* two frames with a skippable frame between, then padding */
+	size = zstd_add_frame(comp, 0);
+	memcpy(comp + size, skip, sizeof(skip) - 1);
+	size = zstd_add_frame(comp, size + sizeof(skip) - 1);
+	memset(comp + size, '\0', 16);
+	size += 16;
+
+	abuf_init_set(&in, comp, size);
+	abuf_init_set(&out, buf, sizeof(buf));
+	ut_asserteq(plain_size * 2, zstd_decompress(&in, &out));
+	ut_asserteq_mem(plain, buf, plain_size);
+	ut_asserteq_mem(plain, buf + plain_size, plain_size);
+
+	/* the same, in small pieces with a separate output buffer each time */
+	ut_assertok(zstd_stream_init(&zs, SZ_1K, false));
+	for (pos = 0, zin.pos = 0; zin.pos < size;) {
+		zin.src = comp;
+		zin.size = min(zin.pos + 5, size);
+		zout.dst = buf + pos;
+		zout.size = 3;
+		zout.pos = 0;
+		ut_assertok(zstd_stream_feed(&zs, &zin, &zout));
+		pos += zout.pos;
+	}
+	/* the skippable frame counts too */
+	ut_asserteq(3, zs.frames);
+	ut_assert(zs.done);
+	ut_assertok(zstd_stream_finish(&zs));
+	ut_asserteq(plain_size * 2, pos);
+	ut_asserteq_mem(plain, buf, plain_size);
+	ut_asserteq_mem(plain, buf + plain_size, plain_size);
+
+	/* a truncated second frame is an error */
+	ut_assertok(zstd_stream_init(&zs, SZ_1K, false));
+	zin.src = comp;
+	zin.size = zstd_compressed_size * 2;
+	zin.pos = 0;
+	zout.dst = buf;
+	zout.size = sizeof(buf);
+	zout.pos = 0;
+	ut_assertok(zstd_stream_feed(&zs, &zin, &zout));
+	ut_asserteq(-EINVAL, zstd_stream_finish(&zs));
+
+	return 0;
+}
+LIB_TEST(compression_test_zstd_frames, 0);
+
+static int compression_test_zstd_seekable(struct unit_test_state *uts)
+{
+	ulong plain_size = strlen(plain);
+	char comp[TEST_BUFFER_SIZE];
+	char buf[TEST_BUFFER_SIZE];
+	struct abuf in, out;
+	ulong size, table;
+	int i;
+
+	/* two frames, then a seek table without checksums */
+	size = zstd_add_frame(comp, 0);
+	size = zstd_add_frame(comp, size);
+	table = size;
+	put_unaligned_le32(0x184d2a5e, comp + size);
+	put_unaligned_le32(2 * 8 + 9, comp + size + 4);
+	size += 8;
+	for (i = 0; i < 2; i++) {
+		put_unaligned_le32(zstd_compressed_size, comp + size);
+		put_unaligned_le32(plain_size, comp + size + 4);
+		size += 8;
+	}
+	put_unaligned_le32(2, comp + size);
+	comp[size + 4] = 0;
+	put_unaligned_le32(0x8f92eab1, comp + size + 5);
+	size += 9;
+	abuf_init_set(&in, comp, size);
+
+	/* read across the frame boundary */
+	abuf_init_set(&out, buf, 20);
+	ut_asserteq(20, zstd_seekable_read(&in, plain_size - 10, &out));
+	ut_asserteq_mem(plain + plain_size - 10, buf, 10);
+	ut_asserteq_mem(plain, buf + 10, 10);
+
+	/* read from the middle of the second frame to the end */
+	abuf_init_set(&out, buf, sizeof(buf));
+	ut_asserteq(plain_size - 30,
+		    zstd_seekable_read(&in, plain_size + 30, &out));
+	ut_asserteq_mem(plain + 30, buf, plain_size - 30);
+
+	/* past the end */
+	ut_asserteq(0, zstd_seekable_read(&in, plain_size * 2, &out));
+
+	/* not seekable, or with a bad table */
+	abuf_init_set(&in, comp, table);
+	ut_asserteq(-ENOENT, zstd_seekable_read(&in, 0, &out));
+	comp[table] = 0;
+	abuf_init_set(&in, comp, size);
+	ut_asserteq(-EINVAL, zstd_seekable_read(&in, 0, &out));
+
+	return 0;
+}
+LIB_TEST(compression_test_zstd_seekable, 0);
+
+#define BENCH_CORPUS_SIZE	SZ_1M
+#define BENCH_LOOPS		4
+
+/**
+ * bench_fill_corpus() - Fill a buffer with reproducible, text-like data
+ *
+ * This mixes lines from @plain with numbers and the occasional run of a
+ * single character, so that the compressed stream has a realistic mix of
+ * literals, short and long matches.
+ *
+ * @buf: Buffer to fill
+ * @size: Size of buffer
+ */
+static void bench_fill_corpus(char *buf, ulong size)
+{
+	const char *lines[] = {plain, plain + 40, plain + 80, plain + 126};
+	uint seed = 0x1234567;
+	ulong pos = 0;
+
+	while (pos < size) {
+		char tmp[80];
+		int len;
+
+		seed = seed * 1103515245 + 12345;
+		if ((seed >> 16) % 8 == 0) {
+			len = snprintf(tmp, sizeof(tmp), "%08x %u\n", seed,
+				       seed >> 20);
+		} else if ((seed >> 16) % 8 == 1) {
+			len = (seed >> 24) % 64 + 1;
+			memset(tmp, '-', len);
+		} else {
+			len = 40;
+			memcpy(tmp, lines[(seed >> 16) % 4], len);
+		}
+		len = min_t(ulong, len, size - pos);
+		memcpy(buf + pos, tmp, len);
+		pos += len;
+	}
+}
+
+/* Decompress the corpus BENCH_LOOPS times, returning the speed in KiB/s */
+static int bench_gunzip(struct unit_test_state *uts, void *dst, void *src,
+			ulong src_size, ulong *ratep)
+{
+	ulong start, us;
+	int i;
+
+	start = timer_get_us();
+	for (i = 0; i < BENCH_LOOPS; i++) {
+		unsigned long len = src_size;
+
+		ut_assertok(gunzip(dst, BENCH_CORPUS_SIZE, src, &len));
+	}
+	us = max(timer_get_us() - start, 1UL);
+	*ratep = (u64)BENCH_CORPUS_SIZE * BENCH_LOOPS * 1000000 / SZ_1K / us;
+
+	return 0;
+}
+
+/* Compare the speed of the inflate fast paths on a reference corpus */
+static int compression_test_gzip_bench(struct unit_test_state *uts)
+{
+	unsigned long comp_size = BENCH_CORPUS_SIZE;
+	void *orig, *comp, *uncomp;
+	ulong rate;
+
+	orig = malloc(BENCH_CORPUS_SIZE);
+	comp = malloc(BENCH_CORPUS_SIZE);
+	uncomp = malloc(BENCH_CORPUS_SIZE);
+	ut_assertnonnull(orig);
+	ut_assertnonnull(comp);
+	ut_assertnonnull(uncomp);
+
+	bench_fill_corpus(orig, BENCH_CORPUS_SIZE);
+	ut_assertok(gzip(comp, &comp_size, orig, BENCH_CORPUS_SIZE));
+	printf("gunzip: %lu KiB corpus, %lu KiB compressed\n",
+	       (ulong)BENCH_CORPUS_SIZE / SZ_1K, comp_size / SZ_1K);
+
+	if (CONFIG_IS_ENABLED(ZLIB_INFLATE_CHUNK)) {
+		inflate_chunk_enable = 0;
+		ut_assertok(bench_gunzip(uts, uncomp, comp, comp_size, &rate));
+		inflate_chunk_enable = 1;
+		ut_asserteq_mem(orig, uncomp, BENCH_CORPUS_SIZE);
+		printf("gunzip: stock   %lu.%02lu MiB/s\n", rate / SZ_1K,
+		       rate % SZ_1K * 100 / SZ_1K);
+		memset(uncomp, '\0', BENCH_CORPUS_SIZE);
+	}
+
+	ut_assertok(bench_gunzip(uts, uncomp, comp, comp_size, &rate));
+	ut_asserteq_mem(orig, uncomp, BENCH_CORPUS_SIZE);
+	printf("gunzip: current %lu.%02lu MiB/s\n", rate / SZ_1K,
+	       rate % SZ_1K * 100 / SZ_1K);
+
+	free(uncomp);
+	free(comp);
+	free(orig);
+
+	return 0;
+}
+LIB_TEST(compression_test_gzip_bench, 0);
+
+/*
+ * There is no LZMA encoder in U-Boot, so the benchmark uses a minimal one,
+ * with lc=3, lp=0, pb=2, greedy matching using a single hash probe and no
+ * rep matches. It compresses less well than the lzma tool, but produces the
+ * same kinds of symbol for the decoder to work through.
+ */
+#define LZMA_ENC_HASH_BITS	16
+
+struct lzma_enc {
+	u16 is_match[12][4];
+	u16 is_rep[12];
+	u16 literal[8][0x300];
+	u16 pos_slot[4][64];
+	u16 spec_pos[128 - 14];
+	u16 align[16];
+	u16 len_choice;
+	u16 len_choice2;
+	u16 len_low[4][8];
+	u16 len_mid[4][8];
+	u16 len_high[256];
+	u8 *out;
+	ulong pos;
+	u64 low;
+	u32 range;
+	u8 cache;
+	ulong cache_size;
+	uint state;
+	u32 rep0;
+};
+
+static void lzma_enc_shift_low(struct lzma_enc *enc)
+{
+	if ((u32)enc->low < 0xff000000 || (enc->low >> 32)) {
+		u8 carry = enc->low >> 32;
+		u8 temp = enc->cache;
+
+		do {
+			enc->out[enc->pos++] = temp + carry;
+			temp = 0xff;
+		} while (--enc->cache_size);
+		enc->cache = (u32)enc->low >> 24;
+	}
+	enc->cache_size++;
+	enc->low = (u32)enc->low << 8;
+}
+
+static void lzma_enc_bit(struct lzma_enc *enc, u16 *prob, uint bit)
+{
+	u32 bound = (enc->range >> 11) * *prob;
+
+	if (bit) {
+		enc->low += bound;
+		enc->range -= bound;
+		*prob -= *prob >> 5;
+	} else {
+		enc->range = bound;
+		*prob += (2048 - *prob) >> 5;
+	}
+	while (enc->range < 1 << 24) {
+		enc->range <<= 8;
+		lzma_enc_shift_low(enc);
+	}
+}
+
+static void lzma_enc_tree(struct lzma_enc *enc, u16 *probs, int bits, uint val)
+{
+	uint m = 1;
+
+	while (bits--) {
+		uint bit = (val >> bits) & 1;
+
+		lzma_enc_bit(enc, probs + m, bit);
+		m = m << 1 | bit;
+	}
+}
+
+static void lzma_enc_tree_rev(struct lzma_enc *enc, u16 *probs, int bits,
+			      uint val)
+{
+	uint m = 1;
+
+	while (bits--) {
+		uint bit = val & 1;
+
+		lzma_enc_bit(enc, probs + m, bit);
+		m = m << 1 | bit;
+		val >>= 1;
+	}
+}
+
+static void lzma_enc_direct(struct lzma_enc *enc, u32 val, int bits)
+{
+	while (bits--) {
+		enc->range >>= 1;
+		if ((val >> bits) & 1)
+			enc->low += enc->range;
+		if (enc->range < 1 << 24) {
+			enc->range <<= 8;
+			lzma_enc_shift_low(enc);
+		}
+	}
+}
+
+static void lzma_enc_literal(struct lzma_enc *enc, const u8 *data, ulong pos)
+{
+	u16 *probs = enc->literal[pos ? data[pos - 1] >> 5 : 0];
+	uint sym = data[pos] | 0x100;
+
+	lzma_enc_bit(enc, &enc->is_match[enc->state][pos & 3], 0);
+	if (enc->state < 7) {
+		lzma_enc_tree(enc, probs, 8, data[pos]);
+	} else {
+		uint match = data[pos - enc->rep0];
+		uint offs = 0x100;
+
+		do {
+			match <<= 1;
+			lzma_enc_bit(enc, probs + offs + (match & offs) +
+				     (sym >> 8), (sym >> 7) & 1);
+			sym <<= 1;
+			offs &= ~(match ^ sym);
+		} while (sym < 0x10000);
+	}
+	enc->state = enc->state < 4 ? 0 : enc->state < 10 ? enc->state - 3 :
+		enc->state - 6;
+}
+
+/* Encode a match of @len bytes at distance @dist + 1 */
+static void lzma_enc_match(struct lzma_enc *enc, ulong pos, u32 dist, uint len)
+{
+	uint ps = pos & 3, slot, bits;
+
+	lzma_enc_bit(enc, &enc->is_match[enc->state][ps], 1);
+	lzma_enc_bit(enc, &enc->is_rep[enc->state], 0);
+	len -= 2;
+	if (len < 8) {
+		lzma_enc_bit(enc, &enc->len_choice, 0);
+		lzma_enc_tree(enc, enc->len_low[ps], 3, len);
+	} else if (len < 16) {
+		lzma_enc_bit(enc, &enc->len_choice, 1);
+		lzma_enc_bit(enc, &enc->len_choice2, 0);
+		lzma_enc_tree(enc, enc->len_mid[ps], 3, len - 8);
+	} else {
+		lzma_enc_bit(enc, &enc->len_choice, 1);
+		lzma_enc_bit(enc, &enc->len_choice2, 1);
+		lzma_enc_tree(enc, enc->len_high, 8, len - 16);
+	}
+
+	if (dist < 4) {
+		slot = dist;
+	} else {
+		bits = fls(dist) - 1;
+		slot = bits * 2 + ((dist >> (bits - 1)) & 1);
+	}
+	lzma_enc_tree(enc, enc->pos_slot[min(len, 3U)], 6, slot);
+	if (slot >= 4) {
+		u32 base;
+
+		bits = (slot >> 1) - 1;
+		base = (2 | (slot & 1)) << bits;
+		if (slot < 14) {
+			lzma_enc_tree_rev(enc, enc->spec_pos + base - slot - 1,
+					  bits, dist - base);
+		} else {
+			lzma_enc_direct(enc, (dist - base) >> 4, bits - 4);
+			lzma_enc_tree_rev(enc, enc->align, 4, dist & 15);
+		}
+	}
+	enc->state = enc->state < 7 ? 7 : 10;
+	enc->rep0 = dist + 1;
+}
+
+/**
+ * bench_lzma_compress() - Compress data into the .lzma format
+ *
+ * @dst: Output buffer, which must be a little larger than @src
+ * @src: Data to compress
+ * @size: Size of @src in bytes
+ * Return: size of the compressed data, or 0 if out of memory
+ */
+static ulong bench_lzma_compress(void *dst, const void *src, ulong size)
+{
+	const u8 *data = src;
+	struct lzma_enc *enc;
+	u16 *prob;
+	u32 *head;
+	ulong pos, len;
+	int i;
+
+	enc = calloc(1, sizeof(*enc));
+	head = calloc(1 << LZMA_ENC_HASH_BITS, sizeof(*head));
+	if (!enc || !head) {
+		free(enc);
+		free(head);
+		return 0;
+	}
+	/* all probabilities start at one half */
+	for (prob = (u16 *)enc; prob < (u16 *)&enc->out; prob++)
+		*prob = 1 << 10;
+
+	enc->out = dst;
+	enc->out[0] = (2 * 5 + 0) * 9 + 3;
+	put_unaligned_le32(roundup_pow_of_two(size), enc->out + 1);
+	put_unaligned_le64(size, enc->out + 5);
+	enc->pos = 13;
+	enc->range = 0xffffffff;
+	enc->cache_size = 1;
+
+	for (pos = 0; pos < size; pos += len) {
+		u32 hash, cand = 0;
+
+		len = 0;
+		if (size - pos >= 4) {
+			hash = get_unaligned_le32(data + pos) * 2654435761U >>
+				(32 - LZMA_ENC_HASH_BITS);
+			cand = head[hash];
+			head[hash] = pos + 1;
+		}
+		if (cand) {
+			ulong max = min(size - pos, 273UL);
+
+			cand--;
+			while (len < max && data[cand + len] == data[pos + len])
+				len++;
+		}
+		if (len >= 4) {
+			lzma_enc_match(enc, pos, pos - cand - 1, len);
+		} else {
+			len = 1;
+			lzma_enc_literal(enc, data, pos);
+		}
+	}
+	for (i = 0; i < 5; i++)
+		lzma_enc_shift_low(enc);
+	len = enc->pos;
+	free(head);
+	free(enc);
+
+	return len;
+}
+
+/* Decompress the corpus BENCH_LOOPS times, returning the speed in KiB/s */
+static int bench_unlzma(struct unit_test_state *uts, void *dst, void *src,
+			ulong src_size, ulong *ratep)
+{
+	ulong start, us;
+	int i;
+
+	start = timer_get_us();
+	for (i = 0; i < BENCH_LOOPS; i++) {
+		SizeT len = BENCH_CORPUS_SIZE;
+
+		ut_assertok(lzmaBuffToBuffDecompress(dst, &len, src, src_size));
+		ut_asserteq(BENCH_CORPUS_SIZE, len);
+	}
+	us = max(timer_get_us() - start, 1UL);
+	*ratep = (u64)BENCH_CORPUS_SIZE * BENCH_LOOPS * 1000000 / SZ_1K / us;
+
+	return 0;
+}
+
+/* Compare the speed of the LZMA decoder loops on a reference corpus */
+static int compression_test_lzma_bench(struct unit_test_state *uts)
+{
+	void *orig, *comp, *uncomp;
+	ulong comp_size, rate;
+
+	orig = malloc(BENCH_CORPUS_SIZE);
+	comp = malloc(BENCH_CORPUS_SIZE * 2);
+	uncomp = malloc(BENCH_CORPUS_SIZE);
+	ut_assertnonnull(orig);
+	ut_assertnonnull(comp);
+	ut_assertnonnull(uncomp);
+
+	bench_fill_corpus(orig, BENCH_CORPUS_SIZE);
+	comp_size = bench_lzma_compress(comp, orig, BENCH_CORPUS_SIZE);
+	ut_assert(comp_size);
+	printf("unlzma: %lu KiB corpus, %lu KiB compressed\n",
+	       (ulong)BENCH_CORPUS_SIZE / SZ_1K, comp_size / SZ_1K);
+
+	if (CONFIG_IS_ENABLED(LZMA_FAST)) {
+		lzma_fast_enable = 0;
+		ut_assertok(bench_unlzma(uts, uncomp, comp, comp_size, &rate));
+		lzma_fast_enable = 1;
+		ut_asserteq_mem(orig, uncomp, BENCH_CORPUS_SIZE);
+		printf("unlzma: reference %lu.%02lu MiB/s\n", rate / SZ_1K,
+		       rate % SZ_1K * 100 / SZ_1K);
+		memset(uncomp, '\0', BENCH_CORPUS_SIZE);
+	}
+
+	ut_assertok(bench_unlzma(uts, uncomp, comp, comp_size, &rate));
+	ut_asserteq_mem(orig, uncomp, BENCH_CORPUS_SIZE);
+	printf("unlzma: current   %lu.%02lu MiB/s\n", rate / SZ_1K,
+	       rate % SZ_1K * 100 / SZ_1K);
+
+	free(uncomp);
+	free(comp);
+	free(orig);
+
+	return 0;
+}
+LIB_TEST(compression_test_lzma_bench, 0);
+
+#if CONFIG_IS_ENABLED(DECOMP_STREAM)
+/* Decompress a stream fed in pieces of @chunk bytes, into a buffer of @size */
+static int stream_decomp(struct unit_test_state *uts, int comp, const void *in,
+			 ulong in_size, ulong chunk, void *out, ulong size,
+			 ulong *out_lenp)
+{
+	struct decomp_stream ds;
+	ulong pos;
+	int ret;
+
+	ut_assertok(decomp_stream_init(&ds, comp, out, size));
+	for (pos = 0; pos < in_size; pos += chunk) {
+		ret = decomp_stream_feed(&ds, in + pos,
+					 min(chunk, in_size - pos));
+		if (ret)
+			return ret;
+	}
+
+	return decomp_stream_finish(&ds, out_lenp);
+}
+
+/**
+ * run_stream_test() - Run tests on the streaming decompression interface
+ *
+ * @comp_type:	Compression type to test
+ * @in:		Compressed version of @plain
+ * @in_size:	Size of compressed data
+ * Return: 0 if OK, non-zero on failure
+ */
+static int run_stream_test(struct unit_test_state *uts, int comp_type,
+			   const void *in, ulong in_size)
+{
+	const ulong chunks[] = {1, 7, 64, in_size};
+	ulong plain_size = strlen(plain);
+	u8 digest[HASH_MAX_DIGEST_SIZE];
+	u8 expect[HASH_MAX_DIGEST_SIZE];
+	struct hash_algo *algo;
+	struct decomp_stream ds;
+	char out[TEST_BUFFER_SIZE];
+	ulong out_len;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(chunks); i++) {
+		memset(out, 'A', sizeof(out));
+		ut_assertok(stream_decomp(uts, comp_type, in, in_size,
+					  chunks[i], out, sizeof(out),
+					  &out_len));
+		ut_asserteq(plain_size, out_len);
+		ut_asserteq_mem(plain, out, plain_size);
+		ut_asserteq('A', out[plain_size]);
+	}
+
+	/* output buffer too small, without overrunning it */
+	memset(out, 'A', sizeof(out));
+	ut_asserteq(-ENOSPC, stream_decomp(uts, comp_type, in, in_size, 64,
+					   out, plain_size - 1, &out_len));
+	ut_asserteq('A', out[plain_size - 1]);
+
+	/* truncated input */
+	ut_asserteq(-EINVAL, stream_decomp(uts, comp_type, in, in_size / 2, 64,
+					   out, sizeof(out), &out_len));
+
+	/* hash the compressed data while decompressing it */
+	ut_assertok(hash_progressive_lookup_algo("sha256", &algo));
+	ut_assertok(decomp_stream_init(&ds, comp_type, out, sizeof(out)));
+	ut_assertok(algo->hash_init(algo, &ds.hash_ctx));
+	ds.hash = algo;
+	ut_assertok(decomp_stream_feed(&ds, in, in_size / 3));
+	ut_assertok(decomp_stream_feed(&ds, in + in_size / 3,
+				       in_size - in_size / 3));
+	ut_assertok(decomp_stream_finish(&ds, &out_len));
+	ut_asserteq(plain_size, out_len);
+	ut_assertok(algo->hash_finish(algo, ds.hash_ctx, digest,
+				      sizeof(digest)));
+	ut_assertok(hash_block("sha256", in, in_size, expect, NULL));
+	ut_asserteq_mem(expect, digest, algo->digest_size);
+
+	return 0;
+}
+
+static int compression_test_stream_gzip(struct unit_test_state *uts)
+{
+	unsigned long size = TEST_BUFFER_SIZE;
+	char comp[TEST_BUFFER_SIZE];
+
+	ut_assertok(gzip(comp, &size, (uchar *)plain, strlen(plain)));
+
+	return run_stream_test(uts, IH_COMP_GZIP, comp, size);
+}
+LIB_TEST(compression_test_stream_gzip, 0);
+
+static int compression_test_stream_lzma(struct unit_test_state *uts)
+{
+	return run_stream_test(uts, IH_COMP_LZMA, lzma_compressed,
+			       lzma_compressed_size);
+}
+LIB_TEST(compression_test_stream_lzma, 0);
+
+static int compression_test_stream_zstd(struct unit_test_state *uts)
+{
+	return run_stream_test(uts, IH_COMP_ZSTD, zstd_compressed,
+			       zstd_compressed_size);
+}
+LIB_TEST(compression_test_stream_zstd, 0);
+
+static int compression_test_stream_lz4(struct unit_test_state *uts)
+{
+	ulong size = strlen(plain) * LZ4_LINKED_COPIES;
+	ulong out_len;
+	char *out;
+	int i;
+
+	ut_assertok(run_stream_test(uts, IH_COMP_LZ4, lz4_compressed,
+				    lz4_compressed_size));
+
+	/* linked blocks split across pieces, with checksums */
+	out = malloc(size);
+	ut_assertnonnull(out);
+	ut_assertok(stream_decomp(uts, IH_COMP_LZ4, lz4_linked,
+				  lz4_linked_size, 7, out, size, &out_len));
+	ut_asserteq(size, out_len);
+	for (i = 0; i < LZ4_LINKED_COPIES; i++)
+		ut_asserteq_mem(plain, out + i * strlen(plain), strlen(plain));
+	free(out);
+
+	return 0;
+}
+LIB_TEST(compression_test_stream_lz4, 0);
+
+static int compression_test_stream_none(struct unit_test_state *uts)
+{
+	char out[TEST_BUFFER_SIZE];
+	ulong out_len;
+
+	ut_assertok(stream_decomp(uts, IH_COMP_NONE, plain, strlen(plain), 7,
+				  out, sizeof(out), &out_len));
+	ut_asserteq(strlen(plain), out_len);
+	ut_asserteq_mem(plain, out, out_len);
+	ut_asserteq(-ENOSPC, stream_decomp(uts, IH_COMP_NONE, plain,
+					   strlen(plain), 7, out, 10,
+					   &out_len));
+
+	return 0;
+}
+LIB_TEST(compression_test_stream_none, 0);
+#endif /* DECOMP_STREAM */
+
 static int compress_using_none(struct unit_test_state *uts,
 			       void *in, unsigned long in_size,
 			       void *out, unsigned long out_max,
@@ -8,10 +8,12 @@
 
 #include <command.h>
 #include <image.h>
+#include <time.h>
 #include <test/lib.h>
 #include <test/test.h>
 #include <test/ut.h>
 #include <u-boot/rsa.h>
+#include <u-boot/rsa-mod-exp.h>
 
 #ifdef CONFIG_RSA_VERIFY_WITH_PKEY
 /*
@@ -200,4 +202,102 @@ static int lib_rsa_verify_invalid(struct unit_test_state *uts)
 	return CMD_RET_SUCCESS;
 }
 LIB_TEST(lib_rsa_verify_invalid, 0);
+
+/* Multiply two 8-byte big-endian numbers into a 16-byte one */
+static void rsa_test_mul(const u8 *a, const u8 *b, u8 *out)
+{
+	uint t;
+	int i, j;
+
+	memset(out, '\0', 16);
+	for (i = 7; i >= 0; i--) {
+		t = 0;
+		for (j = 7; j >= 0; j--) {
+			t += out[i + j + 1] + a[i] * b[j];
+			out[i + j + 1] = t;
+			t >>= 8;
+		}
+		out[i] = t;
+	}
+}
+
+/**
+ * lib_rsa_mod_exp() - unit test for rsa_mod_exp_sw()
+ *
+ * Check exponents of various lengths, using x^(a * b) = (x^a)^b
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_rsa_mod_exp(struct unit_test_state *uts)
+{
+	static const u8 exps[][8] = {
+		{ 0, 0, 0, 0, 0, 0x01, 0x00, 0x01 },
+		{ 0, 0, 0, 0, 0xc0, 0xff, 0xee, 0x01 },
+		{ 0x9e, 0x37, 0x79, 0xb9, 0x7f, 0x4a, 0x7c, 0x15 },
+	};
+	u8 prod[16], step[256], once[256];
+	struct key_prop *prop;
+	const void *exp;
+	int i;
+
+	ut_assertok(rsa_gen_key_prop(public_key, public_key_len, &prop));
+	exp = prop->public_exponent;
+
+	for (i = 0; i < ARRAY_SIZE(exps) - 1; i++) {
+		prop->public_exponent = exps[i];
+		prop->exp_len = 8;
+		ut_assertok(rsa_mod_exp_sw(data_enc, data_enc_len, prop, step));
+		prop->public_exponent = exps[i + 1];
+		ut_assertok(rsa_mod_exp_sw(step, data_enc_len, prop, step));
+
+		rsa_test_mul(exps[i], exps[i + 1], prod);
+		prop->public_exponent = prod;
+		prop->exp_len = sizeof(prod);
+		ut_assertok(rsa_mod_exp_sw(data_enc, data_enc_len, prop, once));
+		ut_asserteq_mem(step, once, data_enc_len);
+	}
+
+	prop->public_exponent = exp;
+	rsa_free_key_prop(prop);
+
+	return CMD_RET_SUCCESS;
+}
+LIB_TEST(lib_rsa_mod_exp, 0);
+
+/**
+ * lib_rsa_verify_bench() - report the speed of rsa_verify()
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_rsa_verify_bench(struct unit_test_state *uts)
+{
+	struct image_sign_info info;
+	struct image_region reg;
+	ulong start, us, count;
+
+	memset(&info, '\0', sizeof(info));
+	info.name = "sha256,rsa2048";
+	info.padding = image_get_padding_algo("pkcs-1.5");
+	info.checksum = image_get_checksum_algo("sha256,rsa2048");
+	info.crypto = image_get_crypto_algo(info.name);
+
+	info.key = public_key;
+	info.keylen = public_key_len;
+
+	reg.data = data_raw;
+	reg.size = data_raw_len;
+	start = timer_get_us();
+	count = 0;
+	do {
+		ut_assertok(rsa_verify(&info, &reg, 1, data_enc, data_enc_len));
+		count++;
+		us = timer_get_us() - start;
+	} while (us < 500000);
+	printf("rsa2048: %lu verifications/s\n", count * 1000000 / us);
+
+	return CMD_RET_SUCCESS;
+}
+LIB_TEST(lib_rsa_verify_bench, 0);
 #endif /* RSA_VERIFY_WITH_PKEY */
@@ -164,3 +164,181 @@ static int lib_test_aes(struct unit_test_state *uts)
 	return ret;
 }
 LIB_TEST(lib_test_aes, 0);
+
+/* Known answers from NIST SP 800-38A, F.2.5 (CBC) and F.5.1 (CTR) */
+static const u8 test_sp800_38a_plain[] = {
+	0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96,
+	0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+	0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c,
+	0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+	0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11,
+	0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+	0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17,
+	0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10,
+};
+
+static const u8 test_cbc_key[] = {
+	0x60, 0x3d, 0xeb, 0x10, 0x15, 0xca, 0x71, 0xbe,
+	0x2b, 0x73, 0xae, 0xf0, 0x85, 0x7d, 0x77, 0x81,
+	0x1f, 0x35, 0x2c, 0x07, 0x3b, 0x61, 0x08, 0xd7,
+	0x2d, 0x98, 0x10, 0xa3, 0x09, 0x14, 0xdf, 0xf4,
+};
+
+static const u8 test_cbc_iv[] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+	0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+};
+
+static const u8 test_cbc_cipher[] = {
+	0xf5, 0x8c, 0x4c, 0x04, 0xd6, 0xe5, 0xf1, 0xba,
+	0x77, 0x9e, 0xab, 0xfb, 0x5f, 0x7b, 0xfb, 0xd6,
+	0x9c, 0xfc, 0x4e, 0x96, 0x7e, 0xdb, 0x80, 0x8d,
+	0x67, 0x9f, 0x77, 0x7b, 0xc6, 0x70, 0x2c, 0x7d,
+	0x39, 0xf2, 0x33, 0x69, 0xa9, 0xd9, 0xba, 0xcf,
+	0xa5, 0x30, 0xe2, 0x63, 0x04, 0x23, 0x14, 0x61,
+	0xb2, 0xeb, 0x05, 0xe2, 0xc3, 0x9b, 0xe9, 0xfc,
+	0xda, 0x6c, 0x19, 0x07, 0x8c, 0x6a, 0x9d, 0x1b,
+};
+
+static const u8 test_ctr_key[] = {
+	0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+	0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c,
+};
+
+static const u8 test_ctr_iv[] = {
+	0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7,
+	0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff,
+};
+
+static const u8 test_ctr_cipher[] = {
+	0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26,
+	0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+	0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff,
+	0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+	0x5a, 0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3, 0x5e,
+	0x5b, 0x4f, 0x09, 0x02, 0x0d, 0xb0, 0x3e, 0xab,
+	0x1e, 0x03, 0x1d, 0xda, 0x2f, 0xbe, 0x03, 0xd1,
+	0x79, 0x21, 0x70, 0xa0, 0xf3, 0x00, 0x9c, 0xee,
+};
+
+/* Test case 4 from the GCM specification, with additional data */
+static const u8 test_gcm_key[] = {
+	0xfe, 0xff, 0xe9, 0x92, 0x86, 0x65, 0x73, 0x1c,
+	0x6d, 0x6a, 0x8f, 0x94, 0x67, 0x30, 0x83, 0x08,
+};
+
+static const u8 test_gcm_iv[] = {
+	0xca, 0xfe, 0xba, 0xbe, 0xfa, 0xce, 0xdb, 0xad,
+	0xde, 0xca, 0xf8, 0x88,
+};
+
+static const u8 test_gcm_aad[] = {
+	0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef,
+	0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef,
+	0xab, 0xad, 0xda, 0xd2,
+};
+
+static const u8 test_gcm_plain[] = {
+	0xd9, 0x31, 0x32, 0x25, 0xf8, 0x84, 0x06, 0xe5,
+	0xa5, 0x59, 0x09, 0xc5, 0xaf, 0xf5, 0x26, 0x9a,
+	0x86, 0xa7, 0xa9, 0x53, 0x15, 0x34, 0xf7, 0xda,
+	0x2e, 0x4c, 0x30, 0x3d, 0x8a, 0x31, 0x8a, 0x72,
+	0x1c, 0x3c, 0x0c, 0x95, 0x95, 0x68, 0x09, 0x53,
+	0x2f, 0xcf, 0x0e, 0x24, 0x49, 0xa6, 0xb5, 0x25,
+	0xb1, 0x6a, 0xed, 0xf5, 0xaa, 0x0d, 0xe6, 0x57,
+	0xba, 0x63, 0x7b, 0x39,
+};
+
+static const u8 test_gcm_cipher[] = {
+	0x42, 0x83, 0x1e, 0xc2, 0x21, 0x77, 0x74, 0x24,
+	0x4b, 0x72, 0x21, 0xb7, 0x84, 0xd0, 0xd4, 0x9c,
+	0xe3, 0xaa, 0x21, 0x2f, 0x2c, 0x02, 0xa4, 0xe0,
+	0x35, 0xc1, 0x7e, 0x23, 0x29, 0xac, 0xa1, 0x2e,
+	0x21, 0xd5, 0x14, 0xb2, 0x54, 0x66, 0x93, 0x1c,
+	0x7d, 0x8f, 0x6a, 0x5a, 0xac, 0x84, 0xaa, 0x05,
+	0x1b, 0xa3, 0x0b, 0x39, 0x6a, 0x0a, 0xac, 0x97,
+	0x3d, 0x58, 0xe0, 0x91,
+};
+
+static const u8 test_gcm_tag[] = {
+	0x5b, 0xc9, 0x4f, 0xbc, 0x32, 0x21, 0xa5, 0xdb,
+	0x94, 0xfa, 0xe9, 0x5a, 0xe7, 0x12, 0x1a, 0x47,
+};
+
+static int lib_test_aes_cbc_vector(struct unit_test_state *uts)
+{
+	u8 key_exp[AES256_EXPAND_KEY_LENGTH], iv[AES_BLOCK_LENGTH];
+	u8 buf[sizeof(test_sp800_38a_plain)];
+
+	aes_expand_key((u8 *)test_cbc_key, AES256_KEY_LENGTH, key_exp);
+	memcpy(iv, test_cbc_iv, sizeof(iv));
+
+	aes_cbc_encrypt_blocks(AES256_KEY_LENGTH, key_exp, iv,
+			       (u8 *)test_sp800_38a_plain, buf, 4);
+	ut_asserteq_mem(test_cbc_cipher, buf, sizeof(buf));
+
+	/* decrypt in place */
+	aes_cbc_decrypt_blocks(AES256_KEY_LENGTH, key_exp, iv, buf, buf, 4);
+	ut_asserteq_mem(test_sp800_38a_plain, buf, sizeof(buf));
+
+	return 0;
+}
+LIB_TEST(lib_test_aes_cbc_vector, 0);
+
+static int lib_test_aes_ctr(struct unit_test_state *uts)
+{
+	u8 key_exp[AES128_EXPAND_KEY_LENGTH], ctr[AES_BLOCK_LENGTH];
+	u8 buf[sizeof(test_sp800_38a_plain)];
+
+	aes_expand_key((u8 *)test_ctr_key, AES128_KEY_LENGTH, key_exp);
+
+	/* whole blocks, where the counter carries out of the bottom byte */
+	memcpy(ctr, test_ctr_iv, sizeof(ctr));
+	aes_ctr_blocks(AES128_KEY_LENGTH, key_exp, ctr,
+		       (u8 *)test_sp800_38a_plain, buf, 4);
+	ut_asserteq_mem(test_ctr_cipher, buf, sizeof(buf));
+	ut_asserteq(0x03, ctr[AES_BLOCK_LENGTH - 1]);
+	ut_asserteq(0xff, ctr[AES_BLOCK_LENGTH - 2]);
+
+	/* a partial last block */
+	memcpy(ctr, test_ctr_iv, sizeof(ctr));
+	aes_ctr_crypt(AES128_KEY_LENGTH, key_exp, ctr, (u8 *)test_ctr_cipher,
+		      buf, sizeof(buf) - 5);
+	ut_asserteq_mem(test_sp800_38a_plain, buf, sizeof(buf) - 5);
+
+	return 0;
+}
+LIB_TEST(lib_test_aes_ctr, 0);
+
+static int lib_test_aes_gcm(struct unit_test_state *uts)
+{
+	u8 key_exp[AES128_EXPAND_KEY_LENGTH], tag[AES_GCM_TAG_LENGTH];
+	u8 buf[sizeof(test_gcm_plain)];
+
+	aes_expand_key((u8 *)test_gcm_key, AES128_KEY_LENGTH, key_exp);
+
+	aes_gcm_encrypt(AES128_KEY_LENGTH, key_exp, (u8 *)test_gcm_iv,
+			(u8 *)test_gcm_aad, sizeof(test_gcm_aad),
+			(u8 *)test_gcm_plain, buf, sizeof(buf), tag);
+	ut_asserteq_mem(test_gcm_cipher, buf, sizeof(buf));
+	ut_asserteq_mem(test_gcm_tag, tag, sizeof(tag));
+
+	ut_assertok(aes_gcm_decrypt(AES128_KEY_LENGTH, key_exp,
+				    (u8 *)test_gcm_iv, (u8 *)test_gcm_aad,
+				    sizeof(test_gcm_aad), buf, buf,
+				    sizeof(buf), tag));
+	ut_asserteq_mem(test_gcm_plain, buf, sizeof(buf));
+
+	/* a changed tag must be rejected, and nothing handed back */
+	tag[0] ^= 1;
+	ut_asserteq(-EBADMSG,
+		    aes_gcm_decrypt(AES128_KEY_LENGTH, key_exp,
+				    (u8 *)test_gcm_iv, (u8 *)test_gcm_aad,
+				    sizeof(test_gcm_aad),
+				    (u8 *)test_gcm_cipher, buf, sizeof(buf),
+				    tag));
+	ut_assertnull(memchr_inv(buf, 0, sizeof(buf)));
+
+	return 0;
+}
+LIB_TEST(lib_test_aes_gcm, 0);
@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright 2026 The U-Boot Authors
+ *
+ * Unit tests for crc32
+ */
+
+#include <malloc.h>
+#include <time.h>
+#include <linux/sizes.h>
+#include <test/lib.h>
+#include <test/ut.h>
+#include <u-boot/crc.h>
+
+/* Bit-at-a-time reference, with the same chaining as crc32() */
+static u32 crc32_ref(u32 crc, const u8 *buf, uint len)
+{
+	int i;
+
+	crc = ~crc;
+	while (len--) {
+		crc ^= *buf++;
+		for (i = 0; i < 8; i++)
+			crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+	}
+
+	return ~crc;
+}
+
+static void crc32_fill(u8 *buf, uint len)
+{
+	uint seed = 0x1234567;
+
+	while (len--) {
+		seed = seed * 1103515245 + 12345;
+		*buf++ = seed >> 16;
+	}
+}
+
+static int lib_crc32(struct unit_test_state *uts)
+{
+	/* the lengths cover each fast path and the boundaries between them */
+	static const uint lens[] = {
+		0, 1, 7, 8, 9, 63, 64, 65, 1000, 3071, 3072, 3073, 4095, 4096,
+		4097, 4160, 9216, 12345, SZ_64K + 3,
+	};
+	const uint size = SZ_64K + 16;
+	u8 *buf;
+	int i, ofs;
+
+	ut_asserteq(0xcbf43926, crc32(0, (u8 *)"123456789", 9));
+	ut_asserteq(0x2dfd2d88, crc32_no_comp(0, (u8 *)"123456789", 9));
+
+	buf = malloc(size);
+	ut_assertnonnull(buf);
+	crc32_fill(buf, size);
+	for (i = 0; i < ARRAY_SIZE(lens); i++) {
+		for (ofs = 0; ofs < 8; ofs++) {
+			ut_asserteq(crc32_ref(0, buf + ofs, lens[i]),
+				    crc32(0, buf + ofs, lens[i]));
+			ut_asserteq(crc32_ref(0x12345678, buf + ofs, lens[i]),
+				    crc32(0x12345678, buf + ofs, lens[i]));
+		}
+	}
+
+	/* chaining gives the same result as a single call */
+	ut_asserteq(crc32(0, buf, size),
+		    crc32(crc32(0, buf, 5000), buf + 5000, size - 5000));
+	free(buf);
+
+	return 0;
+}
+LIB_TEST(lib_crc32, 0);
+
+/* Report the speed of crc32() on large and small buffers */
+static int lib_crc32_bench(struct unit_test_state *uts)
+{
+	static const uint sizes[] = { SZ_1M, SZ_4K, 256 };
+	const uint total = SZ_16M;
+	ulong start, us, rate;
+	u8 *buf;
+	int i, j;
+
+	buf = malloc(SZ_1M);
+	ut_assertnonnull(buf);
+	crc32_fill(buf, SZ_1M);
+
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		start = timer_get_us();
+		for (j = 0; j < total / sizes[i]; j++)
+			crc32(0, buf, sizes[i]);
+		us = max(timer_get_us() - start, 1UL);
+		rate = (u64)total * 1000000 / SZ_1K / us;
+		printf("crc32: %7u-byte buffers %lu.%02lu MiB/s\n", sizes[i],
+		       rate / SZ_1K, rate % SZ_1K * 100 / SZ_1K);
+	}
+	free(buf);
+
+	return 0;
+}
+LIB_TEST(lib_crc32_bench, 0);
@@ -21,7 +21,9 @@ kernel_hashes = {
     "sha1"   : "652383e1a6d946953e1f65092c9435f6452c2ab7",
     "md5"    : "4879e5086e4c76128e525b5fe2af55f1",
     "crc32"  : "32eddfdf",
-    "crc16-ccitt" : "d4be"
+    "crc16-ccitt" : "d4be",
+    "blake2b" : "7c74f75c4fa40e6041d4edb2a23467d627e2d9647ccd5ec7336a80adf4e03b39474398e48753662a697a0a23a3f957f26024318b69170405fc52e9a6c720ec22",
+    "xxh64"  : "89da2ac607e6989b"
 }
 
 class ReadonlyFitImage(object):
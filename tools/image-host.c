@@ -54,6 +54,64 @@ static int fit_set_hash_value(void *fit, int noffset, uint8_t *value,
 	return 0;
 }
 
+/**
+ * fit_image_process_chunks() - Add a table of chunk hashes to a hash node
+ *
+ * The data is split into chunks of @chunk_size bytes and the hash of each one
+ * is stored in the chunk-value property. The hash value of the node is then
+ * the hash of this table.
+ *
+ * @fit:	pointer to the FIT format image header
+ * @noffset:	hash node offset
+ * @algo:	hash algorithm name
+ * @chunk_size:	size of each chunk in bytes
+ * @data:	data to process
+ * @size:	size of data in bytes
+ * @value:	returns the hash of the table
+ * @value_len:	returns the length of @value in bytes
+ * Return: 0 if ok, -EPROTONOSUPPORT if @algo is not supported, -ENOMEM if out
+ * of memory, -ENOSPC if the FIT is too small, -EIO on other error
+ */
+static int fit_image_process_chunks(void *fit, int noffset, const char *algo,
+				    ulong chunk_size, const void *data,
+				    size_t size, uint8_t *value,
+				    int *value_len)
+{
+	size_t count = (size + chunk_size - 1) / chunk_size;
+	uint8_t *table;
+	size_t pos;
+	int len = 0;
+	int i, ret;
+
+	table = malloc(count * FIT_MAX_HASH_LEN + 1);
+	if (!table)
+		return -ENOMEM;
+	for (pos = 0, i = 0; pos < size; pos += chunk_size, i++) {
+		if (calculate_hash(data + pos,
+				   size - pos < chunk_size ? size - pos :
+				   chunk_size, algo, table + i * len, &len)) {
+			free(table);
+			return -EPROTONOSUPPORT;
+		}
+	}
+	if (calculate_hash(table, count * len, algo, value, value_len)) {
+		free(table);
+		return -EPROTONOSUPPORT;
+	}
+
+	ret = fdt_setprop(fit, noffset, FIT_CHUNK_VALUE_PROP, table,
+			  count * len);
+	free(table);
+	if (ret) {
+		fprintf(stderr, "Can't set hash '%s' property for '%s' node(%s)\n",
+			FIT_CHUNK_VALUE_PROP, fit_get_name(fit, noffset, NULL),
+			fdt_strerror(ret));
+		return ret == -FDT_ERR_NOSPACE ? -ENOSPC : -EIO;
+	}
+
+	return 0;
+}
+
 /**
  * fit_image_process_hash - Process a single subnode of the images/ node
  *
@@ -72,8 +130,10 @@ static int fit_image_process_hash(void *fit, const char *image_name,
 {
 	uint8_t value[FIT_MAX_HASH_LEN];
 	const char *node_name;
+	const fdt32_t *cell;
 	int value_len;
 	const char *algo;
+	int len;
 	int ret;
 
 	node_name = fit_get_name(fit, noffset, NULL);
@@ -85,11 +145,31 @@ static int fit_image_process_hash(void *fit, const char *image_name,
 		return -ENOENT;
 	}
 
-	if (calculate_hash(data, size, algo, value, &value_len)) {
+	/* a chunk-size property asks for a table of chunk hashes */
+	cell = fdt_getprop(fit, noffset, FIT_CHUNK_SIZE_PROP, &len);
+	if (cell) {
+		if (len != sizeof(*cell) || !fdt32_to_cpu(*cell)) {
+			fprintf(stderr,
+				"Invalid '%s' property for '%s' hash node in '%s' image node\n",
+				FIT_CHUNK_SIZE_PROP, node_name, image_name);
+			return -EINVAL;
+		}
+		ret = fit_image_process_chunks(fit, noffset, algo,
+					       fdt32_to_cpu(*cell), data, size,
+					       value, &value_len);
+	} else {
+		ret = calculate_hash(data, size, algo, value, &value_len) ?
+			-EPROTONOSUPPORT : 0;
+	}
+	if (ret == -EPROTONOSUPPORT) {
 		fprintf(stderr,
 			"Unsupported hash algorithm (%s) for '%s' hash node in '%s' image node\n",
 			algo, node_name, image_name);
-		return -EPROTONOSUPPORT;
+		return ret;
+	} else if (ret) {
+		fprintf(stderr, "Can't set chunk hashes for '%s' hash node in '%s' image node\n",
+			node_name, image_name);
+		return ret;
 	}
 
 	ret = fit_set_hash_value(fit, noffset, value, value_len);